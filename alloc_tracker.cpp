@@ -0,0 +1,948 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 替换全局 operator new/delete。这个文件里的代码自己不能调用 operator new，
+// 全局表、线程缓冲和采样块表都是静态存储，报告只用栈上缓冲和 write。
+
+#include "alloc_tracker.h"
+#include "guarded_heap.h"
+#include "report_writer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#ifdef _WIN32
+#include <intrin.h>
+#define ALLOC_TRACKER_RETURN_ADDRESS() reinterpret_cast<uintptr_t>(_ReturnAddress())
+#define ALLOC_TRACKER_NOINLINE __declspec(noinline)
+#define ALLOC_TRACKER_INLINE __forceinline
+#else
+#define ALLOC_TRACKER_RETURN_ADDRESS() reinterpret_cast<uintptr_t>(__builtin_return_address(0))
+#define ALLOC_TRACKER_NOINLINE __attribute__((noinline))
+#define ALLOC_TRACKER_INLINE inline __attribute__((always_inline))
+#endif
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define ALLOC_TRACKER_HAS_BACKTRACE 1
+#endif
+
+// 采样间隔（字节）的默认值，环境变量 ALLOC_TRACKER_SAMPLE_BYTES 可以覆盖；0 表示每次分配都记录
+#ifndef ALLOC_TRACKER_DEFAULT_SAMPLE_BYTES
+#define ALLOC_TRACKER_DEFAULT_SAMPLE_BYTES (512 * 1024)
+#endif
+
+namespace alloc_tracker {
+namespace {
+
+constexpr uint32_t kMaxSites = 4096;  // 0 号调用点表示“表已满”
+constexpr int kMaxFrames = 16;
+constexpr uint32_t kLiveMagic = 0xA110C8EDu;
+constexpr uint32_t kFreedMagic = 0xF4EEDF4Eu;
+constexpr size_t kSampleAlign = 4096;             // 抽中的块按页对齐分配，用户指针的页内偏移固定
+constexpr uint64_t kUnresolved = ~uint64_t{0};   // 采样间隔还没确定
+
+// 每块内存前面的头，16 字节保证用户指针仍然按 16 字节对齐
+struct Header {
+    uint32_t site;
+    uint32_t magic;
+    uint64_t size;
+};
+static_assert(sizeof(Header) == 16, "Header 必须是 16 字节");
+
+struct Site {
+    std::atomic<uintptr_t> pc{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> bytes_allocated{0};
+    std::atomic<uint64_t> bytes_freed{0};
+    std::atomic<uint32_t> stack_state{0};  // 0 未采样，1 正在写，2 已就绪
+    int depth = 0;
+    void* stack[kMaxFrames] = {};
+};
+
+Site g_sites[kMaxSites];
+std::atomic<uint32_t> g_sample_interval{0};
+std::atomic<bool> g_report_at_exit{true};
+std::atomic<bool> g_guarded{false};
+std::atomic<bool> g_guard_used{false};  // 开启过受保护模式，之后一直为 true：只有这时释放才需要问 guarded_heap
+std::atomic<uint64_t> g_sample_bytes{kUnresolved};  // 第一次分配时确定，之后不变
+
+// ==================== 线程局部缓冲 ====================
+
+constexpr uint32_t kPcCacheSize = 256;   // 调用点地址 -> 全局编号 的直接映射缓存
+constexpr uint32_t kDeltaSlots = 64;     // 按全局编号直接映射的增量槽位
+constexpr uint32_t kFlushEvents = 4096;  // 每这么多次分配/释放合并一次
+
+// 采样模式下一次记录按权重放大，计数可能很大，所以都是 64 位
+struct LocalDelta {
+    uint32_t site;
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes_allocated;
+    uint64_t bytes_freed;
+};
+
+// 只有平凡类型，thread_local 可以常量初始化，访问时不需要构造守卫
+struct LocalBuffer {
+    uint64_t bytes_until_sample;  // 采样模式：再分配这么多字节落下一个采样点；0 表示还没初始化
+    uint64_t rng;                 // 采样间隔的随机数状态，0 表示还没播种
+    uintptr_t pc_tags[kPcCacheSize];
+    uint32_t pc_sites[kPcCacheSize];
+    LocalDelta deltas[kDeltaSlots];
+    uint32_t events;
+    uint32_t sample_counter;
+    uint8_t state;    // kUnregistered / kActive / kDead，快速路径只比较这一个字节
+    bool capturing;   // 正在采样调用栈，防止重入
+};
+
+enum : uint8_t {
+    kUnregistered = 0,  // 还没注册线程退出时的合并
+    kActive = 1,
+    kDead = 2,  // 线程局部对象已经析构，之后直接写全局表
+};
+
+thread_local LocalBuffer t_buffer{};
+
+inline uint64_t mix(uintptr_t pc) { return (static_cast<uint64_t>(pc) >> 2) * 0x9E3779B97F4A7C15ull; }
+
+// 无锁开放寻址：槽位的 pc 从 0 CAS 成调用点地址，之后不再改变
+uint32_t findSite(uintptr_t pc) {
+    const uint32_t start = static_cast<uint32_t>(mix(pc) >> 52);
+    for (uint32_t probe = 0; probe < 64; ++probe) {
+        const uint32_t index = (start + probe) & (kMaxSites - 1);
+        if (index == 0) {
+            continue;
+        }
+        uintptr_t current = g_sites[index].pc.load(std::memory_order_acquire);
+        if (current == pc) {
+            return index;
+        }
+        if (current == 0) {
+            if (g_sites[index].pc.compare_exchange_strong(current, pc, std::memory_order_acq_rel) ||
+                current == pc) {
+                return index;
+            }
+        }
+    }
+    return 0;
+}
+
+void addGlobal(uint32_t site, uint64_t allocations, uint64_t frees, uint64_t bytes_allocated,
+               uint64_t bytes_freed) {
+    Site& s = g_sites[site];
+    if (allocations) {
+        s.allocations.fetch_add(allocations, std::memory_order_relaxed);
+        s.bytes_allocated.fetch_add(bytes_allocated, std::memory_order_relaxed);
+    }
+    if (frees) {
+        s.frees.fetch_add(frees, std::memory_order_relaxed);
+        s.bytes_freed.fetch_add(bytes_freed, std::memory_order_relaxed);
+    }
+}
+
+// 计数全为 0 的槽位合并也没有影响，所以不需要“空槽”标记
+ALLOC_TRACKER_NOINLINE void flushDelta(LocalDelta& delta) {
+    if (delta.allocations | delta.frees) {
+        addGlobal(delta.site, delta.allocations, delta.frees, delta.bytes_allocated, delta.bytes_freed);
+        delta.allocations = 0;
+        delta.frees = 0;
+        delta.bytes_allocated = 0;
+        delta.bytes_freed = 0;
+    }
+}
+
+ALLOC_TRACKER_NOINLINE void flushAll(LocalBuffer& buffer) {
+    for (LocalDelta& delta : buffer.deltas) {
+        flushDelta(delta);
+    }
+    buffer.events = 0;
+}
+
+struct ThreadFlusher {
+    ~ThreadFlusher() {
+        flushAll(t_buffer);
+        t_buffer.state = kDead;
+    }
+};
+
+// 线程第一次分配/释放时注册退出时的合并；线程缓冲已经析构时返回 false，调用方直接写全局表
+ALLOC_TRACKER_NOINLINE bool activate(LocalBuffer& buffer) {
+    if (buffer.state == kDead) {
+        return false;
+    }
+    buffer.state = kActive;
+    static thread_local ThreadFlusher flusher;  // 第一次经过时构造，线程退出时析构
+    (void)flusher;
+    return true;
+}
+
+ALLOC_TRACKER_NOINLINE uint32_t cacheSite(LocalBuffer& buffer, uint32_t slot, uintptr_t pc) {
+    const uint32_t site = findSite(pc);
+    buffer.pc_tags[slot] = pc;
+    buffer.pc_sites[slot] = site;
+    return site;
+}
+
+ALLOC_TRACKER_INLINE LocalDelta& deltaFor(LocalBuffer& buffer, uint32_t site) {
+    LocalDelta& delta = buffer.deltas[site & (kDeltaSlots - 1)];
+    if (delta.site != site) {
+        flushDelta(delta);
+        delta.site = site;
+    }
+    return delta;
+}
+
+ALLOC_TRACKER_NOINLINE void captureStack(LocalBuffer& buffer, uint32_t site) {
+#ifdef ALLOC_TRACKER_HAS_BACKTRACE
+    uint32_t expected = 0;
+    if (site == 0 || buffer.capturing ||
+        !g_sites[site].stack_state.compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+        return;
+    }
+    buffer.capturing = true;
+    g_sites[site].depth = backtrace(g_sites[site].stack, kMaxFrames);
+    buffer.capturing = false;
+    g_sites[site].stack_state.store(2, std::memory_order_release);
+#else
+    (void)buffer;
+    (void)site;
+#endif
+}
+
+// 记账的快速路径内联进 operator new/delete：命中调用点缓存和增量槽位时只有几次线程局部读写，
+// 注册线程、查全局表、合并这些少见的情况都在不内联的函数里
+// weight：这一次记录代表的分配次数，精确模式下是 1
+ALLOC_TRACKER_INLINE void recordAlloc(uintptr_t pc, size_t size, Header* header, uint64_t weight) {
+    header->magic = kLiveMagic;
+    header->size = size;
+    LocalBuffer& buffer = t_buffer;
+    if (buffer.state != kActive && !activate(buffer)) {
+        header->site = findSite(pc);
+        addGlobal(header->site, weight, 0, size * weight, 0);
+        return;
+    }
+
+    const uint32_t slot = static_cast<uint32_t>(mix(pc) >> 56) & (kPcCacheSize - 1);
+    const uint32_t site = buffer.pc_tags[slot] == pc ? buffer.pc_sites[slot] : cacheSite(buffer, slot, pc);
+    header->site = site;
+
+    LocalDelta& delta = deltaFor(buffer, site);
+    delta.allocations += weight;
+    delta.bytes_allocated += size * weight;
+    if (++buffer.events >= kFlushEvents) {
+        flushAll(buffer);
+    }
+
+    const uint32_t interval = g_sample_interval.load(std::memory_order_relaxed);
+    if (interval != 0 && ++buffer.sample_counter >= interval) {
+        buffer.sample_counter = 0;
+        captureStack(buffer, site);
+    }
+}
+
+// ==================== 报告 ====================
+// 只用栈上缓冲和 write（ReportWriter），可以在信号处理函数里用
+
+SiteStats loadSite(uint32_t index) {
+    const Site& s = g_sites[index];
+    SiteStats stats;
+    stats.site = reinterpret_cast<const void*>(s.pc.load(std::memory_order_acquire));
+    stats.allocations = s.allocations.load(std::memory_order_relaxed);
+    stats.frees = s.frees.load(std::memory_order_relaxed);
+    stats.bytes_allocated = s.bytes_allocated.load(std::memory_order_relaxed);
+    stats.bytes_freed = s.bytes_freed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+SiteStats sumSites() {
+    SiteStats total;
+    for (uint32_t i = 0; i < kMaxSites; ++i) {
+        SiteStats s = loadSite(i);
+        total.allocations += s.allocations;
+        total.frees += s.frees;
+        total.bytes_allocated += s.bytes_allocated;
+        total.bytes_freed += s.bytes_freed;
+    }
+    return total;
+}
+
+void printSymbol(int fd, void* const* frames, int depth) {
+#ifdef ALLOC_TRACKER_HAS_BACKTRACE
+    backtrace_symbols_fd(frames, depth, fd);
+#else
+    (void)fd;
+    (void)frames;
+    (void)depth;
+#endif
+}
+
+void writeReportImpl(int fd, bool leaks_only, const char* title) {
+    constexpr int kTop = 20;
+    uint32_t top[kTop];
+    uint64_t keys[kTop];
+    int count = 0;
+    // 按存活字节（leaks_only）或累计字节选出前 kTop 个调用点
+    for (uint32_t i = 0; i < kMaxSites; ++i) {
+        SiteStats s = loadSite(i);
+        if (s.allocations == 0 || (leaks_only && s.liveObjects() <= 0)) {
+            continue;
+        }
+        const uint64_t key = leaks_only ? static_cast<uint64_t>(s.liveBytes()) : s.bytes_allocated;
+        int pos = count < kTop ? count++ : kTop;
+        while (pos > 0 && keys[pos - 1] < key) {
+            if (pos < kTop) {
+                top[pos] = top[pos - 1];
+                keys[pos] = keys[pos - 1];
+            }
+            --pos;
+        }
+        if (pos < kTop) {
+            top[pos] = i;
+            keys[pos] = key;
+        }
+    }
+
+    const SiteStats total = sumSites();
+    {
+        ReportWriter out(fd);
+        out.text("==== 分配追踪报告（").text(title).text("）====\n");
+        const uint64_t sample_bytes = g_sample_bytes.load(std::memory_order_relaxed);
+        if (sample_bytes != 0 && sample_bytes != kUnresolved) {
+            out.text("采样: 平均每 ").number(sample_bytes).text(" 字节记录一次分配，下面的数字是按概率放大的估计值\n");
+        }
+        out.text("总计: 分配 ").number(total.allocations).text(" 次, 释放 ").number(total.frees)
+            .text(" 次, 存活 ").number(static_cast<uint64_t>(std::max<int64_t>(total.liveObjects(), 0)))
+            .text(" 个对象 / ").number(static_cast<uint64_t>(std::max<int64_t>(total.liveBytes(), 0)))
+            .text(" 字节\n");
+        if (count == 0) {
+            out.text(leaks_only ? "没有未释放的对象\n" : "没有记录\n");
+            return;
+        }
+        out.text(leaks_only ? "未释放的调用点（按存活字节）:\n" : "调用点（按累计字节）:\n");
+    }
+    for (int k = 0; k < count; ++k) {
+        const SiteStats s = loadSite(top[k]);
+        {
+            ReportWriter out(fd);
+            out.text("  分配").number(s.allocations, 10).text("  释放").number(s.frees, 10)
+                .text("  存活").number(static_cast<uint64_t>(std::max<int64_t>(s.liveObjects(), 0)), 8)
+                .text("  存活字节").number(static_cast<uint64_t>(std::max<int64_t>(s.liveBytes(), 0)), 10)
+                .text("  累计字节").number(s.bytes_allocated, 12).text("  ");
+            if (top[k] == 0) {
+                out.text("（调用点表已满）\n");
+                continue;
+            }
+            out.hex(reinterpret_cast<uintptr_t>(s.site)).text("\n    ");
+        }
+        void* pc = const_cast<void*>(s.site);
+        printSymbol(fd, &pc, 1);
+        const Site& site = g_sites[top[k]];
+        if (site.stack_state.load(std::memory_order_acquire) == 2) {
+            {
+                ReportWriter out(fd);
+                out.text("    采样到的调用栈:\n");
+            }
+            printSymbol(fd, site.stack, site.depth);
+        }
+    }
+}
+
+void onExit() {
+    if (g_report_at_exit.load(std::memory_order_relaxed)) {
+        flushThread();
+        writeReportImpl(2, true, "进程退出");
+    }
+}
+
+#ifndef _WIN32
+// 信号可能打断当前线程正在更新的缓冲，所以这里不合并线程缓冲，只读全局表
+void onSignal(int) { writeReportImpl(2, false, "SIGUSR1"); }
+#endif
+
+struct Initializer {
+    Initializer() {
+        if (const char* value = std::getenv("ALLOC_TRACKER_SAMPLE")) {
+            setSampleInterval(static_cast<uint32_t>(std::strtoul(value, nullptr, 10)));
+        }
+        if (const char* value = std::getenv("ALLOC_TRACKER_REPORT")) {
+            setReportAtExit(std::strcmp(value, "0") != 0);
+        }
+        guarded_heap::Options options = guarded_heap::options();
+        if (const char* value = std::getenv("ALLOC_TRACKER_QUARANTINE_MB")) {
+            options.quarantine_bytes = static_cast<size_t>(std::strtoull(value, nullptr, 10)) << 20;
+        }
+        if (const char* value = std::getenv("ALLOC_TRACKER_GUARD_BATCH")) {
+            options.protect_batch = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        }
+        guarded_heap::configure(options);
+        if (const char* value = std::getenv("ALLOC_TRACKER_GUARD")) {
+            setGuardInterval(static_cast<uint32_t>(std::strtoul(value, nullptr, 10)));
+        }
+        std::atexit(onExit);
+#ifndef _WIN32
+        struct sigaction current {};
+        if (sigaction(SIGUSR1, nullptr, &current) == 0 && current.sa_handler == SIG_DFL) {
+            struct sigaction action {};
+            action.sa_handler = onSignal;
+            sigemptyset(&action.sa_mask);
+            action.sa_flags = SA_RESTART;
+            sigaction(SIGUSR1, &action, nullptr);
+        }
+#endif
+    }
+};
+
+Initializer g_initializer;
+
+}  // namespace
+
+void flushThread() {
+    if (t_buffer.state != kDead) {
+        flushAll(t_buffer);
+    }
+}
+
+std::vector<SiteStats> sites() {
+    flushThread();
+    std::vector<SiteStats> result;
+    for (uint32_t i = 0; i < kMaxSites; ++i) {
+        SiteStats s = loadSite(i);
+        if (s.allocations != 0) {
+            result.push_back(s);
+        }
+    }
+    return result;
+}
+
+SiteStats totals() {
+    flushThread();
+    return sumSites();
+}
+
+void writeReport(int fd, bool leaks_only) {
+    flushThread();
+    writeReportImpl(fd, leaks_only, "手动");
+}
+
+void setSampleInterval(uint32_t interval) { g_sample_interval.store(interval, std::memory_order_relaxed); }
+
+void setReportAtExit(bool enabled) { g_report_at_exit.store(enabled, std::memory_order_relaxed); }
+
+void setGuardInterval(uint32_t interval) {
+    if (interval != 0) {
+        guarded_heap::Options options = guarded_heap::options();
+        options.sample_interval = interval;
+        guarded_heap::configure(options);
+        guarded_heap::installFaultHandler();
+        g_guard_used.store(true, std::memory_order_relaxed);
+    }
+    // release / acquire：从 guarded_heap 拿到块的线程一定看得到 g_guard_used，块传给别的线程释放时也一样
+    g_guarded.store(interval != 0, std::memory_order_release);
+}
+
+// ==================== 分配和释放 ====================
+// 两种模式，第一次分配时确定，之后不变（两种块的布局不同，中途切换会把块交给错误的释放路径）：
+// - 精确模式（采样间隔为 0）：每块都带 16 字节头，每次分配和释放都记账
+// - 采样模式：按分配的字节数抽样，平均每 R 字节抽中一次（间隔服从指数分布，和 tcmalloc 的堆采样一样）。
+//   没抽中的分配只减一个线程局部计数就直接 malloc，不加头、不记账；抽中的按页对齐分配、带头，
+//   记进采样块表，记账时乘上抽中概率的倒数，估计值是无偏的。
+//   释放时只有页内偏移和抽中块相同的指针（约 1/256）才查表，其余直接 free
+
+namespace {
+
+// 普通 new 抽中的块，用户指针在页内的偏移。不用 16：glibc 用 mmap 分配的大块，用户指针都在页内偏移 16
+constexpr size_t kSampledOffset = 2 * sizeof(Header);
+
+// 头部放在用户指针前面，占用的偏移向上取整到 align；align 比头部小时也不能写到 base 之前
+size_t alignedOffset(size_t align) { return (sizeof(Header) + align - 1) & ~(align - 1); }
+
+// bytes 向上取整到 align；调用方保证不溢出
+char* alignedAlloc(size_t align, size_t bytes) noexcept {
+    const size_t total = (bytes + align - 1) & ~(align - 1);
+#ifdef _WIN32
+    return static_cast<char*>(_aligned_malloc(total, align));
+#else
+    return static_cast<char*>(std::aligned_alloc(align, total));
+#endif
+}
+
+void alignedFree(void* base) noexcept {
+#ifdef _WIN32
+    _aligned_free(base);
+#else
+    std::free(base);
+#endif
+}
+
+// ==================== 采样块表 ====================
+// 抽中的块的用户指针 -> 记账权重。按地址分 64 段，每段一把锁、1024 个槽位的线性探测表，删除时向前回填，
+// 不留墓碑。抽中的块平均每 R 字节才有一个，一段填到 3/4 时新抽中的分配退回普通分配（估计值会偏低）
+
+constexpr uint32_t kSampledStripes = 64;
+constexpr uint32_t kSampledSlots = 1024;
+
+struct SampledEntry {
+    uintptr_t ptr;
+    uint64_t weight;
+};
+
+struct alignas(64) SampledStripe {
+    std::mutex mutex;
+    uint32_t count = 0;
+    SampledEntry slots[kSampledSlots] = {};
+};
+
+SampledStripe g_sampled[kSampledStripes];
+
+inline uint64_t mixPointer(uintptr_t ptr) { return (static_cast<uint64_t>(ptr) >> 12) * 0x9E3779B97F4A7C15ull; }
+
+inline SampledStripe& stripeFor(uintptr_t ptr) { return g_sampled[mixPointer(ptr) >> 58]; }
+
+inline uint32_t homeSlot(uintptr_t ptr) {
+    return static_cast<uint32_t>(mixPointer(ptr) >> 32) & (kSampledSlots - 1);
+}
+
+bool insertSampled(void* ptr, uint64_t weight) noexcept {
+    const auto key = reinterpret_cast<uintptr_t>(ptr);
+    SampledStripe& stripe = stripeFor(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    if (stripe.count >= kSampledSlots / 4 * 3) {
+        return false;
+    }
+    uint32_t slot = homeSlot(key);
+    while (stripe.slots[slot].ptr != 0) {
+        slot = (slot + 1) & (kSampledSlots - 1);
+    }
+    stripe.slots[slot] = {key, weight};
+    ++stripe.count;
+    return true;
+}
+
+// 返回记账权重并删掉表项；不在表里（没抽中的块）时返回 0
+uint64_t eraseSampled(void* ptr) noexcept {
+    const auto key = reinterpret_cast<uintptr_t>(ptr);
+    SampledStripe& stripe = stripeFor(key);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    uint32_t hole = homeSlot(key);
+    while (stripe.slots[hole].ptr != key) {
+        if (stripe.slots[hole].ptr == 0) {
+            return 0;
+        }
+        hole = (hole + 1) & (kSampledSlots - 1);
+    }
+    const uint64_t weight = stripe.slots[hole].weight;
+    // 后面同一段探测链上的项，如果空出来的位置在它的“家”和它现在的位置之间，就挪过来
+    for (uint32_t next = (hole + 1) & (kSampledSlots - 1); stripe.slots[next].ptr != 0;
+         next = (next + 1) & (kSampledSlots - 1)) {
+        const uint32_t home = homeSlot(stripe.slots[next].ptr);
+        if (((next - home) & (kSampledSlots - 1)) >= ((next - hole) & (kSampledSlots - 1))) {
+            stripe.slots[hole] = stripe.slots[next];
+            hole = next;
+        }
+    }
+    stripe.slots[hole] = {};
+    --stripe.count;
+    return weight;
+}
+
+// ==================== 采样间隔 ====================
+
+ALLOC_TRACKER_NOINLINE uint64_t resolveSampleBytes() noexcept {
+    uint64_t value = ALLOC_TRACKER_DEFAULT_SAMPLE_BYTES;
+    if (const char* env = std::getenv("ALLOC_TRACKER_SAMPLE_BYTES")) {
+        value = std::strtoull(env, nullptr, 10);
+    }
+    value = std::min(value, kUnresolved - 1);
+    uint64_t expected = kUnresolved;
+    if (g_sample_bytes.compare_exchange_strong(expected, value, std::memory_order_relaxed)) {
+        return value;
+    }
+    return expected;
+}
+
+// xorshift64*，每个线程一份状态
+uint64_t nextRandom(LocalBuffer& buffer) {
+    uint64_t x = buffer.rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    buffer.rng = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+// (0, 1] 上的均匀分布
+double uniform(LocalBuffer& buffer) { return static_cast<double>((nextRandom(buffer) >> 11) + 1) * 0x1p-53; }
+
+// 到下一个采样点的字节数，服从均值为 mean 的指数分布
+uint64_t nextGap(LocalBuffer& buffer, uint64_t mean) {
+    const double gap = -std::log(uniform(buffer)) * static_cast<double>(mean);
+    if (gap >= 0x1p63) {
+        return uint64_t{1} << 63;
+    }
+    return std::max<uint64_t>(static_cast<uint64_t>(gap), 1);
+}
+
+// size 字节的分配被抽中的概率是 p = 1 - exp(-size / mean)，一次记录代表 1/p 次分配；
+// 取整用随机舍入，保证期望不变
+uint64_t sampleWeight(LocalBuffer& buffer, size_t size, uint64_t mean) {
+    const double p = -std::expm1(-static_cast<double>(size) / static_cast<double>(mean));
+    const double expected = 1.0 / p;
+    if (expected >= 0x1p63) {
+        return uint64_t{1} << 63;
+    }
+    auto weight = static_cast<uint64_t>(expected);
+    if (uniform(buffer) <= expected - static_cast<double>(weight)) {
+        ++weight;
+    }
+    return std::max<uint64_t>(weight, 1);
+}
+
+// ==================== 三种块 ====================
+// align 为 0 表示普通 new（malloc 的默认对齐）
+
+// 受保护模式抽中时返回受保护的块，布局和精确模式相同，记账权重为 1；否则返回空
+void* allocateGuarded(size_t size, size_t align, uintptr_t pc) noexcept {
+    const size_t offset = align ? alignedOffset(align) : sizeof(Header);
+    if (size > SIZE_MAX - offset) {
+        return nullptr;
+    }
+    char* base = static_cast<char*>(guarded_heap::tryAllocate(
+        size + offset, align ? align : alignof(std::max_align_t), reinterpret_cast<const void*>(pc)));
+    if (!base) {
+        return nullptr;
+    }
+    recordAlloc(pc, size, reinterpret_cast<Header*>(base + offset) - 1, 1);
+    return base + offset;
+}
+
+// 精确模式：受保护模式下先问 guarded_heap，没抽中或者块太大再走 malloc
+void* allocateExact(size_t size, size_t align, uintptr_t pc) noexcept {
+    if (g_guarded.load(std::memory_order_acquire)) {
+        if (void* ptr = allocateGuarded(size, align, pc)) {
+            return ptr;
+        }
+    }
+    const size_t offset = align ? alignedOffset(align) : sizeof(Header);
+    if (size > SIZE_MAX - offset - align) {
+        return nullptr;
+    }
+    char* base = align ? alignedAlloc(align, size + offset) : static_cast<char*>(std::malloc(size + offset));
+    if (!base) {
+        return nullptr;
+    }
+    recordAlloc(pc, size, reinterpret_cast<Header*>(base + offset) - 1, 1);
+    return base + offset;
+}
+
+// 采样模式抽中的块：按页对齐，用户指针的页内偏移固定，释放时据此筛出要查表的指针
+void* allocateSampled(size_t size, size_t align, uintptr_t pc, uint64_t weight) noexcept {
+    const size_t alignment = std::max(align, kSampleAlign);
+    const size_t offset = align ? alignedOffset(align) : kSampledOffset;
+    if (size > SIZE_MAX - offset - alignment) {
+        return nullptr;
+    }
+    char* base = alignedAlloc(alignment, size + offset);
+    if (!base) {
+        return nullptr;
+    }
+    if (!insertSampled(base + offset, weight)) {
+        alignedFree(base);
+        return nullptr;
+    }
+    recordAlloc(pc, size, reinterpret_cast<Header*>(base + offset) - 1, weight);
+    return base + offset;
+}
+
+// 采样模式没抽中的块：和不链接追踪时一样
+ALLOC_TRACKER_INLINE void* allocatePlain(size_t size, size_t align) noexcept {
+    if (!align) {
+        return std::malloc(size ? size : 1);
+    }
+    if (size > SIZE_MAX - align) {
+        return nullptr;
+    }
+    return alignedAlloc(align, size ? size : 1);
+}
+
+// 快速路径以外的情况：还没确定模式、精确模式、受保护模式、线程第一次分配、落在采样点上
+ALLOC_TRACKER_NOINLINE void* allocateSlow(size_t size, size_t align, uintptr_t pc) noexcept {
+    uint64_t mean = g_sample_bytes.load(std::memory_order_relaxed);
+    if (mean == kUnresolved) {
+        mean = resolveSampleBytes();
+    }
+    if (mean == 0) {
+        return allocateExact(size, align, pc);
+    }
+    if (g_guarded.load(std::memory_order_acquire)) {
+        if (void* ptr = allocateGuarded(size, align, pc)) {
+            return ptr;
+        }
+    }
+    LocalBuffer& buffer = t_buffer;
+    const size_t charge = size ? size : 1;
+    if (buffer.rng == 0) {
+        buffer.rng = (reinterpret_cast<uintptr_t>(&buffer) * 0x9E3779B97F4A7C15ull) | 1;
+        buffer.bytes_until_sample = nextGap(buffer, mean);
+    }
+    if (charge < buffer.bytes_until_sample) {
+        buffer.bytes_until_sample -= charge;
+        return allocatePlain(size, align);
+    }
+    buffer.bytes_until_sample = nextGap(buffer, mean);
+    if (void* ptr = allocateSampled(size, align, pc, sampleWeight(buffer, charge, mean))) {
+        return ptr;
+    }
+    return allocatePlain(size, align);
+}
+
+// 快速路径：采样模式下没落在采样点上、也没开受保护模式。精确模式下 bytes_until_sample 一直是 0，总走慢路径
+ALLOC_TRACKER_INLINE void* allocateAligned(size_t size, size_t align, uintptr_t pc) noexcept {
+    LocalBuffer& buffer = t_buffer;
+    const size_t charge = size ? size : 1;
+    if (charge < buffer.bytes_until_sample && !g_guarded.load(std::memory_order_acquire)) {
+        buffer.bytes_until_sample -= charge;
+        return allocatePlain(size, align);
+    }
+    return allocateSlow(size, align, pc);
+}
+
+ALLOC_TRACKER_INLINE void* allocate(size_t size, uintptr_t pc) noexcept { return allocateAligned(size, 0, pc); }
+
+[[noreturn]] void badFree(const void* ptr) {
+    {
+        ReportWriter out(2);
+        out.text("alloc_tracker: 释放了不是 operator new 分配的、或已经释放过的指针 ")
+            .hex(reinterpret_cast<uintptr_t>(ptr)).text("\n");
+    }
+    std::abort();
+}
+
+ALLOC_TRACKER_INLINE void recordFree(Header* header, uint64_t weight) {
+    if (header->magic != kLiveMagic) {
+        badFree(header + 1);
+    }
+    header->magic = kFreedMagic;
+    const uint32_t site = header->site;
+    const uint64_t size = header->size;
+    LocalBuffer& buffer = t_buffer;
+    if (buffer.state != kActive && !activate(buffer)) {
+        addGlobal(site, 0, weight, 0, size * weight);
+        return;
+    }
+    LocalDelta& delta = deltaFor(buffer, site);
+    delta.frees += weight;
+    delta.bytes_freed += size * weight;
+    if (++buffer.events >= kFlushEvents) {
+        flushAll(buffer);
+    }
+}
+
+// 受保护的块：已经释放过的块不记账，交给 guarded_heap 报告重复释放和分配、释放位置。
+// 先问 guarded_heap 块的状态，不能先读头部：释放过的块可能已经 mprotect 成不可访问，
+// 读头部会触发 SIGSEGV，被当成“释放后使用”报告
+bool releaseGuarded(void* block, Header* header, uintptr_t pc) noexcept {
+    if (!guarded_heap::owns(block)) {
+        return false;
+    }
+    if (guarded_heap::isLive(block) && header->magic == kLiveMagic) {
+        recordFree(header, 1);
+    }
+    guarded_heap::deallocate(block, reinterpret_cast<const void*>(pc));
+    return true;
+}
+
+// 采样模式下页内偏移和抽中的块相同的指针：查表，抽中的按权重记账，没抽中的是普通块
+ALLOC_TRACKER_NOINLINE void releaseSampled(void* ptr, size_t align) noexcept {
+    const uint64_t weight = eraseSampled(ptr);
+    if (weight == 0) {
+        if (align) {
+            alignedFree(ptr);
+        } else {
+            std::free(ptr);
+        }
+        return;
+    }
+    recordFree(static_cast<Header*>(ptr) - 1, weight);
+    alignedFree(static_cast<char*>(ptr) - (align ? alignedOffset(align) : kSampledOffset));
+}
+
+// 精确模式的释放不内联：记账要用的寄存器会让采样模式的快速路径也多出保存和恢复
+ALLOC_TRACKER_NOINLINE void releaseExact(void* ptr, size_t align) noexcept {
+    recordFree(static_cast<Header*>(ptr) - 1, 1);
+    if (align) {
+        alignedFree(static_cast<char*>(ptr) - alignedOffset(align));
+    } else {
+        std::free(static_cast<Header*>(ptr) - 1);
+    }
+}
+
+ALLOC_TRACKER_INLINE void deallocate(void* ptr, uintptr_t pc) noexcept {
+    if (!ptr) {
+        return;
+    }
+    Header* header = static_cast<Header*>(ptr) - 1;
+    if (g_guard_used.load(std::memory_order_relaxed) && releaseGuarded(header, header, pc)) {
+        return;
+    }
+    if (g_sample_bytes.load(std::memory_order_relaxed) == 0) {
+        releaseExact(ptr, 0);
+        return;
+    }
+    if ((reinterpret_cast<uintptr_t>(ptr) & (kSampleAlign - 1)) == kSampledOffset) {
+        releaseSampled(ptr, 0);
+        return;
+    }
+    std::free(ptr);
+}
+
+ALLOC_TRACKER_INLINE void deallocateAligned(void* ptr, size_t align, uintptr_t pc) noexcept {
+    if (!ptr) {
+        return;
+    }
+    const size_t offset = alignedOffset(align);
+    char* base = static_cast<char*>(ptr) - offset;
+    Header* header = static_cast<Header*>(ptr) - 1;
+    if (g_guard_used.load(std::memory_order_relaxed) && releaseGuarded(base, header, pc)) {
+        return;
+    }
+    if (g_sample_bytes.load(std::memory_order_relaxed) == 0) {
+        releaseExact(ptr, align);
+        return;
+    }
+    if ((reinterpret_cast<uintptr_t>(ptr) & (kSampleAlign - 1)) == (offset & (kSampleAlign - 1))) {
+        releaseSampled(ptr, align);
+        return;
+    }
+    alignedFree(ptr);
+}
+
+// 分配失败时按标准的要求反复调用 new_handler，没有 handler 时抛 bad_alloc；align 为 0 表示普通 new
+ALLOC_TRACKER_NOINLINE void* allocateWithHandler(size_t size, size_t align, uintptr_t pc) {
+    for (;;) {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+        if (void* ptr = allocateAligned(size, align, pc)) {
+            return ptr;
+        }
+    }
+}
+
+ALLOC_TRACKER_INLINE void* allocateOrThrow(size_t size, uintptr_t pc) {
+    if (void* ptr = allocate(size, pc)) {
+        return ptr;
+    }
+    return allocateWithHandler(size, 0, pc);
+}
+
+ALLOC_TRACKER_INLINE void* allocateAlignedOrThrow(size_t size, size_t align, uintptr_t pc) {
+    if (void* ptr = allocateAligned(size, align, pc)) {
+        return ptr;
+    }
+    return allocateWithHandler(size, align, pc);
+}
+
+}  // namespace
+
+uint64_t sampleBytes() {
+    const uint64_t mean = g_sample_bytes.load(std::memory_order_relaxed);
+    return mean == kUnresolved ? resolveSampleBytes() : mean;
+}
+
+}  // namespace alloc_tracker
+
+// ==================== 全局替换 ====================
+// 不能内联：调用点就是这些函数的返回地址（delete 的返回地址是受保护模式报告里的释放位置）
+
+using alloc_tracker::allocateAlignedOrThrow;
+using alloc_tracker::allocateOrThrow;
+
+ALLOC_TRACKER_NOINLINE void* operator new(std::size_t size) {
+    return allocateOrThrow(size, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void* operator new[](std::size_t size) {
+    return allocateOrThrow(size, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return alloc_tracker::allocate(size, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return alloc_tracker::allocate(size, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void* operator new(std::size_t size, std::align_val_t align) {
+    return allocateAlignedOrThrow(size, static_cast<size_t>(align), ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void* operator new[](std::size_t size, std::align_val_t align) {
+    return allocateAlignedOrThrow(size, static_cast<size_t>(align), ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return alloc_tracker::allocateAligned(size, static_cast<size_t>(align), ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void* operator new[](std::size_t size, std::align_val_t align,
+                                            const std::nothrow_t&) noexcept {
+    return alloc_tracker::allocateAligned(size, static_cast<size_t>(align), ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete(void* ptr) noexcept {
+    alloc_tracker::deallocate(ptr, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete[](void* ptr) noexcept {
+    alloc_tracker::deallocate(ptr, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete(void* ptr, std::size_t) noexcept {
+    alloc_tracker::deallocate(ptr, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete[](void* ptr, std::size_t) noexcept {
+    alloc_tracker::deallocate(ptr, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    alloc_tracker::deallocate(ptr, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    alloc_tracker::deallocate(ptr, ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete(void* ptr, std::align_val_t align) noexcept {
+    alloc_tracker::deallocateAligned(ptr, static_cast<size_t>(align), ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete[](void* ptr, std::align_val_t align) noexcept {
+    alloc_tracker::deallocateAligned(ptr, static_cast<size_t>(align), ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete(void* ptr, std::size_t, std::align_val_t align) noexcept {
+    alloc_tracker::deallocateAligned(ptr, static_cast<size_t>(align), ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete[](void* ptr, std::size_t, std::align_val_t align) noexcept {
+    alloc_tracker::deallocateAligned(ptr, static_cast<size_t>(align), ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete(void* ptr, std::align_val_t align, const std::nothrow_t&) noexcept {
+    alloc_tracker::deallocateAligned(ptr, static_cast<size_t>(align), ALLOC_TRACKER_RETURN_ADDRESS());
+}
+
+ALLOC_TRACKER_NOINLINE void operator delete[](void* ptr, std::align_val_t align, const std::nothrow_t&) noexcept {
+    alloc_tracker::deallocateAligned(ptr, static_cast<size_t>(align), ALLOC_TRACKER_RETURN_ADDRESS());
+}
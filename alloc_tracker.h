@@ -0,0 +1,71 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_ALLOC_TRACKER_H
+#define HANDS_ON_CPP_ALLOC_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ==================== 分配追踪 ====================
+// 链接 alloc_tracker.cpp 就会替换全局 operator new/delete（所有重载），按调用点统计
+// 分配次数、释放次数、累计字节和存活对象：
+// - 默认按字节采样：平均每 R 字节（ALLOC_TRACKER_DEFAULT_SAMPLE_BYTES，默认 512 KB）抽中一次分配，
+//   没抽中的直接 malloc，不加头也不记账；抽中的加 16 字节头，按抽中概率的倒数放大后记账，
+//   所以各项数字是无偏的估计值，调用点分配得越多越准，偶尔分配的小对象可能一次都没抽中
+// - 精确模式（采样间隔为 0）：每块内存前面加 16 字节头，记下调用点编号和大小，每次分配和释放都记账，
+//   并能发现重复释放和释放非 new 分配的指针
+// - 计数先记在线程局部缓冲里，攒够一批（或线程退出）再用原子加合并到全局表，全局表无锁
+// - 进程退出时打印泄漏报告（存活对象非 0 的调用点）；收到 SIGUSR1 时打印当前统计
+// - 可选：每 N 次记账采样一次调用栈，每个调用点只保存第一次采到的
+// - 可选：受保护模式，分配改走 guarded_heap（独占页 + 保护页 + 释放后隔离），悬空访问立刻出错并报告分配/释放位置；
+//   受保护的块总是记账
+// 环境变量：ALLOC_TRACKER_SAMPLE_BYTES=R 设置采样间隔，0 表示精确模式，第一次分配时读取，之后不能再改；
+// ALLOC_TRACKER_REPORT=0 关闭退出报告；ALLOC_TRACKER_SAMPLE=N 开启调用栈采样；
+// ALLOC_TRACKER_GUARD=N 开启受保护模式，每 N 次分配保护一次（1 表示全部）；
+// ALLOC_TRACKER_QUARANTINE_MB=M 设置隔离区容量；ALLOC_TRACKER_GUARD_BATCH=K 每 K 个释放的块批量 mprotect 一次。
+// 其他线程缓冲里还没合并的计数不会出现在报告里，线程退出时会合并。
+
+namespace alloc_tracker {
+
+struct SiteStats {
+    const void* site = nullptr;  // 调用 operator new 的返回地址
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t bytes_freed = 0;
+
+    int64_t liveObjects() const { return static_cast<int64_t>(allocations - frees); }
+    int64_t liveBytes() const { return static_cast<int64_t>(bytes_allocated - bytes_freed); }
+};
+
+// 把当前线程缓冲里的计数合并到全局表
+void flushThread();
+
+// 所有调用点的统计（会先合并当前线程）；返回的 vector 本身的分配也会被统计
+std::vector<SiteStats> sites();
+
+// 所有调用点加起来（不分配内存）
+SiteStats totals();
+
+// 写报告到文件描述符；leaks_only 为 true 时只列出存活对象非 0 的调用点。
+// 只用栈上缓冲和 write，可以在信号处理函数里调用
+void writeReport(int fd, bool leaks_only);
+
+// 每 interval 次记账采样一次调用栈，0 表示关闭
+void setSampleInterval(uint32_t interval);
+
+void setReportAtExit(bool enabled);
+
+// 平均每多少字节记账一次，0 表示精确模式（每次分配都记账）
+uint64_t sampleBytes();
+
+// 受保护模式：每 interval 次分配交给 guarded_heap 一次，0 表示关闭。
+// 第一次开启时安装 SIGSEGV 处理函数；关闭后已经分配的受保护块仍然正常释放
+void setGuardInterval(uint32_t interval);
+
+}  // namespace alloc_tracker
+
+#endif //HANDS_ON_CPP_ALLOC_TRACKER_H
@@ -0,0 +1,158 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 分配追踪的开销：这个程序链接了 alloc_tracker，operator new/delete 都经过追踪（默认按字节采样记账）。
+// 负载和 mem_manage.cpp 里 performanceComparison 的堆分配循环一样：每批 1000 个 400 字节对象，分配、求和、释放。
+// 三组：
+// - 标准库 new/delete：用 dlsym(RTLD_NEXT) 找到被替换掉的 libstdc++ 的 operator new/delete，就是不链接追踪时的样子
+// - malloc/free + placement new：比标准库少一次跨库调用，是更严的下限
+// - 追踪的 new/delete
+// 预算：相对标准库 new/delete 的开销不超过 5%。默认的采样模式下没抽中的分配只多一次线程局部的比较和减法、
+// 释放只多一次页内偏移的比较，单核开发机上测到 2%~5%；ALLOC_TRACKER_SAMPLE_BYTES=0（精确模式，每次都记账）是 15%~25%。
+// glibc 默认每批释放后把堆还给内核，一半时间花在 brk 和缺页上，这里用 mallopt 关掉了。
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <span>
+#include <string>
+#include <vector>
+
+#if __has_include(<dlfcn.h>)
+#include <dlfcn.h>
+#endif
+#if __has_include(<malloc.h>)
+#include <malloc.h>
+#endif
+
+#include "alloc_tracker.h"
+#include "bench_harness.h"
+#include "simd_kernels.h"
+
+class TestObject {
+public:
+    TestObject(int value = 0) {
+        for (int i = 0; i < 100; i++) {
+            data[i] = value + i;
+        }
+    }
+
+    int getSum() const { return simd::sum(std::span<const int32_t>(data, 100)); }
+
+private:
+    int data[100];
+};
+
+// 标准库的 operator new/delete；找不到时（静态链接标准库、没有 RTLD_NEXT 的平台）为空
+struct StandardNew {
+    void* (*allocate)(std::size_t) = nullptr;
+    void (*release)(void*) = nullptr;
+};
+
+StandardNew findStandardNew() {
+    StandardNew result;
+#ifdef RTLD_NEXT
+    // Itanium ABI 的名字：operator new(std::size_t) 和 operator delete(void*)
+    const char* new_name = sizeof(std::size_t) == 8 ? "_Znwm" : "_Znwj";
+    result.allocate = reinterpret_cast<void* (*)(std::size_t)>(dlsym(RTLD_NEXT, new_name));
+    result.release = reinterpret_cast<void (*)(void*)>(dlsym(RTLD_NEXT, "_ZdlPv"));
+    if (!result.allocate || !result.release) {
+        result = {};
+    }
+#endif
+    return result;
+}
+
+template <typename Alloc, typename Release>
+void heapLoop(bench::State& state, int batch, Alloc alloc, Release release) {
+    std::vector<TestObject*> objects(batch);
+    unsigned next = 0;
+    for (auto _ : state) {
+        for (int j = 0; j < batch; j++) {
+            objects[j] = alloc(static_cast<int>(next++));
+        }
+        for (int j = 0; j < batch; j++) {
+            bench::doNotOptimize(objects[j]->getSum());
+        }
+        for (TestObject* obj : objects) {
+            release(obj);
+        }
+    }
+    state.setItemsPerIteration(batch);
+}
+
+int main(int argc, char* argv[]) {
+    const int batch = 1000;
+    alloc_tracker::setReportAtExit(false);
+#ifdef M_TRIM_THRESHOLD
+    // glibc 默认每批释放后把堆顶还给内核，下一批再缺页要回来，一半时间花在内核里，比要测的差别大得多；
+    // 三组用的是同一个 malloc，关掉归还只去掉这部分噪声
+    mallopt(M_TRIM_THRESHOLD, 256 << 20);
+    mallopt(M_TOP_PAD, 16 << 20);
+#endif
+
+    const StandardNew standard = findStandardNew();
+    if (!standard.allocate) {
+        std::cout << "找不到标准库的 operator new，只和 malloc/free 比较" << std::endl;
+    }
+
+    // 各组交替注册、运行多轮，机器噪声一阵一阵的，多轮让每组都有机会落在安静的时段
+    const int rounds = 5;
+    const int groups = standard.allocate ? 3 : 2;
+    bench::Runner runner(bench::parseOptions(argc, argv));
+    for (int round = 1; round <= rounds; ++round) {
+        const std::string suffix = " #" + std::to_string(round);
+        if (standard.allocate) {
+            runner.add("标准库 new/delete（不追踪）" + suffix, [&](bench::State& state) {
+                heapLoop(state, batch,
+                    [&](int i) { return ::new (standard.allocate(sizeof(TestObject))) TestObject(i); },
+                    [&](TestObject* obj) {
+                        obj->~TestObject();
+                        standard.release(obj);
+                    });
+            });
+        }
+        runner.add("malloc/free（不追踪）" + suffix, [&](bench::State& state) {
+            heapLoop(state, batch,
+                [](int i) { return ::new (std::malloc(sizeof(TestObject))) TestObject(i); },
+                [](TestObject* obj) {
+                    obj->~TestObject();
+                    std::free(obj);
+                });
+        });
+        runner.add("new/delete（追踪）" + suffix, [&](bench::State& state) {
+            heapLoop(state, batch,
+                [](int i) { return new TestObject(i); },
+                [](TestObject* obj) { delete obj; });
+        });
+    }
+    std::vector<bench::Result> results = runner.run();
+    if (results.size() != static_cast<size_t>(groups * rounds)) {
+        return 0;  // 用 --bench_filter 只跑了一部分
+    }
+
+    // 追踪组相对第 baseline 组的开销，比的是各组在所有轮里最快的一次重复。
+    // 开发机上别的虚拟机抢占、缺页这些噪声只会让时间变长，而且一来就是几秒，整轮都会被拖慢：
+    // 单次重复的中位数、甚至每轮的最小值都会差 10%~20%，比要测的差别还大
+    auto fastest = [&](int group) {
+        double best = results[group].min;
+        for (int round = 1; round < rounds; ++round) {
+            best = std::min(best, results[groups * round + group].min);
+        }
+        return best;
+    };
+    auto overheadAgainst = [&](int baseline) { return (fastest(groups - 1) / fastest(baseline) - 1.0) * 100.0; };
+    if (standard.allocate) {
+        std::cout << "追踪开销，相对 malloc/free（各组最快的一次）: " << overheadAgainst(1) << "%" << std::endl;
+    }
+    // 预算按第 0 组算：有标准库 new/delete 时是它，否则是 malloc/free
+    const double overhead = overheadAgainst(0);
+    std::cout << "追踪开销，相对" << (standard.allocate ? "标准库 new/delete" : " malloc/free") << "（各组最快的一次）: "
+              << overhead << "%（预算 5%）" << (overhead <= 5.0 ? "" : "  超出预算!") << std::endl;
+
+    alloc_tracker::SiteStats total = alloc_tracker::totals();
+    std::cout << "已记录: 分配 " << total.allocations << " 次, 释放 " << total.frees << " 次" << std::endl;
+    return 0;
+}
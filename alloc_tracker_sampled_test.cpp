@@ -0,0 +1,121 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// alloc_tracker 的采样模式：链接默认（按字节采样）的 alloc_tracker。
+// 估计值有随机误差：每个检查分配 160 MB 左右，按默认 512 KB 的间隔约抽中 300 次，相对误差的标准差约 6%，
+// 这里允许 30%；存活数是精确的：抽中的块释放时按分配时的权重扣掉，全部释放后一定回到原来的数。
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "alloc_tracker.h"
+#include "test_check.h"
+
+namespace {
+
+constexpr size_t kObjectSize = 400;
+constexpr uint64_t kCount = 400000;
+
+bool near(double estimate, double expected) { return std::fabs(estimate - expected) <= 0.3 * expected; }
+
+// 分配后立刻释放：分配数、释放数、字节数都是估计值，存活数不变
+void testEstimates() {
+    CHECK(alloc_tracker::sampleBytes() != 0);
+    const alloc_tracker::SiteStats before = alloc_tracker::totals();
+    for (uint64_t i = 0; i < kCount; ++i) {
+        char* data = new char[kObjectSize];
+        data[0] = static_cast<char>(i);
+        delete[] data;
+    }
+    const alloc_tracker::SiteStats after = alloc_tracker::totals();
+    CHECK(near(static_cast<double>(after.allocations - before.allocations), kCount));
+    CHECK(near(static_cast<double>(after.bytes_allocated - before.bytes_allocated), kCount * kObjectSize));
+    CHECK(after.liveObjects() == before.liveObjects());
+    CHECK(after.liveBytes() == before.liveBytes());
+}
+
+// 存活对象的估计；先留出 vector 的空间，循环里只有要测的分配
+void testLiveEstimate() {
+    std::vector<char*> live;
+    live.reserve(kCount);
+    const alloc_tracker::SiteStats before = alloc_tracker::totals();
+    for (uint64_t i = 0; i < kCount; ++i) {
+        live.push_back(new char[kObjectSize]);
+    }
+    const alloc_tracker::SiteStats during = alloc_tracker::totals();
+    CHECK(near(static_cast<double>(during.liveObjects() - before.liveObjects()), kCount));
+    CHECK(near(static_cast<double>(during.liveBytes() - before.liveBytes()), kCount * kObjectSize));
+    for (char* data : live) {
+        delete[] data;
+    }
+    const alloc_tracker::SiteStats after = alloc_tracker::totals();
+    CHECK(after.liveObjects() == before.liveObjects());
+    CHECK(after.liveBytes() == before.liveBytes());
+}
+
+// 对齐分配：抽中和没抽中的块都满足对齐，可以写满，释放后存活数回到原来的数
+void testAligned() {
+    const alloc_tracker::SiteStats before = alloc_tracker::totals();
+    const size_t alignments[] = {32, 64, 4096, 8192};
+    bool aligned = true;
+    for (size_t align : alignments) {
+        for (uint64_t i = 0; i < kCount / 4; ++i) {
+            void* ptr = ::operator new(kObjectSize, std::align_val_t(align));
+            aligned = aligned && reinterpret_cast<uintptr_t>(ptr) % align == 0;
+            std::memset(ptr, 0xAB, kObjectSize);
+            ::operator delete(ptr, std::align_val_t(align));
+        }
+    }
+    CHECK(aligned);
+    const alloc_tracker::SiteStats after = alloc_tracker::totals();
+    CHECK(near(static_cast<double>(after.allocations - before.allocations), kCount));
+    CHECK(after.liveObjects() == before.liveObjects());
+}
+
+// 多个线程各自采样，线程退出时合并；一个线程分配、另一个线程释放也能正确扣掉
+void testThreads() {
+    constexpr int kThreads = 4;
+    std::vector<std::vector<char*>> blocks(kThreads);
+    for (std::vector<char*>& list : blocks) {
+        list.reserve(kCount / kThreads);
+    }
+    const alloc_tracker::SiteStats before = alloc_tracker::totals();
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&blocks, t] {
+                for (uint64_t i = 0; i < kCount / kThreads; ++i) {
+                    blocks[t].push_back(new char[kObjectSize]);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+    const alloc_tracker::SiteStats during = alloc_tracker::totals();
+    CHECK(near(static_cast<double>(during.liveBytes() - before.liveBytes()), kCount * kObjectSize));
+    for (std::vector<char*>& list : blocks) {
+        for (char* data : list) {
+            delete[] data;
+        }
+    }
+    const alloc_tracker::SiteStats after = alloc_tracker::totals();
+    // 线程对象本身的分配（std::thread 的状态）也是被采样的，和测试的块一样释放掉了
+    CHECK(after.liveObjects() == before.liveObjects());
+    CHECK(after.liveBytes() == before.liveBytes());
+}
+
+}  // namespace
+
+int main() {
+    testEstimates();
+    testLiveEstimate();
+    testAligned();
+    testThreads();
+    return testResult();
+}
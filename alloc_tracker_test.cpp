@@ -0,0 +1,42 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// alloc_tracker：计数和对齐分配。链接了 alloc_tracker，这个进程里的 operator new/delete 都会记账。
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include "alloc_tracker.h"
+#include "test_check.h"
+
+// 每种对齐下指针对齐、可以写满，释放时头部完好（align 比头部小时头部曾经写到 malloc 块前面）
+void testAlignedNew() {
+    const alloc_tracker::SiteStats before = alloc_tracker::totals();
+    const size_t alignments[] = {8, 16, 32, 64, 4096};
+    for (size_t align : alignments) {
+        void* ptr = ::operator new(24, std::align_val_t(align));
+        CHECK(reinterpret_cast<uintptr_t>(ptr) % align == 0);
+        std::memset(ptr, 0xAB, 24);
+        ::operator delete(ptr, std::align_val_t(align));
+    }
+    const alloc_tracker::SiteStats after = alloc_tracker::totals();
+    CHECK(after.allocations - before.allocations == 5);
+    CHECK(after.frees - before.frees == 5);
+    CHECK(after.bytes_allocated - before.bytes_allocated == 5 * 24);
+}
+
+// 存活对象：分配之后多一个，释放之后回到原来的数
+void testLiveObjects() {
+    const int64_t before = alloc_tracker::totals().liveObjects();
+    int* value = new int(42);
+    CHECK(alloc_tracker::totals().liveObjects() == before + 1);
+    delete value;
+    CHECK(alloc_tracker::totals().liveObjects() == before);
+}
+
+int main() {
+    testAlignedNew();
+    testLiveObjects();
+    return testResult();
+}
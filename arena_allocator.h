@@ -0,0 +1,204 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_ARENA_ALLOCATOR_H
+#define HANDS_ON_CPP_ARENA_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+// ==================== 单调（bump）分配器 ====================
+// 从大块内存中顺序切分，deallocate 什么都不做，
+// 一批对象用完之后调用 reset() 一次性回收，已申请的内存块留给下一批复用。
+
+class MonotonicArena : public std::pmr::memory_resource {
+public:
+    explicit MonotonicArena(size_t chunk_size = 64 * 1024,
+                            std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : chunk_size_(chunk_size), upstream_(upstream) {}
+
+    ~MonotonicArena() override { release(); }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    // 回到第一个内存块的开头，所有内存块保留下来继续用（不调用析构函数）
+    void reset() {
+        current_ = 0;
+        if (!chunks_.empty()) {
+            ptr_ = chunks_[0].data;
+            end_ = ptr_ + chunks_[0].size;
+        }
+    }
+
+    // 把所有内存块还给上游
+    void release() {
+        for (const Chunk& chunk : chunks_) {
+            upstream_->deallocate(chunk.data, chunk.size, alignof(std::max_align_t));
+        }
+        chunks_.clear();
+        current_ = 0;
+        ptr_ = end_ = nullptr;
+    }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Chunk& chunk : chunks_) {
+            total += chunk.size;
+        }
+        return total;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        for (;;) {
+            auto p = reinterpret_cast<std::uintptr_t>(ptr_);
+            auto aligned = (p + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+            if (ptr_ && aligned + bytes <= reinterpret_cast<std::uintptr_t>(end_)) {
+                ptr_ = reinterpret_cast<std::byte*>(aligned + bytes);
+                return reinterpret_cast<void*>(aligned);
+            }
+            nextChunk(bytes + alignment);
+        }
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}  // 由 reset()/release() 统一回收
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    struct Chunk {
+        std::byte* data;
+        size_t size;
+    };
+
+    // 先复用 reset() 之前留下的块，不够大或用完了再向上游申请
+    void nextChunk(size_t min_size) {
+        while (!chunks_.empty() && current_ + 1 < chunks_.size()) {
+            ++current_;
+            if (chunks_[current_].size >= min_size) {
+                ptr_ = chunks_[current_].data;
+                end_ = ptr_ + chunks_[current_].size;
+                return;
+            }
+        }
+        size_t size = std::max(chunk_size_, min_size);
+        auto* data = static_cast<std::byte*>(upstream_->allocate(size, alignof(std::max_align_t)));
+        chunks_.push_back({data, size});
+        current_ = chunks_.size() - 1;
+        ptr_ = data;
+        end_ = data + size;
+    }
+
+    size_t chunk_size_;
+    std::pmr::memory_resource* upstream_;
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;
+    std::byte* ptr_ = nullptr;
+    std::byte* end_ = nullptr;
+};
+
+// ==================== 定长对象池 ====================
+// 按 slab 批量申请 T 大小的槽位，释放的槽位串成单链表（free list）复用。
+// 作为 memory_resource 使用时，不超过 sizeof(T)/alignof(T) 的请求走对象池，其他转交上游。
+
+template <typename T>
+class ObjectPool : public std::pmr::memory_resource {
+public:
+    explicit ObjectPool(size_t objects_per_slab = 1024,
+                        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : objects_per_slab_(std::max<size_t>(objects_per_slab, 1)), upstream_(upstream) {}
+
+    ~ObjectPool() override {
+        for (void* slab : slabs_) {
+            upstream_->deallocate(slab, objects_per_slab_ * sizeof(Slot), alignof(Slot));
+        }
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        void* p = allocateSlot();
+        try {
+            return ::new (p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            freeSlot(p);
+            throw;
+        }
+    }
+
+    void destroy(T* obj) {
+        if (obj) {
+            obj->~T();
+            freeSlot(obj);
+        }
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (bytes <= sizeof(Slot) && alignment <= alignof(Slot)) {
+            return allocateSlot();
+        }
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        if (bytes <= sizeof(Slot) && alignment <= alignof(Slot)) {
+            freeSlot(p);
+        } else {
+            upstream_->deallocate(p, bytes, alignment);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    union Slot {
+        Slot* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    void* allocateSlot() {
+        if (!free_list_) {
+            grow();
+        }
+        Slot* slot = free_list_;
+        free_list_ = slot->next;
+        return slot;
+    }
+
+    void freeSlot(void* p) {
+        auto* slot = static_cast<Slot*>(p);
+        slot->next = free_list_;
+        free_list_ = slot;
+    }
+
+    void grow() {
+        auto* slab = static_cast<Slot*>(upstream_->allocate(objects_per_slab_ * sizeof(Slot), alignof(Slot)));
+        slabs_.push_back(slab);
+        // 倒序串起来，这样分配顺序和内存地址顺序一致
+        for (size_t i = objects_per_slab_; i-- > 0;) {
+            slab[i].next = free_list_;
+            free_list_ = &slab[i];
+        }
+    }
+
+    size_t objects_per_slab_;
+    std::pmr::memory_resource* upstream_;
+    std::vector<void*> slabs_;
+    Slot* free_list_ = nullptr;
+};
+
+#endif //HANDS_ON_CPP_ARENA_ALLOCATOR_H
@@ -0,0 +1,182 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_ARENA_TREE_H
+#define HANDS_ON_CPP_ARENA_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// ==================== 基于下标的树 ====================
+// ptr_ref_test.cpp 里的 Parent/Child 用 shared_ptr 持有子节点、weak_ptr 指回父节点：
+// 每个节点一次堆分配加一个控制块，访问父节点要 lock()（原子加减引用计数），销毁时逐个节点递归释放。
+// ArenaTree 把所有节点放在连续数组里，父子兄弟关系都是 32 位下标：
+// - 每个节点是 16 字节的链接（parent/first_child/last_child/next_sibling）加上 T，放在同一个数组元素里，
+//   遍历时读链接和读值是同一条缓存行
+// - 访问父节点就是读一个下标，不需要引用计数；节点之间没有所有权关系，也就不存在循环引用
+// - 没有单独删除子树的操作，整棵树（可以是多棵树组成的森林）一起 clear()：
+//   T 可平凡析构时是 O(1)，否则只剩 T 自己的析构，没有逐节点的 free 和引用计数
+// 加节点可能让数组扩容，之前拿到的 T& 会失效，NodeId 一直有效。
+
+template <typename T>
+class ArenaTree {
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId kNone = std::numeric_limits<NodeId>::max();
+
+    ArenaTree() = default;
+
+    explicit ArenaTree(size_t expected_nodes) { reserve(expected_nodes); }
+
+    void reserve(size_t nodes) { nodes_.reserve(nodes); }
+
+    // 新建一棵树的根节点
+    template <typename... Args>
+    NodeId addRoot(Args&&... args) {
+        return append(kNone, std::forward<Args>(args)...);
+    }
+
+    // 在 parent 的子节点末尾追加一个节点
+    template <typename... Args>
+    NodeId addChild(NodeId parent, Args&&... args) {
+        const NodeId id = append(parent, std::forward<Args>(args)...);
+        Node& p = nodes_[parent];
+        if (p.last_child == kNone) {
+            p.first_child = id;
+        } else {
+            nodes_[p.last_child].next_sibling = id;
+        }
+        p.last_child = id;
+        return id;
+    }
+
+    T& operator[](NodeId id) { return nodes_[id].value; }
+    const T& operator[](NodeId id) const { return nodes_[id].value; }
+
+    NodeId parent(NodeId id) const { return nodes_[id].parent; }
+    NodeId firstChild(NodeId id) const { return nodes_[id].first_child; }
+    NodeId nextSibling(NodeId id) const { return nodes_[id].next_sibling; }
+
+    size_t size() const { return nodes_.size(); }
+    bool empty() const { return nodes_.empty(); }
+
+    // 销毁所有节点，保留数组容量给下一棵树复用
+    void clear() { nodes_.clear(); }
+
+    template <typename Fn>
+    void forEachChild(NodeId id, Fn&& fn) const {
+        for (NodeId child = nodes_[id].first_child; child != kNone; child = nodes_[child].next_sibling) {
+            fn(child);
+        }
+    }
+
+    // 先序深度优先遍历 root 的子树，fn(NodeId)。
+    // 不需要栈：有子节点就下去，否则找兄弟，没有兄弟就沿父节点往回找，回到 root 时结束
+    template <typename Fn>
+    void visitDepthFirst(NodeId root, Fn&& fn) const {
+        NodeId id = root;
+        for (;;) {
+            fn(id);
+            const Node& node = nodes_[id];
+            if (node.first_child != kNone) {
+                // 兄弟节点要等整棵子树走完才访问，现在就预取，和子树里的访存重叠
+                if (node.next_sibling != kNone) {
+                    prefetch(node.next_sibling);
+                }
+                id = node.first_child;
+                continue;
+            }
+            while (id != root && nodes_[id].next_sibling == kNone) {
+                id = nodes_[id].parent;
+            }
+            if (id == root) {
+                return;
+            }
+            id = nodes_[id].next_sibling;
+        }
+    }
+
+    // 按深度优先先序重新编号所有节点，之后先序遍历就是顺序扫描数组，每棵子树也占一段连续下标。
+    // 乱序建好的大树遍历前调用一次；返回旧编号到新编号的映射，调用方手里的 NodeId 要用它换算
+    std::vector<NodeId> relayoutDepthFirst() {
+        std::vector<NodeId> order;
+        order.reserve(nodes_.size());
+        for (NodeId root = 0; root < nodes_.size(); ++root) {
+            if (nodes_[root].parent == kNone) {
+                visitDepthFirst(root, [&order](NodeId id) { order.push_back(id); });
+            }
+        }
+        std::vector<NodeId> remap(nodes_.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            remap[order[i]] = static_cast<NodeId>(i);
+        }
+        auto mapped = [&remap](NodeId id) { return id == kNone ? kNone : remap[id]; };
+
+        std::vector<Node> relaid;
+        relaid.reserve(nodes_.size());
+        for (NodeId old : order) {
+            Node& node = nodes_[old];
+            relaid.emplace_back(mapped(node.parent), std::move(node.value));
+            relaid.back().first_child = mapped(node.first_child);
+            relaid.back().last_child = mapped(node.last_child);
+            relaid.back().next_sibling = mapped(node.next_sibling);
+        }
+        nodes_ = std::move(relaid);
+        return remap;
+    }
+
+    // 广度优先遍历 root 的子树，fn(NodeId)。队列用成员里的缓冲，反复遍历时不再分配
+    template <typename Fn>
+    void visitBreadthFirst(NodeId root, Fn&& fn) {
+        queue_.clear();
+        queue_.push_back(root);
+        for (size_t head = 0; head < queue_.size(); ++head) {
+            const NodeId id = queue_[head];
+            fn(id);
+            for (NodeId child = nodes_[id].first_child; child != kNone; child = nodes_[child].next_sibling) {
+                queue_.push_back(child);
+            }
+        }
+    }
+
+private:
+    struct Node {
+        template <typename... Args>
+        explicit Node(NodeId parent, Args&&... args)
+            : parent(parent), first_child(kNone), last_child(kNone), next_sibling(kNone),
+              value(std::forward<Args>(args)...) {}
+
+        NodeId parent;
+        NodeId first_child;
+        NodeId last_child;
+        NodeId next_sibling;
+        T value;
+    };
+
+    void prefetch(NodeId id) const {
+#if defined(__GNUC__)
+        __builtin_prefetch(&nodes_[id]);
+#else
+        (void)id;
+#endif
+    }
+
+    template <typename... Args>
+    NodeId append(NodeId parent, Args&&... args) {
+        if (nodes_.size() >= kNone) {
+            throw std::length_error("ArenaTree 的节点数超过 32 位下标的范围");
+        }
+        nodes_.emplace_back(parent, std::forward<Args>(args)...);
+        return static_cast<NodeId>(nodes_.size() - 1);
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<NodeId> queue_;
+};
+
+#endif //HANDS_ON_CPP_ARENA_TREE_H
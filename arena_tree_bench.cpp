@@ -0,0 +1,171 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 百万节点的树：ptr_ref_test.cpp 里 Parent/Child 的写法（shared_ptr 持有子节点、weak_ptr 指回父节点）
+// 推广到多层 vs ArenaTree。比较建树、深度优先/广度优先遍历、对每个节点访问一次父节点（visitParent）、销毁。
+// 树的形状：节点 i 的父节点在 [0, i) 里均匀随机选，深度大约 ln N。
+// shared_ptr 版本建树时需要一张下标 -> shared_ptr 的表来设置 weak_ptr 父指针，表的释放算在建树里。
+// "ArenaTree + 重排" 在建树后调用 relayoutDepthFirst()，重排的时间算在建树里。
+// 每项跑 5 轮取中位数。用法：arena_tree_bench [节点数]，默认 100 万
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "arena_tree.h"
+#include "bench_harness.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct SharedNode {
+    explicit SharedNode(uint64_t value) : value(value) {}
+
+    uint64_t value;
+    std::weak_ptr<SharedNode> parent;
+    std::vector<std::shared_ptr<SharedNode>> children;
+};
+
+using Tree = ArenaTree<uint64_t>;
+
+struct Times {
+    std::vector<double> build, dfs, bfs, parent, destroy;  // 毫秒
+};
+
+double millisSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+void runShared(const std::vector<uint32_t>& parents, Times& t) {
+    const size_t n = parents.size();
+    auto start = Clock::now();
+    std::shared_ptr<SharedNode> root;
+    {
+        std::vector<std::shared_ptr<SharedNode>> table(n);
+        table[0] = root = std::make_shared<SharedNode>(0);
+        for (size_t i = 1; i < n; ++i) {
+            auto child = std::make_shared<SharedNode>(i);
+            child->parent = table[parents[i]];
+            table[parents[i]]->children.push_back(child);
+            table[i] = std::move(child);
+        }
+    }
+    t.build.push_back(millisSince(start));
+
+    // 遍历用裸指针，不算 shared_ptr 拷贝的引用计数，已经是这种写法最快的遍历方式
+    std::vector<SharedNode*> stack;
+    uint64_t sum = 0;
+    start = Clock::now();
+    stack.push_back(root.get());
+    while (!stack.empty()) {
+        SharedNode* node = stack.back();
+        stack.pop_back();
+        sum += node->value;
+        for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
+            stack.push_back(it->get());
+        }
+    }
+    t.dfs.push_back(millisSince(start));
+
+    std::vector<SharedNode*> queue;
+    queue.reserve(n);
+    start = Clock::now();
+    queue.push_back(root.get());
+    for (size_t head = 0; head < queue.size(); ++head) {
+        SharedNode* node = queue[head];
+        sum += node->value;
+        for (const auto& child : node->children) {
+            queue.push_back(child.get());
+        }
+    }
+    t.bfs.push_back(millisSince(start));
+
+    // visitParent：每个节点 lock() 一次父节点
+    start = Clock::now();
+    for (SharedNode* node : queue) {
+        if (auto parent = node->parent.lock()) {
+            sum += parent->value;
+        }
+    }
+    t.parent.push_back(millisSince(start));
+    bench::doNotOptimize(sum);
+
+    queue.clear();
+    start = Clock::now();
+    root.reset();
+    t.destroy.push_back(millisSince(start));
+}
+
+void runArena(const std::vector<uint32_t>& parents, bool relayout, Times& t) {
+    const size_t n = parents.size();
+    auto start = Clock::now();
+    auto tree = std::make_unique<Tree>();
+    tree->addRoot(0);
+    for (size_t i = 1; i < n; ++i) {
+        tree->addChild(parents[i], i);
+    }
+    if (relayout) {
+        tree->relayoutDepthFirst();
+    }
+    t.build.push_back(millisSince(start));
+
+    uint64_t sum = 0;
+    start = Clock::now();
+    tree->visitDepthFirst(0, [&](Tree::NodeId id) { sum += (*tree)[id]; });
+    t.dfs.push_back(millisSince(start));
+
+    start = Clock::now();
+    tree->visitBreadthFirst(0, [&](Tree::NodeId id) { sum += (*tree)[id]; });
+    t.bfs.push_back(millisSince(start));
+
+    start = Clock::now();
+    for (Tree::NodeId id = 0; id < tree->size(); ++id) {
+        const Tree::NodeId parent = tree->parent(id);
+        if (parent != Tree::kNone) {
+            sum += (*tree)[parent];
+        }
+    }
+    t.parent.push_back(millisSince(start));
+    bench::doNotOptimize(sum);
+
+    start = Clock::now();
+    tree.reset();
+    t.destroy.push_back(millisSince(start));
+}
+
+void printRow(const char* name, const Times& t) {
+    std::cout << "  " << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << median(t.build) << std::setw(10) << median(t.dfs) << std::setw(10) << median(t.bfs)
+              << std::setw(10) << median(t.parent) << std::setw(10) << median(t.destroy) << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t n = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+    std::vector<uint32_t> parents(n);
+    std::mt19937 rng(42);
+    for (size_t i = 1; i < n; ++i) {
+        parents[i] = static_cast<uint32_t>(rng() % i);
+    }
+
+    Times shared, arena, relaid;
+    for (int round = 0; round < 5; ++round) {
+        runShared(parents, shared);
+        runArena(parents, false, arena);
+        runArena(parents, true, relaid);
+    }
+    std::cout << n << " 个节点，毫秒（5 轮中位数）  建树   深度优先  广度优先  访问父节点  销毁" << std::endl;
+    printRow("shared_ptr/weak_ptr", shared);
+    printRow("ArenaTree", arena);
+    printRow("ArenaTree + 重排", relaid);
+    return 0;
+}
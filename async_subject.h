@@ -0,0 +1,177 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_ASYNC_SUBJECT_H
+#define HANDS_ON_CPP_ASYNC_SUBJECT_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "message.h"
+#include "mpmc_queue.h"
+
+// ==================== 异步观察者通知 ====================
+// notify 只负责把消息切成若干批投递任务放进分发线程池，立刻返回，发布者不会被慢的 update 拖住。
+// - 观察者列表是写时复制的快照：attach 复制一份新列表再原子替换，notify 只读当前快照，互不阻塞
+// - 观察者按下标切成固定大小的批，第 k 批总是交给第 k % N 个线程，同一个观察者收到的消息保持顺序
+// - 投递时发现过期的观察者，由发现它的线程做一次 swap-and-pop 压缩，不在遍历中途 erase
+//   （压缩会让末尾的观察者换到别的批次，压缩前后相邻的两条消息对它来说可能乱序）
+// - 消息是 Message：短消息内联存储，长消息只分配一次、之后按引用计数共享，所以一次 notify 最多一次分配
+// ObserverT 需要提供 update(std::string_view)。
+
+template <typename ObserverT>
+class AsyncSubject {
+public:
+    using ObserverList = std::vector<std::weak_ptr<ObserverT>>;
+
+    explicit AsyncSubject(unsigned workers = std::max(1u, std::thread::hardware_concurrency()),
+                          size_t batch_size = 256, size_t queue_capacity = 1024)
+        : batch_size_(std::max<size_t>(batch_size, 1)),
+          observers_(std::make_shared<const ObserverList>()) {
+        workers = std::max(1u, workers);
+        for (unsigned i = 0; i < workers; ++i) {
+            queues_.push_back(std::make_unique<BlockingQueue<Task>>(queue_capacity));
+        }
+        for (unsigned i = 0; i < workers; ++i) {
+            threads_.emplace_back(&AsyncSubject::workerLoop, this, i);
+        }
+    }
+
+    // 先把已经入队的消息投递完再退出
+    ~AsyncSubject() {
+        flush();
+        for (auto& queue : queues_) {
+            queue->push(Task{});  // 没有观察者列表的任务表示退出
+        }
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    AsyncSubject(const AsyncSubject&) = delete;
+    AsyncSubject& operator=(const AsyncSubject&) = delete;
+
+    void attach(std::shared_ptr<ObserverT> observer) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        auto next = std::make_shared<ObserverList>(*observers_.load());
+        next->push_back(observer);
+        observers_.store(std::move(next));
+    }
+
+    // 异步通知：只在投递队列满时才会等待
+    void notify(std::string_view message) { notify(Message(message)); }
+
+    void notify(const Message& message) {
+        std::shared_ptr<const ObserverList> snapshot = observers_.load();
+        if (snapshot->empty()) {
+            return;
+        }
+        const size_t batches = (snapshot->size() + batch_size_ - 1) / batch_size_;
+        pending_.fetch_add(batches, std::memory_order_relaxed);
+        for (size_t b = 0; b < batches; ++b) {
+            const size_t begin = b * batch_size_;
+            const size_t end = std::min(begin + batch_size_, snapshot->size());
+            queues_[b % queues_.size()]->push(Task{snapshot, message, begin, end});
+        }
+    }
+
+    // 等待所有已入队的消息投递完成
+    void flush() {
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        idle_.wait(lock, [this]() { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+
+    size_t observerCount() const { return observers_.load()->size(); }
+    uint64_t delivered() const { return delivered_.load(std::memory_order_relaxed); }
+    uint64_t expired() const { return expired_.load(std::memory_order_relaxed); }
+
+private:
+    struct Task {
+        std::shared_ptr<const ObserverList> observers;
+        Message message;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    void workerLoop(size_t id) {
+        for (;;) {
+            Task task = queues_[id]->pop();
+            if (!task.observers) {
+                return;
+            }
+
+            uint64_t delivered = 0;
+            bool saw_expired = false;
+            for (size_t i = task.begin; i < task.end; ++i) {
+                if (auto observer = (*task.observers)[i].lock()) {
+                    observer->update(task.message.view());
+                    ++delivered;
+                } else {
+                    saw_expired = true;
+                }
+            }
+            delivered_.fetch_add(delivered, std::memory_order_relaxed);
+
+            // 只让第一个发现的线程去压缩，其他线程继续投递；
+            // 基于旧快照的任务看到的过期项可能已经被压缩掉了，不必再做
+            if (saw_expired && !compacting_.exchange(true, std::memory_order_acq_rel)) {
+                compact(task.observers);
+                compacting_.store(false, std::memory_order_release);
+            }
+
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(idle_mutex_);
+                idle_.notify_all();
+            }
+        }
+    }
+
+    // 一次遍历：过期的元素和末尾元素交换后弹出，不保持顺序，整体 O(n)
+    void compact(const std::shared_ptr<const ObserverList>& seen) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        std::shared_ptr<const ObserverList> current = observers_.load();
+        if (current != seen) {
+            return;
+        }
+        auto next = std::make_shared<ObserverList>(*current);
+        size_t removed = 0;
+        for (size_t i = 0; i < next->size();) {
+            if ((*next)[i].expired()) {
+                if (i + 1 != next->size()) {
+                    (*next)[i] = std::move(next->back());
+                }
+                next->pop_back();
+                ++removed;
+            } else {
+                ++i;
+            }
+        }
+        if (removed > 0) {
+            expired_.fetch_add(removed, std::memory_order_relaxed);
+            observers_.store(std::move(next));
+        }
+    }
+
+    size_t batch_size_;
+    std::atomic<std::shared_ptr<const ObserverList>> observers_;
+    std::mutex writer_mutex_;  // 只串行化 attach 和 compact，notify 不需要它
+    std::vector<std::unique_ptr<BlockingQueue<Task>>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> expired_{0};
+    std::atomic<bool> compacting_{false};
+    std::mutex idle_mutex_;
+    std::condition_variable idle_;
+};
+
+#endif //HANDS_ON_CPP_ASYNC_SUBJECT_H
@@ -0,0 +1,453 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#include "bench_harness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+// ==================== 硬件计数器 ====================
+// 三个计数器放在同一个组里，一起开始、一起停止、一次 read 读出。
+// 只统计用户态，打开失败（没有权限、虚拟机不支持）就整体不可用。
+
+class PerfCounters {
+public:
+    static constexpr int kCount = 3;
+
+    PerfCounters() {
+#ifdef __linux__
+        const uint64_t configs[kCount] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                          PERF_COUNT_HW_CACHE_MISSES};
+        for (int i = 0; i < kCount; ++i) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = i == 0 ? 1 : 0;  // 只控制组长，组员跟随
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const int group = i == 0 ? -1 : fds_[0];
+            fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+            if (fds_[i] < 0) {
+                closeAll();
+                return;
+            }
+        }
+        available_ = true;
+#endif
+    }
+
+    ~PerfCounters() { closeAll(); }
+
+    bool available() const { return available_; }
+
+    void start() {
+#ifdef __linux__
+        if (available_) {
+            ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    // 计数器被内核分时复用时，按实际运行时间比例放大
+    bool stop(uint64_t values[kCount]) {
+#ifdef __linux__
+        if (!available_) {
+            return false;
+        }
+        ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        struct {
+            uint64_t nr;
+            uint64_t time_enabled;
+            uint64_t time_running;
+            uint64_t values[kCount];
+        } data{};
+        if (read(fds_[0], &data, sizeof(data)) < static_cast<ssize_t>(3 * sizeof(uint64_t)) ||
+            data.nr != kCount || data.time_running == 0) {
+            return false;
+        }
+        const double scale = static_cast<double>(data.time_enabled) / static_cast<double>(data.time_running);
+        for (int i = 0; i < kCount; ++i) {
+            values[i] = static_cast<uint64_t>(static_cast<double>(data.values[i]) * scale);
+        }
+        return true;
+#else
+        (void)values;
+        return false;
+#endif
+    }
+
+private:
+    void closeAll() {
+#ifdef __linux__
+        for (int& fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+#endif
+        available_ = false;
+    }
+
+    int fds_[kCount] = {-1, -1, -1};
+    bool available_ = false;
+};
+
+// ==================== 计时 ====================
+
+namespace {
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// 把当前线程绑定到 cpu；cpu == -2 时绑定到当前所在的 CPU。返回实际绑定的 CPU，失败或不绑定返回 -1
+int pinToCpu(int cpu) {
+#ifdef __linux__
+    if (cpu == -2) {
+        cpu = sched_getcpu();
+    }
+    if (cpu < 0) {
+        return -1;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? cpu : -1;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+// 最近秩法求分位数，values 已排序
+double percentile(const std::vector<double>& values, double p) {
+    size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+    return values[std::min(values.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    escaped += buffer;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+std::string csvEscape(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) {
+        return text;
+    }
+    std::string escaped = "\"";
+    for (char c : text) {
+        escaped += c;
+        if (c == '"') {
+            escaped += '"';
+        }
+    }
+    return escaped + "\"";
+}
+
+std::string currentTime() {
+    std::time_t now = std::time(nullptr);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    return buffer;
+}
+
+std::string hostName() {
+#ifdef __linux__
+    char buffer[256] = {};
+    if (gethostname(buffer, sizeof(buffer) - 1) == 0) {
+        return buffer;
+    }
+#endif
+    return "unknown";
+}
+
+bool startsWith(const std::string& text, const char* prefix, std::string* rest) {
+    const size_t n = std::strlen(prefix);
+    if (text.compare(0, n, prefix) != 0) {
+        return false;
+    }
+    *rest = text.substr(n);
+    return true;
+}
+
+}  // namespace
+
+void State::startTiming() {
+    if (perf_) {
+        perf_->start();
+    }
+    start_ns_ = nowNs();
+}
+
+void State::stopTiming() {
+    elapsed_ns_ = nowNs() - start_ns_;
+    perf_valid_ = perf_ && perf_->stop(perf_values_);
+}
+
+Options parseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        std::string value;
+        if (startsWith(arg, "--bench_filter=", &value)) {
+            options.filter = value;
+        } else if (startsWith(arg, "--bench_min_time=", &value)) {
+            options.min_time = std::stod(value);
+        } else if (startsWith(arg, "--bench_repetitions=", &value)) {
+            options.repetitions = std::max(1, std::stoi(value));
+        } else if (startsWith(arg, "--bench_cpu=", &value)) {
+            options.cpu = std::stoi(value);
+        } else if (startsWith(arg, "--bench_perf=", &value)) {
+            options.perf_counters = value != "0";
+        } else if (startsWith(arg, "--bench_json=", &value)) {
+            options.json_path = value;
+        } else if (startsWith(arg, "--bench_csv=", &value)) {
+            options.csv_path = value;
+        }
+    }
+    return options;
+}
+
+// ==================== 运行 ====================
+
+Runner::Runner(Options options) : options_(std::move(options)) {
+    pinned_cpu_ = pinToCpu(options_.cpu);
+    if (options_.perf_counters) {
+        perf_ = std::make_unique<PerfCounters>();
+        if (!perf_->available()) {
+            perf_.reset();
+        }
+    }
+}
+
+Runner::~Runner() = default;
+
+void Runner::add(std::string name, Function fn) { cases_.emplace_back(std::move(name), std::move(fn)); }
+
+State Runner::runOnce(const Function& fn, uint64_t iterations) {
+    State state(iterations, perf_.get());
+    fn(state);
+    return state;
+}
+
+Result Runner::runCase(const std::string& name, const Function& fn) {
+    // 标定：迭代次数按耗时比例放大（每轮最多 10 倍），直到一次运行超过 min_time；
+    // 最后一轮标定同时起到预热作用
+    const int64_t target_ns = static_cast<int64_t>(options_.min_time * 1e9);
+    uint64_t iterations = 1;
+    for (;;) {
+        State state = runOnce(fn, iterations);
+        if (state.elapsed_ns_ >= target_ns || iterations >= 1'000'000'000) {
+            break;
+        }
+        double multiplier = state.elapsed_ns_ > 0 ? 1.4 * target_ns / state.elapsed_ns_ : 10.0;
+        multiplier = std::clamp(multiplier, 1.0, 10.0);
+        iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * multiplier));
+    }
+
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.has_perf = perf_ != nullptr;
+    double perf_sums[PerfCounters::kCount] = {};
+    for (int r = 0; r < options_.repetitions; ++r) {
+        State state = runOnce(fn, iterations);
+        result.samples.push_back(static_cast<double>(state.elapsed_ns_) / static_cast<double>(iterations));
+        result.items_per_iteration = state.items_per_iteration_;
+        result.counters = state.counters_;
+        result.has_perf = result.has_perf && state.perf_valid_;
+        for (int i = 0; i < PerfCounters::kCount; ++i) {
+            perf_sums[i] += static_cast<double>(state.perf_values_[i]);
+        }
+    }
+
+    std::vector<double> sorted = result.samples;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0;
+    for (double v : sorted) {
+        sum += v;
+    }
+    result.mean = sum / static_cast<double>(sorted.size());
+    double squares = 0;
+    for (double v : sorted) {
+        squares += (v - result.mean) * (v - result.mean);
+    }
+    result.stddev = sorted.size() > 1 ? std::sqrt(squares / static_cast<double>(sorted.size() - 1)) : 0.0;
+    result.median = sorted.size() % 2 ? sorted[sorted.size() / 2]
+                                      : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2;
+    result.min = sorted.front();
+    result.max = sorted.back();
+    result.p90 = percentile(sorted, 0.90);
+    result.p99 = percentile(sorted, 0.99);
+    if (result.has_perf) {
+        const double total_iterations = static_cast<double>(iterations) * options_.repetitions;
+        result.cycles = perf_sums[0] / total_iterations;
+        result.instructions = perf_sums[1] / total_iterations;
+        result.cache_misses = perf_sums[2] / total_iterations;
+    }
+    return result;
+}
+
+std::vector<Result> Runner::run() {
+    std::vector<Result> results;
+    for (const auto& [name, fn] : cases_) {
+        if (name.find(options_.filter) == std::string::npos) {
+            continue;
+        }
+        results.push_back(runCase(name, fn));
+    }
+    printTable(results);
+    if (!options_.json_path.empty()) {
+        writeJson(results);
+    }
+    if (!options_.csv_path.empty()) {
+        writeCsv(results);
+    }
+    return results;
+}
+
+// ==================== 输出 ====================
+
+void Runner::printTable(const std::vector<Result>& results) const {
+    std::cout << "重复 " << options_.repetitions << " 次，每次至少 " << options_.min_time << " 秒，"
+              << (pinned_cpu_ >= 0 ? "绑定 CPU " + std::to_string(pinned_cpu_) : std::string("未绑定 CPU")) << "，"
+              << (perf_ ? "硬件计数器可用" : "硬件计数器不可用") << std::endl;
+    std::cout << std::left << std::setw(28) << "用例" << std::right << std::setw(12) << "迭代"
+              << std::setw(12) << "中位数ns" << std::setw(10) << "标准差" << std::setw(8) << "CV%"
+              << std::setw(12) << "p90" << std::setw(12) << "p99" << std::setw(12) << "ns/元素"
+              << std::setw(12) << "cycles" << std::setw(8) << "IPC" << std::setw(12) << "cache-miss" << std::endl;
+    std::ios state(nullptr);
+    state.copyfmt(std::cout);
+    std::cout << std::fixed << std::setprecision(1);
+    for (const Result& r : results) {
+        std::cout << std::left << std::setw(28) << r.name << std::right << std::setw(12) << r.iterations
+                  << std::setw(12) << r.median << std::setw(10) << r.stddev << std::setw(8)
+                  << (r.mean > 0 ? 100.0 * r.stddev / r.mean : 0.0) << std::setw(12) << r.p90 << std::setw(12)
+                  << r.p99 << std::setw(12) << std::setprecision(2) << r.medianPerItem() << std::setprecision(1);
+        if (r.has_perf) {
+            std::cout << std::setw(12) << r.cycles << std::setw(8) << std::setprecision(2)
+                      << (r.cycles > 0 ? r.instructions / r.cycles : 0.0) << std::setprecision(1) << std::setw(12)
+                      << r.cache_misses;
+        } else {
+            std::cout << std::setw(12) << "-" << std::setw(8) << "-" << std::setw(12) << "-";
+        }
+        for (const auto& [key, value] : r.counters) {
+            std::cout << "  " << key << "=" << value;
+        }
+        std::cout << std::endl;
+    }
+    std::cout.copyfmt(state);
+}
+
+void Runner::writeJson(const std::vector<Result>& results) const {
+    std::ofstream out(options_.json_path);
+    if (!out) {
+        std::cerr << "无法写入 " << options_.json_path << std::endl;
+        return;
+    }
+    out << std::setprecision(10);
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << currentTime() << "\",\n"
+        << "    \"host\": \"" << jsonEscape(hostName()) << "\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+        << "    \"pinned_cpu\": " << pinned_cpu_ << ",\n"
+        << "    \"perf_counters\": " << (perf_ ? "true" : "false") << ",\n"
+        << "    \"repetitions\": " << options_.repetitions << ",\n"
+        << "    \"min_time\": " << options_.min_time << "\n"
+        << "  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << (i ? "," : "") << "\n    {\n"
+            << "      \"name\": \"" << jsonEscape(r.name) << "\",\n"
+            << "      \"iterations\": " << r.iterations << ",\n"
+            << "      \"items_per_iteration\": " << r.items_per_iteration << ",\n"
+            << "      \"time_unit\": \"ns\",\n"
+            << "      \"mean\": " << r.mean << ",\n"
+            << "      \"median\": " << r.median << ",\n"
+            << "      \"stddev\": " << r.stddev << ",\n"
+            << "      \"min\": " << r.min << ",\n"
+            << "      \"max\": " << r.max << ",\n"
+            << "      \"p90\": " << r.p90 << ",\n"
+            << "      \"p99\": " << r.p99 << ",\n";
+        if (r.has_perf) {
+            out << "      \"cycles\": " << r.cycles << ",\n"
+                << "      \"instructions\": " << r.instructions << ",\n"
+                << "      \"cache_misses\": " << r.cache_misses << ",\n";
+        }
+        out << "      \"counters\": {";
+        size_t k = 0;
+        for (const auto& [key, value] : r.counters) {
+            out << (k++ ? ", " : "") << "\"" << jsonEscape(key) << "\": " << value;
+        }
+        out << "},\n      \"samples\": [";
+        for (size_t s = 0; s < r.samples.size(); ++s) {
+            out << (s ? ", " : "") << r.samples[s];
+        }
+        out << "]\n    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void Runner::writeCsv(const std::vector<Result>& results) const {
+    std::ofstream out(options_.csv_path);
+    if (!out) {
+        std::cerr << "无法写入 " << options_.csv_path << std::endl;
+        return;
+    }
+    out << std::setprecision(10);
+    out << "name,iterations,items_per_iteration,mean_ns,median_ns,stddev_ns,min_ns,max_ns,p90_ns,p99_ns,"
+           "cycles,instructions,cache_misses\n";
+    for (const Result& r : results) {
+        out << csvEscape(r.name) << "," << r.iterations << "," << r.items_per_iteration << "," << r.mean << ","
+            << r.median << "," << r.stddev << "," << r.min << "," << r.max << "," << r.p90 << "," << r.p99 << ",";
+        if (r.has_perf) {
+            out << r.cycles << "," << r.instructions << "," << r.cache_misses;
+        } else {
+            out << ",,";
+        }
+        out << "\n";
+    }
+}
+
+}  // namespace bench
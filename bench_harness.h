@@ -0,0 +1,186 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_BENCH_HARNESS_H
+#define HANDS_ON_CPP_BENCH_HARNESS_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ==================== 微基准框架 ====================
+// 用法和 Google Benchmark 类似：
+//   bench::Runner runner(bench::parseOptions(argc, argv));
+//   runner.add("名字", [](bench::State& state) {
+//       for (auto _ : state) { bench::doNotOptimize(被测代码()); }
+//   });
+//   runner.run();
+// 每个用例先自动标定迭代次数（单次重复至少 min_time 秒），预热一次，再重复 repetitions 次，
+// 报告每次迭代耗时的均值、中位数、标准差和分位数（样本是每次重复的平均值）。
+// Linux 上会绑定到一个 CPU，并用 perf_event_open 读取 cycles/instructions/cache-misses，
+// 内核不允许（容器、perf_event_paranoid）时这几列显示为空。
+// 结果可以另外写成 JSON/CSV，方便不同提交之间对比。
+
+namespace bench {
+
+// 阻止编译器把 value 的计算当成死代码删掉
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+    (void)*sink;
+#endif
+}
+
+template <typename T>
+inline void doNotOptimize(T& value) {
+#if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+#elif defined(__GNUC__)
+    asm volatile("" : "+m,r"(value) : : "memory");
+#else
+    const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+    (void)*sink;
+#endif
+}
+
+// 强制编译器认为所有内存都可能被读写过：之前的写入必须真正落到内存里
+inline void clobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+struct Options {
+    std::string filter;          // 只运行名字包含这个子串的用例
+    double min_time = 0.1;       // 每次重复至少运行的秒数
+    int repetitions = 15;
+    int cpu = -2;                // 绑定的 CPU；-2 表示当前所在的 CPU，-1 表示不绑定
+    bool perf_counters = true;
+    std::string json_path;       // 非空时把结果写成 JSON
+    std::string csv_path;        // 非空时把结果写成 CSV
+};
+
+// 解析 --bench_filter= --bench_min_time= --bench_repetitions= --bench_cpu= --bench_perf=0/1
+// --bench_json= --bench_csv=，不认识的参数原样忽略
+Options parseOptions(int argc, char* argv[]);
+
+class PerfCounters;
+
+// 传给用例函数，用 for (auto _ : state) 驱动计时循环
+class State {
+public:
+    struct Value {};
+
+    class Iterator {
+    public:
+        Iterator(State* state, uint64_t remaining) : state_(state), remaining_(remaining) {}
+
+        bool operator!=(const Iterator&) {
+            if (remaining_ != 0) {
+                return true;
+            }
+            state_->stopTiming();
+            return false;
+        }
+
+        void operator++() { --remaining_; }
+        Value operator*() const { return {}; }
+
+    private:
+        State* state_;
+        uint64_t remaining_;
+    };
+
+    Iterator begin() {
+        startTiming();
+        return {this, iterations_};
+    }
+
+    Iterator end() { return {this, 0}; }
+
+    uint64_t iterations() const { return iterations_; }
+
+    // 每次迭代处理的元素数，设置后额外报告每个元素的耗时
+    void setItemsPerIteration(uint64_t items) { items_per_iteration_ = items; }
+
+    // 自定义指标（例如峰值 RSS），取最后一次重复的值
+    void setCounter(const std::string& name, double value) { counters_[name] = value; }
+
+private:
+    friend class Runner;
+
+    State(uint64_t iterations, PerfCounters* perf) : iterations_(iterations), perf_(perf) {}
+
+    void startTiming();
+    void stopTiming();
+
+    uint64_t iterations_;
+    PerfCounters* perf_;
+    uint64_t items_per_iteration_ = 0;
+    std::map<std::string, double> counters_;
+    int64_t start_ns_ = 0;
+    int64_t elapsed_ns_ = 0;
+    bool perf_valid_ = false;
+    uint64_t perf_values_[3] = {};
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;       // 每次重复的迭代次数
+    uint64_t items_per_iteration = 0;
+    std::vector<double> samples;   // 每次重复的 ns/迭代
+    double mean = 0;
+    double median = 0;
+    double stddev = 0;
+    double min = 0;
+    double max = 0;
+    double p90 = 0;
+    double p99 = 0;
+    bool has_perf = false;         // 以下是每次迭代的平均硬件计数
+    double cycles = 0;
+    double instructions = 0;
+    double cache_misses = 0;
+    std::map<std::string, double> counters;
+
+    // 每个元素的中位耗时；没有设置元素数时等于每次迭代
+    double medianPerItem() const { return items_per_iteration ? median / items_per_iteration : median; }
+};
+
+class Runner {
+public:
+    using Function = std::function<void(State&)>;
+
+    explicit Runner(Options options = {});
+    ~Runner();
+
+    Runner(const Runner&) = delete;
+    Runner& operator=(const Runner&) = delete;
+
+    void add(std::string name, Function fn);
+
+    // 依次运行所有匹配的用例，打印表格，按选项写出 JSON/CSV
+    std::vector<Result> run();
+
+private:
+    Result runCase(const std::string& name, const Function& fn);
+    State runOnce(const Function& fn, uint64_t iterations);
+    void printTable(const std::vector<Result>& results) const;
+    void writeJson(const std::vector<Result>& results) const;
+    void writeCsv(const std::vector<Result>& results) const;
+
+    Options options_;
+    std::vector<std::pair<std::string, Function>> cases_;
+    std::unique_ptr<PerfCounters> perf_;
+    int pinned_cpu_ = -1;
+};
+
+}  // namespace bench
+
+#endif //HANDS_ON_CPP_BENCH_HARNESS_H
@@ -0,0 +1,137 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 多线程缓存基准：原来的单 map + weak_ptr 设计（加一把全局锁才能多线程使用）
+// 对比分片 + 强引用 LRU 的 ConcurrentCache。
+// 每个线程按热点分布随机访问 key，拿到条目后立刻释放，模拟突发流量。
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "concurrent_cache.h"
+
+struct BenchEntry {
+    BenchEntry(int id) : id(id), data("数据" + std::to_string(id)) {}
+
+    int id;
+    std::string data;
+};
+
+// ptr_ref_test.cpp 中 Cache 的同构版本，去掉了打印，用一把锁保护
+class SingleMapCache {
+public:
+    std::shared_ptr<BenchEntry> get(int id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = cache_.find(id);
+        if (it != cache_.end()) {
+            if (auto entry = it->second.lock()) {
+                ++hits_;
+                return entry;
+            }
+            cache_.erase(it);
+        }
+        ++misses_;
+        auto entry = std::make_shared<BenchEntry>(id);
+        cache_[id] = entry;
+        return entry;
+    }
+
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<int, std::weak_ptr<BenchEntry>> cache_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+// 80% 的访问落在 10% 的 key 上
+class HotKeyGenerator {
+public:
+    HotKeyGenerator(int key_space, uint64_t seed) : rng_(seed), key_space_(key_space) {}
+
+    int next() {
+        const int hot = std::max(1, key_space_ / 10);
+        if (rng_() % 100 < 80) {
+            return static_cast<int>(rng_() % hot);
+        }
+        return static_cast<int>(rng_() % key_space_);
+    }
+
+private:
+    std::mt19937_64 rng_;
+    int key_space_;
+};
+
+template <typename GetFn>
+double runThreads(unsigned threads, int ops_per_thread, int key_space, GetFn get) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            HotKeyGenerator keys(key_space, 12345 + t);
+            size_t checksum = 0;
+            for (int i = 0; i < ops_per_thread; ++i) {
+                auto entry = get(keys.next());
+                checksum += entry->data.size();
+            }  // 条目在这里立刻释放
+            volatile size_t sink = checksum;
+            (void)sink;
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    const int key_space = 100000;
+    const int ops_per_thread = 500000;
+    const size_t capacity_bytes = 8 * 1024 * 1024;
+    // 可以通过第一个参数指定最大线程数，默认每个核心一个
+    const unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::stoul(argv[1]))
+                                          : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "key 数量: " << key_space << "，每线程操作数: " << ops_per_thread
+              << "，强引用层容量: " << capacity_bytes / 1024 << " KB" << std::endl;
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        const double total_ops = static_cast<double>(threads) * ops_per_thread;
+
+        SingleMapCache single;
+        double single_seconds = runThreads(threads, ops_per_thread, key_space,
+                                           [&](int id) { return single.get(id); });
+        double single_hit_rate = static_cast<double>(single.hits()) / (single.hits() + single.misses());
+
+        ConcurrentCache<int, BenchEntry> sharded(capacity_bytes, 64, [](const BenchEntry& entry) {
+            return sizeof(BenchEntry) + entry.data.capacity();
+        });
+        double sharded_seconds = runThreads(threads, ops_per_thread, key_space, [&](int id) {
+            return sharded.get(id, [](int key) { return std::make_shared<BenchEntry>(key); });
+        });
+        CacheStats stats = sharded.stats();
+        double sharded_hit_rate = static_cast<double>(stats.hits + stats.weak_hits + stats.coalesced) /
+                                  (stats.hits + stats.weak_hits + stats.coalesced + stats.misses);
+
+        std::cout << "线程数 " << threads << ":" << std::endl;
+        std::cout << "  单 map:   " << total_ops / single_seconds / 1e6 << " M ops/s, 命中率 "
+                  << single_hit_rate * 100 << "%" << std::endl;
+        std::cout << "  分片缓存: " << total_ops / sharded_seconds / 1e6 << " M ops/s, 命中率 "
+                  << sharded_hit_rate * 100 << "%, 淘汰 " << stats.evictions
+                  << ", 合并的未命中 " << stats.coalesced << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_CACHE_LINE_H
+#define HANDS_ON_CPP_CACHE_LINE_H
+
+#include <cstddef>
+
+// 频繁被不同线程写的字段按这个大小对齐，避免伪共享
+inline constexpr size_t kCacheLineSize = 64;
+
+#endif //HANDS_ON_CPP_CACHE_LINE_H
@@ -0,0 +1,118 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 弱引用缓存的过期条目回收：大 map 持续换血时 get 的最坏延迟。
+// 先放入 N 个条目（默认 1000 万）并全部持有，之后每次操作释放最早持有的一个（它随之过期），
+// 再 get 一个 key：一半是新 key，一半是最近仍被持有的 key。map 始终保持在 N 个条目左右。
+// 对比三种回收方式：
+// - 每 100 万次操作调用一次 cleanup()，整 map 遍历（原来 Cache::cleanup 的做法），停顿算在触发它的那次操作上
+// - 每次 get 顺手回收：删除器钩子登记的 key + 游标清扫几个桶
+// - 后台清扫线程：get 不做额外工作，每 1 ms 醒来工作最多 200 us
+// 报告 get 延迟的分位数和最大值，以及结束时 map 里的条目数。
+// 用法：cache_reclaim_bench [条目数] [操作数]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "metrics.h"
+#include "weak_cache.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Item {
+    explicit Item(uint64_t id) : id(id), payload(id * 31) {}
+
+    uint64_t id;
+    uint64_t payload;
+};
+
+using ItemCache = WeakCache<uint64_t, Item>;
+
+// xorshift64，比 std::mt19937 便宜，不影响计时
+struct Rng {
+    uint64_t state = 88172645463325252ull;
+
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+enum class Mode { FullCleanup, Incremental, Background };
+
+void run(const char* name, Mode mode, size_t entries, size_t operations) {
+    WeakCacheOptions options;
+    options.reserve = entries * 2;  // 预留足够的桶，不把 rehash 的停顿算进来
+    if (mode != Mode::Incremental) {
+        options.reclaim_per_get = 0;
+        options.sweep_buckets_per_get = 0;
+    }
+    if (mode == Mode::FullCleanup) {
+        options.max_pending = 0;
+    }
+    ItemCache cache(options);
+    auto factory = [](uint64_t key) { return std::make_unique<Item>(key); };
+
+    std::vector<std::shared_ptr<Item>> held(entries);  // 环形缓冲，held[i % entries] 是最早持有的
+    uint64_t next_key = 0;
+    for (; next_key < entries; ++next_key) {
+        held[next_key] = cache.get(next_key, factory);
+    }
+    if (mode == Mode::Background) {
+        cache.startSweeper(std::chrono::milliseconds(1), std::chrono::microseconds(200));
+    }
+
+    Histogram latency;
+    uint64_t worst_ns = 0;
+    Rng rng;
+    const auto start = Clock::now();
+    for (size_t op = 0; op < operations; ++op) {
+        const size_t slot = (next_key + op) % entries;
+        held[slot].reset();
+
+        const uint64_t r = rng.next();
+        const uint64_t key = (r & 1) ? next_key++ : next_key - 1 - (r >> 1) % (entries / 2);
+
+        const auto t0 = Clock::now();
+        held[slot] = cache.get(key, factory);
+        if (mode == Mode::FullCleanup && op % 1'000'000 == 999'999) {
+            cache.cleanup();
+        }
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0);
+        const uint64_t ns = static_cast<uint64_t>(elapsed.count());
+        latency.record(ns);
+        worst_ns = std::max(worst_ns, ns);
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    cache.stopSweeper();
+
+    const HistogramSnapshot s = latency.snapshot();
+    const WeakCacheStats stats = cache.stats();
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(operations) / seconds / 1e6 << std::setw(9) << s.percentile(0.5)
+              << std::setw(9) << s.percentile(0.99) << std::setw(10) << s.percentile(0.999) << std::setw(12)
+              << static_cast<double>(worst_ns) / 1000.0 << std::setw(12) << stats.entries << std::endl;
+    std::cout << "    回收: 队列 " << stats.reclaimed << ", 游标清扫 " << stats.swept << ", cleanup " << stats.cleaned
+              << ", 队列满未登记 " << stats.not_queued << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t entries = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+    const size_t operations = argc > 2 ? std::stoull(argv[2]) : 5'000'000;
+    std::cout << entries << " 个条目，" << operations << " 次操作" << std::endl;
+    std::cout << std::left << std::setw(28) << "回收方式" << std::right << std::setw(10) << "Mops/s" << std::setw(9)
+              << "p50 ns" << std::setw(9) << "p99 ns" << std::setw(10) << "p99.9 ns" << std::setw(12) << "最大 us"
+              << std::setw(12) << "最终条目数" << std::endl;
+    run("cleanup() 每 100 万次", Mode::FullCleanup, entries, operations);
+    run("每次 get 增量回收", Mode::Incremental, entries, operations);
+    run("后台清扫线程", Mode::Background, entries, operations);
+    return 0;
+}
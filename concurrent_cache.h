@@ -0,0 +1,236 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_CONCURRENT_CACHE_H
+#define HANDS_ON_CPP_CONCURRENT_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ==================== 分片并发缓存 ====================
+// 在 Cache 的 weak_ptr 层之上加一层按字节计量的强引用 LRU：
+// - 强引用层保证最近用过的条目即使调用方都已释放也不会马上过期
+// - 被 LRU 淘汰的条目退回弱引用层，只要还有调用方持有就仍然能命中
+// - 同一个 key 的并发未命中只会调用一次 loader，其他线程等待同一个结果
+// 每个分片有自己的锁，key 按哈希分散到各分片，降低锁竞争。
+
+struct CacheStats {
+    uint64_t hits = 0;         // 强引用层命中
+    uint64_t weak_hits = 0;    // 弱引用层命中（之后会重新放入强引用层）
+    uint64_t misses = 0;       // 未命中，调用了 loader
+    uint64_t coalesced = 0;    // 未命中但等待了其他线程正在进行的加载
+    uint64_t evictions = 0;    // 从强引用层淘汰的条目数
+    size_t strong_bytes = 0;   // 强引用层当前占用的字节数
+    size_t entries = 0;        // 索引中的条目数（包括已过期但还没清理的）
+};
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ConcurrentCache {
+public:
+    using ValuePtr = std::shared_ptr<Value>;
+    using Sizer = std::function<size_t(const Value&)>;
+
+    // shard_count 会向上取整到 2 的幂；capacity_bytes 平均分给各分片
+    explicit ConcurrentCache(size_t capacity_bytes, size_t shard_count = 16,
+                             Sizer sizer = [](const Value&) { return sizeof(Value); })
+        : sizer_(std::move(sizer)) {
+        size_t shards = 1;
+        while (shards < shard_count) {
+            shards <<= 1;
+        }
+        shard_mask_ = shards - 1;
+        shards_ = std::vector<Shard>(shards);
+        for (Shard& shard : shards_) {
+            shard.capacity_bytes = capacity_bytes / shards;
+        }
+    }
+
+    ConcurrentCache(const ConcurrentCache&) = delete;
+    ConcurrentCache& operator=(const ConcurrentCache&) = delete;
+
+    // 查找 key，未命中时调用 loader(key) 创建；loader 在分片锁之外执行
+    template <typename Loader>
+    ValuePtr get(const Key& key, Loader&& loader) {
+        Shard& shard = shardFor(key);
+        std::unique_lock<std::mutex> lock(shard.mutex);
+
+        auto it = shard.map.find(key);
+        if (it != shard.map.end()) {
+            Slot& slot = it->second;
+            if (slot.in_lru) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, slot.lru_pos);
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                return slot.lru_pos->value;
+            }
+            if (ValuePtr value = slot.weak.lock()) {
+                shard.weak_hits.fetch_add(1, std::memory_order_relaxed);
+                promote(shard, it->first, slot, value);
+                return value;
+            }
+            if (slot.loading.valid()) {
+                std::shared_future<ValuePtr> pending = slot.loading;
+                shard.coalesced.fetch_add(1, std::memory_order_relaxed);
+                lock.unlock();
+                return pending.get();  // loader 抛出的异常也会在这里重新抛出
+            }
+        }
+
+        // 未命中：先登记"正在加载"，再放锁去构造
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        std::promise<ValuePtr> promise;
+        Slot& slot = shard.map[key];
+        slot.loading = promise.get_future().share();
+        lock.unlock();
+
+        ValuePtr value;
+        try {
+            value = loader(key);
+        } catch (...) {
+            lock.lock();
+            auto failed = shard.map.find(key);
+            if (failed != shard.map.end()) {
+                failed->second.loading = {};
+                if (!failed->second.in_lru && failed->second.weak.expired()) {
+                    shard.map.erase(failed);
+                }
+            }
+            lock.unlock();
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+
+        lock.lock();
+        auto loaded = shard.map.find(key);  // 加载期间其他线程可能已经 rehash
+        loaded->second.loading = {};
+        loaded->second.weak = value;
+        promote(shard, loaded->first, loaded->second, value);
+        lock.unlock();
+
+        promise.set_value(value);
+        return value;
+    }
+
+    // 只查不建，未命中返回 nullptr
+    ValuePtr find(const Key& key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) {
+            return nullptr;
+        }
+        if (it->second.in_lru) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru_pos);
+            shard.hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second.lru_pos->value;
+        }
+        if (ValuePtr value = it->second.weak.lock()) {
+            shard.weak_hits.fetch_add(1, std::memory_order_relaxed);
+            promote(shard, it->first, it->second, value);
+            return value;
+        }
+        return nullptr;
+    }
+
+    // 移除弱引用层里已经过期的条目，返回移除的数量
+    size_t cleanup() {
+        size_t removed = 0;
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.map.begin(); it != shard.map.end();) {
+                const Slot& slot = it->second;
+                if (!slot.in_lru && !slot.loading.valid() && slot.weak.expired()) {
+                    it = shard.map.erase(it);
+                    ++removed;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        return removed;
+    }
+
+    // 计数器是原子变量，读取时不需要加锁；条目数和字节数需要短暂持有各分片的锁
+    CacheStats stats() const {
+        CacheStats total;
+        for (const Shard& shard : shards_) {
+            total.hits += shard.hits.load(std::memory_order_relaxed);
+            total.weak_hits += shard.weak_hits.load(std::memory_order_relaxed);
+            total.misses += shard.misses.load(std::memory_order_relaxed);
+            total.coalesced += shard.coalesced.load(std::memory_order_relaxed);
+            total.evictions += shard.evictions.load(std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total.strong_bytes += shard.strong_bytes;
+            total.entries += shard.map.size();
+        }
+        return total;
+    }
+
+    size_t shardCount() const { return shards_.size(); }
+
+private:
+    struct LruNode {
+        const Key* key;  // 指向 map 中的 key，unordered_map 的节点地址在 rehash 后不变
+        ValuePtr value;
+        size_t bytes;
+    };
+
+    struct Slot {
+        std::weak_ptr<Value> weak;
+        std::shared_future<ValuePtr> loading;
+        typename std::list<LruNode>::iterator lru_pos;
+        bool in_lru = false;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Slot, Hash> map;
+        std::list<LruNode> lru;  // 头部是最近使用的
+        size_t strong_bytes = 0;
+        size_t capacity_bytes = 0;
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> weak_hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> coalesced{0};
+        std::atomic<uint64_t> evictions{0};
+    };
+
+    Shard& shardFor(const Key& key) {
+        // 再混一次哈希，避免 std::hash<int> 这种恒等哈希让低位集中
+        uint64_t h = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+        return shards_[(h >> 32) & shard_mask_];
+    }
+
+    // 放进强引用层的头部，必要时从尾部淘汰（调用方持有分片锁）
+    void promote(Shard& shard, const Key& key, Slot& slot, const ValuePtr& value) {
+        const size_t bytes = sizer_(*value);
+        shard.lru.push_front({&key, value, bytes});
+        slot.lru_pos = shard.lru.begin();
+        slot.in_lru = true;
+        shard.strong_bytes += bytes;
+
+        // 至少保留刚放进去的这一项，即使它本身就超过了分片容量
+        while (shard.strong_bytes > shard.capacity_bytes && shard.lru.size() > 1) {
+            LruNode& victim = shard.lru.back();
+            shard.map.find(*victim.key)->second.in_lru = false;  // 退回弱引用层
+            shard.strong_bytes -= victim.bytes;
+            shard.lru.pop_back();
+            shard.evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Sizer sizer_;
+    size_t shard_mask_ = 0;
+    std::vector<Shard> shards_;
+};
+
+#endif //HANDS_ON_CPP_CONCURRENT_CACHE_H
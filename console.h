@@ -0,0 +1,26 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_CONSOLE_H
+#define HANDS_ON_CPP_CONSOLE_H
+
+// ==================== 控制台初始化 ====================
+// 源码和输出都是 UTF-8（编译选项里指定了执行字符集）。
+// Windows 控制台默认用本地代码页，需要切到 UTF-8 才能正确显示中文；
+// Linux/macOS 的终端本来就是 UTF-8，什么都不用做。
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX  // 避免 windows.h 的 min/max 宏和 std::min/std::max 冲突
+#endif
+#include <windows.h>
+#endif
+
+inline void setupConsole() {
+#ifdef _WIN32
+    SetConsoleOutputCP(CP_UTF8);  // 设置控制台输出为UTF-8
+#endif
+}
+
+#endif //HANDS_ON_CPP_CONSOLE_H
@@ -5,7 +5,10 @@
 #include <memory>
 #include <vector>
 #include <string>
-#include <windows.h>
+
+#include "alloc_tracker.h"
+#include "console.h"
+#include "slot_map.h"
 
 // ==================== 1. 悬空指针的"幸运"情况 ====================
 
@@ -121,6 +124,7 @@ void heapVsStackComparison() {
 
     int* stack_ptr;
     int* heap_ptr;
+    const int64_t live_before = alloc_tracker::totals().liveObjects();
 
     // 栈内存情况
     {
@@ -140,8 +144,11 @@ void heapVsStackComparison() {
     std::cout << "作用域结束后:" << std::endl;
     std::cout << "栈指针访问: " << *stack_ptr << std::endl;  // 未定义行为
     std::cout << "堆指针访问: " << *heap_ptr << std::endl;  // 仍然有效，但造成内存泄漏
+    std::cout << "分配追踪: 还没释放的堆对象 " << alloc_tracker::totals().liveObjects() - live_before
+              << " 个" << std::endl;
 
     delete heap_ptr;  // 清理堆内存
+    std::cout << "delete 之后: " << alloc_tracker::totals().liveObjects() - live_before << " 个" << std::endl;
     // std::cout << *heap_ptr << std::endl;  // 现在这也是未定义行为了
 }
 
@@ -232,8 +239,56 @@ void realWorldDebuggingCase() {
     ptr->print();  // 非常危险的操作！
 }
 
+// ==================== 9. 用句柄代替裸指针 ====================
+// 其他对象只保存 SlotHandle，每次用的时候到表里查；对象删除后旧句柄查出来是空指针，而不是悬空地址
+
+void handleTableCase() {
+    std::cout << "\n=== 用句柄代替裸指针 ===" << std::endl;
+
+    // 和上面的实际调试案例是同一个对象，只是别人手里拿的是句柄
+    SlotMap<DebugExample> objects;
+    SlotHandle handle = objects.emplace(42);
+    objects.get(handle)->print();
+
+    objects.erase(handle);  // DebugExample 在这里析构
+    std::cout << "对象已析构，再通过句柄访问..." << std::endl;
+    if (DebugExample* ptr = objects.get(handle)) {
+        ptr->print();
+    } else {
+        std::cout << "空指针，检测到对象已删除" << std::endl;
+    }
+
+    SlotHandle reused = objects.emplace(7);  // 复用了同一个槽位，代数不同
+    std::cout << "删除后再插入，新句柄 {" << reused.index << ", " << reused.generation << "} -> "
+              << objects.get(reused)->getValue() << std::endl;
+    std::cout << "旧句柄 {" << handle.index << ", " << handle.generation << "} 查找: "
+              << (objects.get(handle) ? "找到了（错误！）" : "空指针") << std::endl;
+
+    // 从外部传进来的句柄（比如存成整数的 ID）不可信，伪造的也只会查出空指针
+    objects.erase(reused);
+    SlotHandle forged = SlotHandle::fromRaw(SlotHandle{reused.index, reused.generation + 1}.raw());
+    std::cout << "伪造句柄 {" << forged.index << ", " << forged.generation << "} 查找: "
+              << (objects.get(forged) ? "找到了（错误！）" : "空指针") << std::endl;
+}
+
+// ==================== 10. 堆上的同一个错误 ====================
+// 普通堆分配器会马上复用刚释放的内存，悬空访问多半“正常”运行，读到旧值或别的对象的数据。
+// 用 ALLOC_TRACKER_GUARD=1 运行时，释放的块被 mprotect 并放进隔离区，
+// 这里的 print() 会立刻触发 SIGSEGV，报告里有这个对象的分配位置和释放位置（进程随即终止，所以放在最后）。
+
+void heapUseAfterFreeCase() {
+    std::cout << "\n=== 堆上的释放后使用 ===" << std::endl;
+
+    DebugExample* ptr = new DebugExample(7);
+    ptr->print();
+    delete ptr;
+
+    std::cout << "对象已 delete，再通过悬空指针访问..." << std::endl;
+    ptr->print();  // 释放后使用！
+}
+
 int main() {
-    SetConsoleOutputCP(CP_UTF8);  // 设置控制台输出为UTF-8
+    setupConsole();
     std::cout << "注意：以下代码包含未定义行为，仅用于教学演示！" << std::endl;
     std::cout << "在实际项目中绝对不要写这样的代码！\n" << std::endl;
 
@@ -245,6 +300,8 @@ int main() {
     toolDetectionDemo();
     safePractices();
     realWorldDebuggingCase();
+    handleTableCase();
+    heapUseAfterFreeCase();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,30 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_DIR_FD_H
+#define HANDS_ON_CPP_DIR_FD_H
+
+#include <unistd.h>
+
+// 目录文件描述符，最后一个引用释放时自动关闭
+class DirFd {
+public:
+    explicit DirFd(int fd) : fd_(fd) {}
+
+    ~DirFd() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    DirFd(const DirFd&) = delete;
+    DirFd& operator=(const DirFd&) = delete;
+
+    int get() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+#endif //HANDS_ON_CPP_DIR_FD_H
@@ -0,0 +1,475 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_FLAT_HASH_MAP_H
+#define HANDS_ON_CPP_FLAT_HASH_MAP_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// ==================== 开放寻址的扁平哈希表 ====================
+// std::unordered_map 每个元素一个堆节点，每次插入分配一次，每次查找至少多跟一次指针。
+// FlatHashMap 把键值对直接放在一个连续数组里，另有一个控制字节数组（SwissTable 的做法）：
+// - 每个槽一个控制字节：0x80 表示空，否则是哈希值的低 7 位（H2）
+// - 查找从 H1 决定的起始槽开始，一次读 16 个控制字节，用 SSE2 一条比较找出 H2 相同的槽，
+//   只对这些候选比较 key；这 16 个里有空槽就说明 key 不存在
+// - 线性探测（按槽，不按组对齐），控制字节数组末尾多放 15 个首部的副本，跨越数组末尾时也能一次读满 16 个
+// - 删除用 backward shift：把后面同一簇里可以前移的元素逐个挪进空位，不留墓碑，
+//   删除多了查找也不会变慢，也不需要定期重建
+// 负载因子上限 7/8，容量是 2 的幂，最小 16。
+// Hash 和 KeyEqual 都定义了 is_transparent 时，find/contains/erase 可以直接用别的类型查找（比如用 string_view 查 string 键）。
+//
+// 和 std::unordered_map 的区别：插入可能 rehash，删除会移动其他元素，两者都会让迭代器和元素引用失效；
+// 边遍历边 erase(iterator) 时，跨越数组末尾挪回来的元素可能被访问两次（不会漏掉）。
+
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<const Key, Value>;
+    using size_type = size_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+        Iterator() = default;
+
+        // 允许 iterator 转成 const_iterator
+        template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other) : map_(other.map_), index_(other.index_) {}
+
+        reference operator*() const { return map_->slots_[index_]; }
+        pointer operator->() const { return &map_->slots_[index_]; }
+
+        Iterator& operator++() {
+            index_ = map_->nextFull(index_ + 1);
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.index_ == b.index_; }
+
+    private:
+        friend class FlatHashMap;
+        template <bool>
+        friend class Iterator;
+
+        using MapPtr = std::conditional_t<Const, const FlatHashMap*, FlatHashMap*>;
+
+        Iterator(MapPtr map, size_t index) : map_(map), index_(index) {}
+
+        MapPtr map_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    // 每个"桶"就是一个槽，最多一个元素；配合 bucket_count() 可以按槽号分段遍历
+    using local_iterator = value_type*;
+    using const_local_iterator = const value_type*;
+
+    FlatHashMap() = default;
+
+    explicit FlatHashMap(size_t expected) { reserve(expected); }
+
+    FlatHashMap(const FlatHashMap& other) : hash_(other.hash_), eq_(other.eq_) {
+        reserve(other.size_);
+        for (const value_type& value : other) {
+            insertUnique(hashOf(value.first), value);
+        }
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept { swap(other); }
+
+    FlatHashMap& operator=(FlatHashMap other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~FlatHashMap() {
+        destroyAll();
+        release();
+    }
+
+    void swap(FlatHashMap& other) noexcept {
+        std::swap(ctrl_, other.ctrl_);
+        std::swap(slots_, other.slots_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(hash_, other.hash_);
+        std::swap(eq_, other.eq_);
+    }
+
+    iterator begin() { return iterator(this, nextFull(0)); }
+    iterator end() { return iterator(this, capacity_); }
+    const_iterator begin() const { return const_iterator(this, nextFull(0)); }
+    const_iterator end() const { return const_iterator(this, capacity_); }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return capacity_; }
+
+    size_t bucket_count() const { return capacity_; }
+    local_iterator begin(size_t bucket) { return slots_ + bucket + (isFull(ctrl_[bucket]) ? 0 : 1); }
+    local_iterator end(size_t bucket) { return slots_ + bucket + 1; }
+    const_local_iterator begin(size_t bucket) const { return slots_ + bucket + (isFull(ctrl_[bucket]) ? 0 : 1); }
+    const_local_iterator end(size_t bucket) const { return slots_ + bucket + 1; }
+
+    // 表占用的字节数（槽数组 + 控制字节），不包括元素自己在堆上的数据
+    size_t allocatedBytes() const { return capacity_ ? capacity_ * sizeof(value_type) + capacity_ + kGroup - 1 : 0; }
+
+    // 保证放入 expected 个元素之前不会 rehash
+    void reserve(size_t expected) {
+        size_t capacity = kGroup;
+        while (capacity - capacity / 8 < expected) {
+            capacity *= 2;
+        }
+        if (capacity > capacity_) {
+            rehash(capacity);
+        }
+    }
+
+    void clear() {
+        destroyAll();
+        if (capacity_) {
+            std::memset(ctrl_, kEmpty, capacity_ + kGroup - 1);
+        }
+        size_ = 0;
+    }
+
+    iterator find(const Key& key) { return iterator(this, findIndex(key, hashOf(key))); }
+    const_iterator find(const Key& key) const { return const_iterator(this, findIndex(key, hashOf(key))); }
+
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = typename H::is_transparent,
+              typename = typename E::is_transparent>
+    iterator find(const K& key) {
+        return iterator(this, findIndex(key, hashOf(key)));
+    }
+
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = typename H::is_transparent,
+              typename = typename E::is_transparent>
+    const_iterator find(const K& key) const {
+        return const_iterator(this, findIndex(key, hashOf(key)));
+    }
+
+    bool contains(const Key& key) const { return findIndex(key, hashOf(key)) != capacity_; }
+
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = typename H::is_transparent,
+              typename = typename E::is_transparent>
+    bool contains(const K& key) const {
+        return findIndex(key, hashOf(key)) != capacity_;
+    }
+
+    size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+    // key 已经存在时什么也不做，不会用 args 构造 Value
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return emplaceImpl(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        return emplaceImpl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    // 只支持 emplace(key, value 的构造参数...) 的形式，语义同 try_emplace
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> emplace(K&& key, Args&&... args) {
+        return emplaceImpl(std::forward<K>(key), std::forward<Args>(args)...);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return emplaceImpl(value.first, value.second); }
+
+    Value& operator[](const Key& key) { return emplaceImpl(key).first->second; }
+
+    size_t erase(const Key& key) { return eraseKey(key); }
+
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = typename H::is_transparent,
+              typename = typename E::is_transparent>
+    size_t erase(const K& key) {
+        return eraseKey(key);
+    }
+
+    // 返回下一个元素：后面的元素挪进了这个槽时就是这个槽本身
+    iterator erase(iterator pos) {
+        const size_t index = pos.index_;
+        eraseAt(index);
+        return iterator(this, nextFull(index));
+    }
+
+private:
+    static constexpr size_t kGroup = 16;
+    static constexpr int8_t kEmpty = static_cast<int8_t>(0x80);
+
+    static bool isFull(int8_t ctrl) { return ctrl >= 0; }
+
+    // 从 ctrl 开始的 16 个控制字节，match 返回等于 h2 的位置掩码，matchEmpty 返回空槽的位置掩码
+    struct Group {
+        explicit Group(const int8_t* ctrl) {
+#if defined(__SSE2__)
+            bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+            std::memcpy(bytes, ctrl, kGroup);
+#endif
+        }
+
+        uint32_t match(int8_t h2) const {
+#if defined(__SSE2__)
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2))));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < kGroup; ++i) {
+                mask |= static_cast<uint32_t>(bytes[i] == h2) << i;
+            }
+            return mask;
+#endif
+        }
+
+        // 只有空槽的最高位是 1
+        uint32_t matchEmpty() const {
+#if defined(__SSE2__)
+            return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+#else
+            uint32_t mask = 0;
+            for (size_t i = 0; i < kGroup; ++i) {
+                mask |= static_cast<uint32_t>(bytes[i] < 0) << i;
+            }
+            return mask;
+#endif
+        }
+
+#if defined(__SSE2__)
+        __m128i bytes;
+#else
+        int8_t bytes[kGroup];
+#endif
+    };
+
+    // std::hash 对整数通常就是恒等映射，低位和高位都要用，先混合一次
+    template <typename K>
+    size_t hashOf(const K& key) const {
+        const uint64_t h = static_cast<uint64_t>(hash_(key));
+#if defined(__SIZEOF_INT128__)
+        const unsigned __int128 r = static_cast<unsigned __int128>(h) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64));
+#else
+        const uint64_t x = (h ^ (h >> 32)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(x ^ (x >> 29));
+#endif
+    }
+
+    static int8_t h2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+    size_t home(size_t hash) const { return (hash >> 7) & (capacity_ - 1); }
+
+    // 末尾的 15 个副本和首部保持一致
+    void setCtrl(size_t index, int8_t value) {
+        ctrl_[index] = value;
+        if (index < kGroup - 1) {
+            ctrl_[capacity_ + index] = value;
+        }
+    }
+
+    size_t nextFull(size_t index) const {
+        while (index < capacity_ && !isFull(ctrl_[index])) {
+            ++index;
+        }
+        return index;
+    }
+
+    // 找不到时返回 capacity_（即 end()）。负载因子不超过 7/8，探测一定会遇到空槽
+    template <typename K>
+    size_t findIndex(const K& key, size_t hash) const {
+        if (capacity_ == 0) {
+            return capacity_;
+        }
+        const size_t mask = capacity_ - 1;
+        const int8_t tag = h2(hash);
+        size_t pos = home(hash);
+        for (;;) {
+            const Group group(ctrl_ + pos);
+            for (uint32_t m = group.match(tag); m; m &= m - 1) {
+                const size_t index = (pos + static_cast<size_t>(std::countr_zero(m))) & mask;
+                if (eq_(slots_[index].first, key)) {
+                    return index;
+                }
+            }
+            if (group.matchEmpty()) {
+                return capacity_;
+            }
+            pos = (pos + kGroup) & mask;
+        }
+    }
+
+    size_t findEmpty(size_t hash) const {
+        const size_t mask = capacity_ - 1;
+        size_t pos = home(hash);
+        for (;;) {
+            if (const uint32_t m = Group(ctrl_ + pos).matchEmpty()) {
+                return (pos + static_cast<size_t>(std::countr_zero(m))) & mask;
+            }
+            pos = (pos + kGroup) & mask;
+        }
+    }
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> emplaceImpl(K&& key, Args&&... args) {
+        const size_t hash = hashOf(key);
+        const size_t found = findIndex(key, hash);
+        if (found != capacity_) {
+            return {iterator(this, found), false};
+        }
+        if (size_ + 1 > capacity_ - capacity_ / 8) {
+            rehash(capacity_ ? capacity_ * 2 : kGroup);
+        }
+        const size_t index = findEmpty(hash);
+        ::new (static_cast<void*>(slots_ + index)) value_type(std::piecewise_construct,
+                                                              std::forward_as_tuple(std::forward<K>(key)),
+                                                              std::forward_as_tuple(std::forward<Args>(args)...));
+        setCtrl(index, h2(hash));
+        ++size_;
+        return {iterator(this, index), true};
+    }
+
+    template <typename V>
+    void insertUnique(size_t hash, V&& value) {
+        const size_t index = findEmpty(hash);
+        ::new (static_cast<void*>(slots_ + index)) value_type(std::forward<V>(value));
+        setCtrl(index, h2(hash));
+        ++size_;
+    }
+
+    // 把元素从 from 搬到 to（to 是未构造的槽）。from 马上析构，所以把它的 const key 当作右值移走
+    void relocate(value_type* from, value_type* to) {
+        ::new (static_cast<void*>(to))
+            value_type(std::move(const_cast<Key&>(from->first)), std::move(from->second));
+        from->~value_type();
+    }
+
+    template <typename K>
+    size_t eraseKey(const K& key) {
+        const size_t index = findIndex(key, hashOf(key));
+        if (index == capacity_) {
+            return 0;
+        }
+        eraseAt(index);
+        return 1;
+    }
+
+    // backward shift：空位之后同一簇里的元素，起始槽不在 (hole, j] 之间的可以挪进空位，挪走后它原来的位置成为新的空位
+    void eraseAt(size_t index) {
+        const size_t mask = capacity_ - 1;
+        slots_[index].~value_type();
+        setCtrl(index, kEmpty);
+        --size_;
+
+        size_t hole = index;
+        for (size_t j = (index + 1) & mask; isFull(ctrl_[j]); j = (j + 1) & mask) {
+            const size_t start = home(hashOf(slots_[j].first));
+            if (((j - start) & mask) >= ((j - hole) & mask)) {
+                relocate(slots_ + j, slots_ + hole);
+                setCtrl(hole, ctrl_[j]);
+                setCtrl(j, kEmpty);
+                hole = j;
+            }
+        }
+    }
+
+    void rehash(size_t capacity) {
+        int8_t* old_ctrl = ctrl_;
+        value_type* old_slots = slots_;
+        const size_t old_capacity = capacity_;
+
+        slots_ = allocateSlots(capacity);
+        ctrl_ = new int8_t[capacity + kGroup - 1];
+        std::memset(ctrl_, kEmpty, capacity + kGroup - 1);
+        capacity_ = capacity;
+
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (isFull(old_ctrl[i])) {
+                const size_t hash = hashOf(old_slots[i].first);
+                const size_t index = findEmpty(hash);
+                relocate(old_slots + i, slots_ + index);
+                setCtrl(index, h2(hash));
+            }
+        }
+        if (old_capacity) {
+            deallocateSlots(old_slots);
+            delete[] old_ctrl;
+        }
+    }
+
+    void destroyAll() {
+        if constexpr (!std::is_trivially_destructible_v<value_type>) {
+            for (size_t i = 0; i < capacity_; ++i) {
+                if (isFull(ctrl_[i])) {
+                    slots_[i].~value_type();
+                }
+            }
+        }
+    }
+
+    void release() {
+        if (capacity_) {
+            deallocateSlots(slots_);
+            delete[] ctrl_;
+        }
+    }
+
+    // 和 std::allocator 一样，只有超过默认对齐的类型才用带 align_val_t 的版本
+    static constexpr bool kOverAligned = alignof(value_type) > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    static value_type* allocateSlots(size_t capacity) {
+        if constexpr (kOverAligned) {
+            return static_cast<value_type*>(
+                ::operator new(capacity * sizeof(value_type), std::align_val_t{alignof(value_type)}));
+        } else {
+            return static_cast<value_type*>(::operator new(capacity * sizeof(value_type)));
+        }
+    }
+
+    static void deallocateSlots(value_type* slots) {
+        if constexpr (kOverAligned) {
+            ::operator delete(slots, std::align_val_t{alignof(value_type)});
+        } else {
+            ::operator delete(slots);
+        }
+    }
+
+    int8_t* ctrl_ = nullptr;
+    value_type* slots_ = nullptr;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    [[no_unique_address]] Hash hash_;
+    [[no_unique_address]] KeyEqual eq_;
+};
+
+#endif //HANDS_ON_CPP_FLAT_HASH_MAP_H
@@ -0,0 +1,134 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// FlatHashMap vs std::unordered_map：uint64_t -> uint64_t，键是打散的随机数。
+// 每个规模分别测：逐个插入（不预留）、查找命中、查找未命中、逐个删除，报告每次操作的纳秒数，
+// 以及插入完成后每个元素占用的字节数（unordered_map 用计数分配器统计，不含 malloc 自己每块的额外开销）。
+// 小规模重复多轮，让每项总操作数不少于 400 万次。
+// 用法：flat_map_bench [最大规模]，默认 1000 万；1 亿需要约 6 GB 内存（unordered_map 那一份最大）
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_harness.h"
+#include "flat_hash_map.h"
+
+using Clock = std::chrono::steady_clock;
+
+inline size_t g_allocated_bytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        g_allocated_bytes += n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        g_allocated_bytes -= n * sizeof(T);
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const { return true; }
+};
+
+using StdMap = std::unordered_map<uint64_t, uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                  CountingAllocator<std::pair<const uint64_t, uint64_t>>>;
+using FlatMap = FlatHashMap<uint64_t, uint64_t>;
+
+uint64_t splitmix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+struct Timings {
+    double insert = 0, hit = 0, miss = 0, erase = 0;  // 累计纳秒
+    double bytes_per_entry = 0;
+};
+
+template <typename Map>
+size_t allocatedBytes(const Map& map) {
+    if constexpr (requires { map.allocatedBytes(); }) {
+        return map.allocatedBytes();
+    } else {
+        return g_allocated_bytes;
+    }
+}
+
+template <typename Map>
+void runOnce(const std::vector<uint64_t>& keys, const std::vector<uint64_t>& missing, Timings& t) {
+    auto elapsed = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+    Map map;
+    auto start = Clock::now();
+    for (uint64_t key : keys) {
+        map.emplace(key, key);
+    }
+    t.insert += elapsed(start);
+    t.bytes_per_entry = static_cast<double>(allocatedBytes(map)) / static_cast<double>(keys.size());
+
+    uint64_t found = 0;
+    start = Clock::now();
+    for (uint64_t key : keys) {
+        found += map.find(key)->second;
+    }
+    t.hit += elapsed(start);
+
+    start = Clock::now();
+    for (uint64_t key : missing) {
+        found += map.find(key) != map.end();
+    }
+    t.miss += elapsed(start);
+    bench::doNotOptimize(found);
+
+    start = Clock::now();
+    for (uint64_t key : keys) {
+        map.erase(key);
+    }
+    t.erase += elapsed(start);
+}
+
+void printRow(const char* name, size_t n, size_t rounds, const Timings& t) {
+    const double ops = static_cast<double>(n * rounds);
+    std::cout << "  " << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << t.insert / ops << std::setw(10) << t.hit / ops << std::setw(10) << t.miss / ops
+              << std::setw(10) << t.erase / ops << std::setw(12) << t.bytes_per_entry << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t max_n = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+    for (size_t n = 1000; n <= max_n; n *= 10) {
+        std::vector<uint64_t> keys(n), missing(n);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = splitmix(i);
+            missing[i] = splitmix(i + n);
+        }
+        const size_t rounds = std::max<size_t>(1, 4'000'000 / n);
+
+        Timings std_map, flat_map;
+        for (size_t r = 0; r < rounds; ++r) {
+            runOnce<StdMap>(keys, missing, std_map);
+            runOnce<FlatMap>(keys, missing, flat_map);
+        }
+        std::cout << n << " 个键（" << rounds << " 轮）    插入ns  命中ns  未命中ns  删除ns  字节/元素" << std::endl;
+        printRow("unordered_map", n, rounds, std_map);
+        printRow("FlatHashMap", n, rounds, flat_map);
+    }
+    return 0;
+}
@@ -0,0 +1,290 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#include "fs_backend.h"
+
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string>
+#include <system_error>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include "logger.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+[[noreturn]] void throwError(const char* what, const fs::path& path, int error) {
+    throw fs::filesystem_error(what, path, std::error_code(error, std::generic_category()));
+}
+
+// 条带用哈希值的高位选，和表内部用的位错开
+size_t stripeOf(size_t hash, size_t mask) { return (static_cast<uint64_t>(hash) >> 40) & mask; }
+
+// 路径的文本，分隔符统一成 '/'。POSIX 上直接用 native()，不拷贝；Windows 上去掉盘符
+std::string_view pathText(const fs::path& path, std::string& storage) {
+#ifdef _WIN32
+    storage = path.generic_string();
+    return std::string_view(storage).substr(path.root_name().generic_string().size());
+#else
+    (void)storage;
+    return path.native();
+#endif
+}
+
+}  // namespace
+
+// ==================== FileSystemBackend ====================
+
+bool FileSystemBackend::createDirectories(const fs::path& path) {
+    if (path.empty() || exists(path)) {
+        return false;
+    }
+    const fs::path parent = path.parent_path();
+    if (!parent.empty() && parent != path) {
+        createDirectories(parent);
+    }
+    return createDirectory(path);
+}
+
+// ==================== DiskBackend ====================
+
+#ifndef _WIN32
+
+bool DiskBackend::exists(const fs::path& path) {
+    struct stat st {};
+    if (stat(path.c_str(), &st) == 0) {
+        return true;
+    }
+    if (errno == ENOENT || errno == ENOTDIR) {
+        return false;
+    }
+    throwError("exists", path, errno);
+}
+
+bool DiskBackend::createDirectory(const fs::path& path) {
+    if (mkdir(path.c_str(), 0755) == 0) {
+        return true;
+    }
+    const int error = errno;
+    struct stat st {};
+    if (error == EEXIST && stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        return false;
+    }
+    throwError("create_directory", path, error);
+}
+
+#else
+
+bool DiskBackend::exists(const fs::path& path) { return fs::exists(path); }
+
+bool DiskBackend::createDirectory(const fs::path& path) { return fs::create_directory(path); }
+
+#endif
+
+// ==================== MemoryBackend ====================
+
+size_t MemoryBackend::EntryKeyHash::operator()(const EntryKey& key) const {
+    uint64_t h = reinterpret_cast<uintptr_t>(key.parent) * 0x9E3779B97F4A7C15ull;
+    h ^= reinterpret_cast<uintptr_t>(key.name) + (h >> 31);
+    h *= 0xBF58476D1CE4E5B9ull;
+    return static_cast<size_t>(h ^ (h >> 29));
+}
+
+MemoryBackend::MemoryBackend(size_t stripes)
+    : stripe_mask_(std::bit_ceil(std::max<size_t>(stripes, 1)) - 1),
+      entry_stripes_(new EntryStripe[stripe_mask_ + 1]),
+      name_stripes_(new NameStripe[stripe_mask_ + 1]) {}
+
+const char* MemoryBackend::findName(std::string_view name) const {
+    const NameStripe& stripe = name_stripes_[stripeOf(NameHash{}(name), stripe_mask_)];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto it = stripe.names.find(name);
+    return it == stripe.names.end() ? nullptr : it->second;
+}
+
+const char* MemoryBackend::internName(std::string_view name) {
+    NameStripe& stripe = name_stripes_[stripeOf(NameHash{}(name), stripe_mask_)];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto it = stripe.names.find(name);
+    if (it != stripe.names.end()) {
+        return it->second;
+    }
+    auto* copy = static_cast<char*>(stripe.arena.allocate(name.size() + 1, 1));
+    std::memcpy(copy, name.data(), name.size());
+    copy[name.size()] = '\0';
+    stripe.names.emplace(std::string_view(copy, name.size()), copy);
+    return copy;
+}
+
+const MemoryBackend::Inode* MemoryBackend::lookup(const Inode* parent, const char* name) const {
+    const EntryKey key{parent, name};
+    const EntryStripe& stripe = entry_stripes_[stripeOf(EntryKeyHash{}(key), stripe_mask_)];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto it = stripe.entries.find(key);
+    return it == stripe.entries.end() ? nullptr : it->second;
+}
+
+const MemoryBackend::Inode* MemoryBackend::resolve(std::string_view path) const {
+    const Inode* node = &root_;
+    while (!path.empty()) {
+        const size_t slash = path.find('/');
+        const std::string_view component = path.substr(0, slash);
+        path = slash == std::string_view::npos ? std::string_view() : path.substr(slash + 1);
+        if (component.empty() || component == ".") {
+            continue;
+        }
+        if (component == "..") {
+            node = node->parent ? node->parent : node;
+            continue;
+        }
+        // 只查不插：名字表里没有的名字，哪个目录下都不会有
+        const char* name = findName(component);
+        node = name ? lookup(node, name) : nullptr;
+        if (!node) {
+            return nullptr;
+        }
+    }
+    return node;
+}
+
+bool MemoryBackend::exists(const fs::path& path) {
+    std::string storage;
+    return resolve(pathText(path, storage)) != nullptr;
+}
+
+bool MemoryBackend::createDirectory(const fs::path& path) {
+    std::string storage;
+    std::string_view text = pathText(path, storage);
+    while (!text.empty() && text.back() == '/') {
+        text.remove_suffix(1);
+    }
+    const size_t slash = text.rfind('/');
+    const std::string_view leaf = slash == std::string_view::npos ? text : text.substr(slash + 1);
+    if (leaf.empty() || leaf == "." || leaf == "..") {
+        // 根目录、"a/." 这类指向已有目录的路径
+        if (resolve(text)) {
+            return false;
+        }
+        throwError("create_directory", path, ENOENT);
+    }
+
+    const Inode* parent = resolve(slash == std::string_view::npos ? std::string_view() : text.substr(0, slash));
+    if (!parent) {
+        throwError("create_directory", path, ENOENT);
+    }
+    const EntryKey key{parent, internName(leaf)};
+    EntryStripe& stripe = entry_stripes_[stripeOf(EntryKeyHash{}(key), stripe_mask_)];
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto [it, inserted] = stripe.entries.try_emplace(key, nullptr);
+    if (inserted) {
+        it->second = ::new (stripe.arena.allocate(sizeof(Inode), alignof(Inode))) Inode{key.parent, key.name};
+    }
+    return inserted;
+}
+
+void MemoryBackend::clear() {
+    // Inode 可平凡析构，arena reset 就够了
+    for (size_t i = 0; i <= stripe_mask_; ++i) {
+        entry_stripes_[i].entries.clear();
+        entry_stripes_[i].arena.reset();
+        name_stripes_[i].names.clear();
+        name_stripes_[i].arena.reset();
+    }
+}
+
+size_t MemoryBackend::directories() const {
+    size_t total = 0;
+    for (size_t i = 0; i <= stripe_mask_; ++i) {
+        std::lock_guard<std::mutex> lock(entry_stripes_[i].mutex);
+        total += entry_stripes_[i].entries.size();
+    }
+    return total;
+}
+
+size_t MemoryBackend::uniqueNames() const {
+    size_t total = 0;
+    for (size_t i = 0; i <= stripe_mask_; ++i) {
+        std::lock_guard<std::mutex> lock(name_stripes_[i].mutex);
+        total += name_stripes_[i].names.size();
+    }
+    return total;
+}
+
+size_t MemoryBackend::memoryBytes() const {
+    size_t total = (stripe_mask_ + 1) * (sizeof(EntryStripe) + sizeof(NameStripe));
+    for (size_t i = 0; i <= stripe_mask_; ++i) {
+        const EntryStripe& entries = entry_stripes_[i];
+        const NameStripe& names = name_stripes_[i];
+        std::scoped_lock lock(entries.mutex, names.mutex);
+        // 每个槽一个控制字节加一个键值对
+        total += entries.entries.capacity() * (1 + sizeof(std::pair<EntryKey, Inode*>)) + entries.arena.capacity();
+        total += names.names.capacity() * (1 + sizeof(std::pair<std::string_view, const char*>)) +
+                 names.arena.capacity();
+    }
+    return total;
+}
+
+std::unique_ptr<FileSystemBackend> makeBackend(std::string_view name) {
+    if (name == "disk") {
+        return std::make_unique<DiskBackend>();
+    }
+    if (name == "memory") {
+        return std::make_unique<MemoryBackend>();
+    }
+    if (name == "null") {
+        return std::make_unique<NullBackend>();
+    }
+    return nullptr;
+}
+
+// ==================== 嵌套目录生成 ====================
+
+namespace {
+
+void createNestedDirectories(FileSystemBackend& backend, const fs::path& base_path, int current_depth,
+                             const NestedTreeOptions& options, uint64_t& created) {
+    if (current_depth > options.max_depth) {
+        return;
+    }
+
+    // 创建当前层的 fan_out 个目录
+    for (int i = 1; i <= options.fan_out; ++i) {
+        fs::path dir_path = base_path / std::to_string(i);
+
+        try {
+            if (!backend.exists(dir_path)) {
+                if (backend.createDirectory(dir_path)) {
+                    ++created;
+                    if (options.log_each) {
+                        LOG_INFO("创建目录: {}", dir_path);
+                    }
+                } else {
+                    LOG_ERROR("无法创建目录: {}", dir_path);
+                    continue;
+                }
+            }
+
+            // 递归创建下一层
+            createNestedDirectories(backend, dir_path, current_depth + 1, options, created);
+        } catch (const fs::filesystem_error& e) {
+            LOG_ERROR("错误: {}", e.what());
+        }
+    }
+}
+
+}  // namespace
+
+uint64_t createNestedDirectories(FileSystemBackend& backend, const NestedTreeOptions& options) {
+    uint64_t created = 0;
+    backend.createDirectories(options.base_dir);
+    createNestedDirectories(backend, options.base_dir, 1, options, created);
+    return created;
+}
@@ -0,0 +1,147 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_FS_BACKEND_H
+#define HANDS_ON_CPP_FS_BACKEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "arena_allocator.h"
+#include "cache_line.h"
+#include "flat_hash_map.h"
+
+// ==================== 可替换的文件系统后端 ====================
+// createNestedDirectories 原来直接调用 std::filesystem，生成逻辑本身（拼路径、递归、日志）的开销
+// 和内核的开销混在一起测不开，也没法在内存里造一棵树给测试用。这里把它用到的两个操作抽成接口，语义和
+// fs::exists / fs::create_directory 一样：出错时抛 fs::filesystem_error。三个实现：
+// - DiskBackend：真实文件系统，POSIX 上直接 stat/mkdir，其他系统转给 std::filesystem
+// - MemoryBackend：内存里的目录树，可以多线程并发使用
+// - NullBackend：什么都不做，exists 总是 false、createDirectory 总是成功，测出来的就是纯 CPU 开销
+// 只有目录，没有文件；这些操作每个目录一次虚函数调用，和一次系统调用比可以忽略。
+
+class FileSystemBackend {
+public:
+    virtual ~FileSystemBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    virtual bool exists(const std::filesystem::path& path) = 0;
+    // 新建了返回 true；已经是目录返回 false；父目录不存在等错误抛 fs::filesystem_error
+    virtual bool createDirectory(const std::filesystem::path& path) = 0;
+    // 逐级 exists + createDirectory，最后新建了返回 true
+    virtual bool createDirectories(const std::filesystem::path& path);
+};
+
+class DiskBackend : public FileSystemBackend {
+public:
+    const char* name() const override { return "disk"; }
+    bool exists(const std::filesystem::path& path) override;
+    bool createDirectory(const std::filesystem::path& path) override;
+};
+
+class NullBackend : public FileSystemBackend {
+public:
+    const char* name() const override { return "null"; }
+    bool exists(const std::filesystem::path&) override { return false; }
+    bool createDirectory(const std::filesystem::path&) override { return true; }
+    bool createDirectories(const std::filesystem::path&) override { return true; }
+};
+
+// 内存里的目录树：
+// - 路径分量做哈希合并（hash-consing）：同一个名字只在内存里存一份，之后用它的地址代表这个名字，
+//   生成的树里反复出现的 "1".."9" 各只有一份
+// - 目录节点（inode）从 MonotonicArena 顺序切分，只有父节点和名字两个指针；clear() 一次性回收
+// - 目录项是一张 (父节点, 名字) -> 子节点 的哈希表，按键的哈希分成若干条带（stripe），
+//   每个条带一把锁、一个 FlatHashMap 和一个 arena，新节点分配在它的目录项所在的条带里；
+//   名字表也同样分条带。不同线程建不同的目录时大多落在不同的条带上，不抢同一把锁
+// 路径一律从根目录解析（相对路径也一样，没有当前目录），"." 忽略，".." 回到父目录。
+class MemoryBackend : public FileSystemBackend {
+public:
+    // stripes 向上取整到 2 的幂
+    explicit MemoryBackend(size_t stripes = 64);
+
+    MemoryBackend(const MemoryBackend&) = delete;
+    MemoryBackend& operator=(const MemoryBackend&) = delete;
+
+    const char* name() const override { return "memory"; }
+    bool exists(const std::filesystem::path& path) override;
+    bool createDirectory(const std::filesystem::path& path) override;
+
+    // 删除全部目录，arena 的内存留着下次用；不能和其他操作并发
+    void clear();
+
+    size_t directories() const;  // 不含根目录
+    size_t uniqueNames() const;
+    size_t memoryBytes() const;  // 哈希表容量加 arena 容量
+
+private:
+    struct Inode {
+        const Inode* parent;
+        const char* name;  // 指向名字表里的那一份
+    };
+
+    struct EntryKey {
+        const Inode* parent;
+        const char* name;
+
+        bool operator==(const EntryKey& other) const { return parent == other.parent && name == other.name; }
+    };
+
+    struct EntryKeyHash {
+        size_t operator()(const EntryKey& key) const;
+    };
+
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    struct alignas(kCacheLineSize) EntryStripe {
+        mutable std::mutex mutex;
+        FlatHashMap<EntryKey, Inode*, EntryKeyHash> entries;
+        MonotonicArena arena{16 * 1024};  // 条带多，块小一点：1024 个 Inode
+    };
+
+    struct alignas(kCacheLineSize) NameStripe {
+        mutable std::mutex mutex;
+        FlatHashMap<std::string_view, const char*, NameHash, std::equal_to<>> names;  // 键也指向 arena 里的那一份
+        MonotonicArena arena{1024};  // 名字去重之后很少
+    };
+
+    // 名字在名字表里的那一份，findName 不存在时返回 nullptr，internName 不存在时插入
+    const char* findName(std::string_view name) const;
+    const char* internName(std::string_view name);
+    const Inode* lookup(const Inode* parent, const char* name) const;
+    // 解析一串路径分量，某一级不存在时返回 nullptr
+    const Inode* resolve(std::string_view path) const;
+
+    Inode root_{nullptr, ""};
+    size_t stripe_mask_;
+    std::unique_ptr<EntryStripe[]> entry_stripes_;
+    std::unique_ptr<NameStripe[]> name_stripes_;
+};
+
+// "disk"、"memory"、"null"，不认识的名字返回 nullptr
+std::unique_ptr<FileSystemBackend> makeBackend(std::string_view name);
+
+// ==================== 嵌套目录生成 ====================
+// 每层 fan_out 个名为 1..fan_out 的目录，共 max_depth 层。每个目录先 exists，不存在再 createDirectory
+
+struct NestedTreeOptions {
+    std::filesystem::path base_dir;  // 不存在时先创建
+    int fan_out = 9;                 // 每层的分支数
+    int max_depth = 3;               // 最大深度
+    bool log_each = true;            // 每建一个目录打一条日志
+};
+
+// 返回新建的目录数，不含基础目录；单个目录出错时记日志并跳过它的子树
+uint64_t createNestedDirectories(FileSystemBackend& backend, const NestedTreeOptions& options);
+
+#endif //HANDS_ON_CPP_FS_BACKEND_H
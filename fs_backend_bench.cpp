@@ -0,0 +1,136 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 同一个 createNestedDirectories 跑在不同的后端上，把开销拆开：
+// - NullBackend：只有生成逻辑本身（fs::path 拼接、to_string、递归、虚函数调用），是 CPU 开销的下限
+// - MemoryBackend：再加上内存目录树的路径解析和插入，单线程和多线程（每个线程建自己的子树）
+// - DiskBackend：真实的 stat + mkdir，分别在 tmpfs（/dev/shm）和临时目录所在的文件系统上
+// 每行报告总毫秒数和每个目录的纳秒数，"减去 null" 一列是后端自己的开销：对 DiskBackend 来说就是系统调用
+// （包括内核里的路径查找和建目录）的开销。
+// 用法：fs_backend_bench [分支数] [深度]，默认 9 和 5（约 6.6 万个目录）
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "fs_backend.h"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+struct Row {
+    uint64_t created = 0;
+    double ms = 0;
+};
+
+// threads 个线程各自在 base/<线程号> 下建一棵完整的树
+Row runOnce(FileSystemBackend& backend, const fs::path& base, int fan_out, int depth, unsigned threads) {
+    std::vector<uint64_t> created(threads, 0);
+    const auto start = Clock::now();
+    auto worker = [&](unsigned t) {
+        NestedTreeOptions options;
+        options.base_dir = threads == 1 ? base : base / std::to_string(t + 1);
+        options.fan_out = fan_out;
+        options.max_depth = depth;
+        options.log_each = false;
+        created[t] = createNestedDirectories(backend, options);
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+        workers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& w : workers) {
+        w.join();
+    }
+    Row row;
+    row.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    for (uint64_t c : created) {
+        row.created += c;
+    }
+    return row;
+}
+
+void printRow(const std::string& name, const Row& row, double null_ns) {
+    const double ns = row.created ? row.ms * 1e6 / static_cast<double>(row.created) : 0.0;
+    std::cout << "  " << std::left << std::setw(30) << name << std::right << std::setw(10) << row.created << std::fixed
+              << std::setprecision(1) << std::setw(10) << row.ms << std::setw(12) << ns << std::setw(12)
+              << (null_ns > 0 ? ns - null_ns : 0.0) << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const int fan_out = argc > 1 ? std::stoi(argv[1]) : 9;
+    const int depth = argc > 2 ? std::stoi(argv[2]) : 5;
+    const std::string suffix = "hands_on_cpp_backend_bench_" + std::to_string(getpid());
+    constexpr int kRepetitions = 5;
+
+    std::cout << "分支数 " << fan_out << "，深度 " << depth << "，中位数（内存后端 " << kRepetitions << " 次，磁盘 3 次）"
+              << std::endl;
+    std::cout << "  " << std::left << std::setw(30) << "后端" << std::right
+              << "    目录数      毫秒     ns/目录   减去 null" << std::endl;
+
+    // 纯 CPU：路径用真实的样子，但什么都不创建
+    NullBackend null_backend;
+    std::vector<double> times;
+    Row row;
+    for (int r = 0; r < kRepetitions; ++r) {
+        row = runOnce(null_backend, fs::temp_directory_path() / suffix, fan_out, depth, 1);
+        times.push_back(row.ms);
+    }
+    row.ms = median(times);
+    const double null_ns = row.ms * 1e6 / static_cast<double>(row.created);
+    printRow("null", row, 0);
+
+    std::vector<unsigned> thread_counts = {1, 4};
+    for (unsigned threads : thread_counts) {
+        MemoryBackend memory;
+        times.clear();
+        size_t bytes = 0;
+        for (int r = 0; r < kRepetitions; ++r) {
+            memory.clear();
+            row = runOnce(memory, "/" + suffix, fan_out, depth, threads);
+            times.push_back(row.ms);
+            bytes = memory.memoryBytes();
+        }
+        row.ms = median(times);
+        printRow("memory，" + std::to_string(threads) + " 线程", row, null_ns);
+        std::cout << "    " << memory.directories() << " 个目录，" << memory.uniqueNames() << " 个不同的名字，" << bytes
+                  << " 字节" << std::endl;
+    }
+
+    std::vector<fs::path> roots;
+    if (fs::is_directory("/dev/shm")) {
+        roots.emplace_back("/dev/shm");
+    }
+    roots.push_back(fs::temp_directory_path());
+    for (const fs::path& root : roots) {
+        DiskBackend disk;
+        const fs::path base = root / suffix;
+        times.clear();
+        for (int r = 0; r < 3; ++r) {
+            std::error_code ec;
+            fs::remove_all(base, ec);
+            sync();  // 上一轮删除的脏数据先落盘
+            row = runOnce(disk, base, fan_out, depth, 1);
+            times.push_back(row.ms);
+        }
+        std::error_code ec;
+        fs::remove_all(base, ec);
+        row.ms = median(times);
+        printRow("disk " + root.string(), row, null_ns);
+    }
+    return 0;
+}
@@ -0,0 +1,514 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 地址空间布局：启动时一次性保留一大段 PROT_NONE 的虚拟地址，平均分给各个大小级别。
+// 级别 c 的槽位是 2^c 个数据页加 1 个保护页，槽位编号 = (地址 - 级别起点) / 槽位大小，
+// 元数据按编号放在单独 mmap 的数组里。槽位的状态：
+//   未使用 -> 使用中 -> 待保护（已 poison，还没 mprotect）-> 隔离中（PROT_NONE）-> 可复用 -> 使用中 ...
+// 这个文件里的代码不能调用 operator new（会被 alloc_tracker 的 operator new 调用）。
+
+#include "guarded_heap.h"
+
+#ifdef _WIN32
+
+namespace guarded_heap {
+
+void configure(const Options&) {}
+Options options() { return {}; }
+void* tryAllocate(size_t, size_t, const void*) noexcept { return nullptr; }
+bool owns(const void*) noexcept { return false; }
+bool isLive(const void*) noexcept { return false; }
+void deallocate(void*, const void*) noexcept {}
+void flush() noexcept {}
+void installFaultHandler() {}
+Stats stats() { return {}; }
+
+}  // namespace guarded_heap
+
+#else
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "report_writer.h"
+
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define GUARDED_HEAP_HAS_BACKTRACE 1
+#endif
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+namespace guarded_heap {
+namespace {
+
+constexpr uint32_t kClasses = 9;  // 1、2、4 ... 256 个数据页
+constexpr uint32_t kMaxBatch = 256;
+constexpr size_t kFifoCapacity = size_t{1} << 20;
+constexpr uint32_t kNone = UINT32_MAX;
+
+enum SlotState : uint8_t { kUnused, kLive, kPending, kQuarantined, kReusable };
+
+struct SlotMeta {
+    const void* alloc_site;
+    const void* free_site;
+    uint32_t size;
+    uint32_t offset;     // 用户指针相对数据区起点的偏移
+    uint32_t next_free;  // 可复用链表
+    uint8_t state;
+    uint8_t poison;      // 释放时用的 poison 字节，批量保护前据此检查
+};
+
+struct SizeClass {
+    char* base;
+    size_t data_bytes;
+    size_t slot_bytes;
+    uint32_t max_slots;
+    uint32_t next_slot;  // 从没用过的槽位从这里往后分
+    uint32_t free_head;
+    SlotMeta* meta;
+};
+
+struct SlotRef {
+    uint32_t cls;
+    uint32_t index;
+};
+
+// 全是常量初始化，不依赖静态初始化顺序
+std::mutex g_mutex;
+bool g_initialized = false;
+bool g_init_failed = false;
+std::atomic<uintptr_t> g_begin{0};
+std::atomic<uintptr_t> g_end{0};
+size_t g_page = 0;
+size_t g_class_span = 0;
+SizeClass g_classes[kClasses];
+
+SlotRef g_pending[kMaxBatch];
+uint32_t g_pending_count = 0;
+SlotRef* g_fifo = nullptr;
+size_t g_fifo_head = 0;
+size_t g_fifo_size = 0;
+Stats g_stats;
+
+std::atomic<uint32_t> g_sample_interval{1};
+std::atomic<size_t> g_quarantine_bytes{Options{}.quarantine_bytes};
+std::atomic<uint32_t> g_protect_batch{Options{}.protect_batch};
+std::atomic<uint8_t> g_poison{Options{}.poison};
+
+thread_local uint32_t t_sample_counter = 0;
+
+struct sigaction g_previous_segv {};
+struct sigaction g_previous_bus {};
+std::atomic<bool> g_handler_installed{false};
+
+void* mapAnonymous(size_t bytes, int prot) {
+    void* p = mmap(nullptr, bytes, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+// 先尝试每级 4 GB 虚拟地址，不行再逐级缩小（比如 32 位系统或限制了 RLIMIT_AS）
+bool initializeLocked() {
+    g_page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t spans[] = {sizeof(void*) >= 8 ? size_t{1} << 32 : size_t{1} << 26, size_t{1} << 28, size_t{1} << 24};
+    char* region = nullptr;
+    for (size_t span : spans) {
+        if ((region = static_cast<char*>(mapAnonymous(span * kClasses, PROT_NONE)))) {
+            g_class_span = span;
+            break;
+        }
+    }
+    if (!region) {
+        return false;
+    }
+    for (uint32_t c = 0; c < kClasses; ++c) {
+        SizeClass& sc = g_classes[c];
+        sc.base = region + c * g_class_span;
+        sc.data_bytes = g_page << c;
+        sc.slot_bytes = sc.data_bytes + g_page;
+        sc.max_slots = static_cast<uint32_t>(std::min<size_t>(g_class_span / sc.slot_bytes, kNone - 1));
+        sc.next_slot = 0;
+        sc.free_head = kNone;
+        sc.meta = static_cast<SlotMeta*>(mapAnonymous(sc.max_slots * sizeof(SlotMeta), PROT_READ | PROT_WRITE));
+        if (!sc.meta) {
+            return false;
+        }
+    }
+    g_fifo = static_cast<SlotRef*>(mapAnonymous(kFifoCapacity * sizeof(SlotRef), PROT_READ | PROT_WRITE));
+    if (!g_fifo) {
+        return false;
+    }
+    g_begin.store(reinterpret_cast<uintptr_t>(region), std::memory_order_release);
+    g_end.store(reinterpret_cast<uintptr_t>(region) + g_class_span * kClasses, std::memory_order_release);
+    return true;
+}
+
+inline char* slotData(const SizeClass& sc, uint32_t index) { return sc.base + size_t{index} * sc.slot_bytes; }
+
+inline bool inRegion(uintptr_t addr) {
+    return addr >= g_begin.load(std::memory_order_acquire) && addr < g_end.load(std::memory_order_acquire);
+}
+
+// 地址所在的槽位；调用前需要确认 inRegion
+SlotRef locate(uintptr_t addr) {
+    const uintptr_t offset = addr - g_begin.load(std::memory_order_relaxed);
+    const uint32_t cls = static_cast<uint32_t>(offset / g_class_span);
+    const size_t in_class = offset % g_class_span;
+    return {cls, static_cast<uint32_t>(in_class / g_classes[cls].slot_bytes)};
+}
+
+bool sampled() {
+    const uint32_t interval = g_sample_interval.load(std::memory_order_relaxed);
+    if (interval <= 1) {
+        return true;
+    }
+    if (++t_sample_counter < interval) {
+        return false;
+    }
+    t_sample_counter = 0;
+    return true;
+}
+
+// ==================== 报告 ====================
+
+void printSite(int fd, const char* label, const void* site) {
+    {
+        ReportWriter out(fd);
+        out.text("  ").text(label).text(": ");
+        if (!site) {
+            out.text("未知\n");
+            return;
+        }
+        out.hex(reinterpret_cast<uintptr_t>(site)).text("\n    ");
+    }
+#ifdef GUARDED_HEAP_HAS_BACKTRACE
+    void* pc = const_cast<void*>(site);
+    backtrace_symbols_fd(&pc, 1, fd);
+#else
+    ReportWriter(fd).text("\n");
+#endif
+}
+
+const char* stateName(uint8_t state) {
+    switch (state) {
+        case kLive: return "使用中";
+        case kPending: return "已释放，等待保护";
+        case kQuarantined: return "已释放，在隔离区";
+        case kReusable: return "已释放，已移出隔离区";
+        default: return "从未分配";
+    }
+}
+
+void describeBlock(int fd, const SizeClass& sc, uint32_t index, uintptr_t addr) {
+    const SlotMeta& meta = sc.meta[index];
+    const uintptr_t user = reinterpret_cast<uintptr_t>(slotData(sc, index)) + meta.offset;
+    {
+        ReportWriter out(fd);
+        out.text("  块: ").hex(user).text("，").number(meta.size).text(" 字节，").text(stateName(meta.state));
+        if (meta.state != kUnused) {
+            if (addr >= user + meta.size) {
+                out.text("；访问位置在块末尾之后 ").number(addr - (user + meta.size)).text(" 字节");
+            } else if (addr >= user) {
+                out.text("；访问位置在块内第 ").number(addr - user).text(" 字节");
+            } else {
+                out.text("；访问位置在块开头之前 ").number(user - addr).text(" 字节");
+            }
+        }
+        out.text("\n");
+    }
+    if (meta.state != kUnused) {
+        printSite(fd, "分配位置", meta.alloc_site);
+    }
+    if (meta.state >= kPending) {
+        printSite(fd, "释放位置", meta.free_site);
+    }
+}
+
+[[noreturn]] void reportAndAbort(const char* what, const SizeClass& sc, uint32_t index, uintptr_t addr) {
+    {
+        ReportWriter out(2);
+        out.text("==== guarded_heap: ").text(what).text(" ====\n  地址: ").hex(addr).text("\n");
+    }
+    describeBlock(2, sc, index, addr);
+    std::abort();
+}
+
+void reportFault(int sig, uintptr_t addr) {
+    const SlotRef ref = locate(addr);
+    const SizeClass& sc = g_classes[ref.cls];
+    const bool guard_page = addr - reinterpret_cast<uintptr_t>(slotData(sc, ref.index)) >= sc.data_bytes;
+    const uint8_t state = ref.index < sc.max_slots ? sc.meta[ref.index].state : static_cast<uint8_t>(kUnused);
+    const char* what = guard_page          ? "越界访问（碰到保护页）"
+                       : state >= kPending ? "释放后使用"
+                                           : "访问了未分配的受保护内存";
+    {
+        ReportWriter out(2);
+        out.text("==== guarded_heap: ").text(what).text("（信号 ").number(static_cast<uint64_t>(sig))
+            .text("）====\n  地址: ").hex(addr).text("\n");
+    }
+    if (ref.index < sc.max_slots) {
+        describeBlock(2, sc, ref.index, addr);
+    }
+}
+
+// ==================== 隔离区 ====================
+
+bool isPoisoned(const unsigned char* p, size_t n, uint8_t poison) {
+    uint64_t pattern;
+    std::memset(&pattern, poison, sizeof(pattern));
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if (word != pattern) {
+            return false;
+        }
+    }
+    for (; i < n; ++i) {
+        if (p[i] != poison) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void evictLocked(size_t limit) {
+    while (g_fifo_size > 0 && (g_stats.quarantined_bytes > limit || g_fifo_size == kFifoCapacity)) {
+        const SlotRef ref = g_fifo[g_fifo_head];
+        g_fifo_head = (g_fifo_head + 1) % kFifoCapacity;
+        --g_fifo_size;
+        SizeClass& sc = g_classes[ref.cls];
+        SlotMeta& meta = sc.meta[ref.index];
+        meta.state = kReusable;
+        meta.next_free = sc.free_head;
+        sc.free_head = ref.index;
+        g_stats.quarantined_bytes -= sc.data_bytes;
+    }
+}
+
+// 先检查 poison（发现被写过就报错），再按地址排序，同一级别里编号连续的槽位合成一段：
+// 中间的保护页本来就是 PROT_NONE，整段一次 mprotect 就行。
+// 物理页随即用 madvise 还给系统，隔离区只占虚拟地址
+void flushPendingLocked() {
+    if (g_pending_count == 0) {
+        return;
+    }
+    for (uint32_t i = 0; i < g_pending_count; ++i) {
+        const SizeClass& sc = g_classes[g_pending[i].cls];
+        const SlotMeta& meta = sc.meta[g_pending[i].index];
+        const auto* user = reinterpret_cast<const unsigned char*>(slotData(sc, g_pending[i].index) + meta.offset);
+        if (!isPoisoned(user, meta.size, meta.poison)) {
+            reportAndAbort("释放后写入（poison 被改写）", sc, g_pending[i].index, reinterpret_cast<uintptr_t>(user));
+        }
+    }
+    std::sort(g_pending, g_pending + g_pending_count, [](const SlotRef& a, const SlotRef& b) {
+        return a.cls != b.cls ? a.cls < b.cls : a.index < b.index;
+    });
+    uint32_t begin = 0;
+    while (begin < g_pending_count) {
+        uint32_t end = begin + 1;
+        while (end < g_pending_count && g_pending[end].cls == g_pending[begin].cls &&
+               g_pending[end].index == g_pending[end - 1].index + 1) {
+            ++end;
+        }
+        const SizeClass& sc = g_classes[g_pending[begin].cls];
+        char* first = slotData(sc, g_pending[begin].index);
+        const size_t length = (end - begin - 1) * sc.slot_bytes + sc.data_bytes;
+        mprotect(first, length, PROT_NONE);
+#ifdef MADV_FREE
+        madvise(first, length, MADV_FREE);
+#else
+        madvise(first, length, MADV_DONTNEED);
+#endif
+        g_stats.syscalls += 2;
+        begin = end;
+    }
+    for (uint32_t i = 0; i < g_pending_count; ++i) {
+        SizeClass& sc = g_classes[g_pending[i].cls];
+        sc.meta[g_pending[i].index].state = kQuarantined;
+        g_fifo[(g_fifo_head + g_fifo_size) % kFifoCapacity] = g_pending[i];
+        ++g_fifo_size;
+        g_stats.quarantined_bytes += sc.data_bytes;
+        evictLocked(g_quarantine_bytes.load(std::memory_order_relaxed));
+    }
+    g_pending_count = 0;
+}
+
+// ==================== 信号处理 ====================
+
+void chainToPrevious(int sig, siginfo_t* info, void* context) {
+    const struct sigaction& previous = sig == SIGBUS ? g_previous_bus : g_previous_segv;
+    if (previous.sa_flags & SA_SIGINFO) {
+        previous.sa_sigaction(sig, info, context);
+    } else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+        previous.sa_handler(sig);
+    } else {
+        signal(sig, SIG_DFL);  // 返回后重新执行出错的指令，按默认方式终止
+    }
+}
+
+void onFault(int sig, siginfo_t* info, void* context) {
+    const auto addr = reinterpret_cast<uintptr_t>(info->si_addr);
+    if (!inRegion(addr)) {
+        chainToPrevious(sig, info, context);
+        return;
+    }
+    reportFault(sig, addr);
+    // 恢复默认处理再返回：出错的指令重新执行一次，进程按默认方式终止，可以生成 core
+    signal(sig, SIG_DFL);
+}
+
+}  // namespace
+
+void configure(const Options& options) {
+    g_sample_interval.store(std::max<uint32_t>(options.sample_interval, 1), std::memory_order_relaxed);
+    g_quarantine_bytes.store(options.quarantine_bytes, std::memory_order_relaxed);
+    g_protect_batch.store(std::clamp<uint32_t>(options.protect_batch, 1, kMaxBatch), std::memory_order_relaxed);
+    g_poison.store(options.poison, std::memory_order_relaxed);
+}
+
+Options options() {
+    Options result;
+    result.sample_interval = g_sample_interval.load(std::memory_order_relaxed);
+    result.quarantine_bytes = g_quarantine_bytes.load(std::memory_order_relaxed);
+    result.protect_batch = g_protect_batch.load(std::memory_order_relaxed);
+    result.poison = g_poison.load(std::memory_order_relaxed);
+    return result;
+}
+
+void* tryAllocate(size_t size, size_t alignment, const void* site) noexcept {
+    if (!sampled()) {
+        return nullptr;
+    }
+    size = std::max<size_t>(size, 1);
+    alignment = std::max<size_t>(alignment, 1);
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_initialized) {
+        g_initialized = true;
+        g_init_failed = !initializeLocked();
+    }
+    if (g_init_failed || alignment > g_page || size > (g_page << (kClasses - 1)) - alignment + 1) {
+        return nullptr;
+    }
+
+    // 数据区要放得下 size，再加上按对齐向下取整可能多出来的 alignment - 1 字节
+    const size_t pages = (size + alignment - 1 + g_page - 1) / g_page;
+    uint32_t cls = 0;
+    while ((size_t{1} << cls) < pages) {
+        ++cls;
+    }
+    SizeClass& sc = g_classes[cls];
+    uint32_t index;
+    if (sc.free_head != kNone) {
+        index = sc.free_head;
+        sc.free_head = sc.meta[index].next_free;
+    } else if (sc.next_slot < sc.max_slots) {
+        index = sc.next_slot++;
+    } else {
+        return nullptr;  // 这一级的地址空间用完了
+    }
+
+    char* data = slotData(sc, index);
+    if (mprotect(data, sc.data_bytes, PROT_READ | PROT_WRITE) != 0) {
+        SlotMeta& meta = sc.meta[index];
+        meta.state = kReusable;
+        meta.next_free = sc.free_head;
+        sc.free_head = index;
+        return nullptr;
+    }
+    ++g_stats.syscalls;
+
+    // 靠右放：块末尾尽量贴着保护页
+    const uintptr_t end = reinterpret_cast<uintptr_t>(data) + sc.data_bytes;
+    const uintptr_t user = (end - size) & ~(static_cast<uintptr_t>(alignment) - 1);
+    SlotMeta& meta = sc.meta[index];
+    meta.alloc_site = site;
+    meta.free_site = nullptr;
+    meta.size = static_cast<uint32_t>(size);
+    meta.offset = static_cast<uint32_t>(user - reinterpret_cast<uintptr_t>(data));
+    meta.state = kLive;
+    ++g_stats.allocations;
+    ++g_stats.live_blocks;
+    return reinterpret_cast<void*>(user);
+}
+
+bool owns(const void* ptr) noexcept { return inRegion(reinterpret_cast<uintptr_t>(ptr)); }
+
+bool isLive(const void* ptr) noexcept {
+    const auto addr = reinterpret_cast<uintptr_t>(ptr);
+    std::lock_guard<std::mutex> lock(g_mutex);
+    const SlotRef ref = locate(addr);
+    const SizeClass& sc = g_classes[ref.cls];
+    return ref.index < sc.next_slot && sc.meta[ref.index].state == kLive;
+}
+
+void deallocate(void* ptr, const void* site) noexcept {
+    const auto addr = reinterpret_cast<uintptr_t>(ptr);
+    std::lock_guard<std::mutex> lock(g_mutex);
+    const SlotRef ref = locate(addr);
+    SizeClass& sc = g_classes[ref.cls];
+    if (ref.index >= sc.next_slot) {
+        reportAndAbort("释放了从未分配的地址", sc, std::min(ref.index, sc.max_slots - 1), addr);
+    }
+    SlotMeta& meta = sc.meta[ref.index];
+    if (meta.state != kLive) {
+        reportAndAbort("重复释放", sc, ref.index, addr);
+    }
+    if (addr != reinterpret_cast<uintptr_t>(slotData(sc, ref.index)) + meta.offset) {
+        reportAndAbort("释放的指针不是块的起始地址", sc, ref.index, addr);
+    }
+
+    meta.poison = g_poison.load(std::memory_order_relaxed);
+    std::memset(ptr, meta.poison, meta.size);
+    meta.free_site = site;
+    meta.state = kPending;
+    ++g_stats.frees;
+    --g_stats.live_blocks;
+    g_pending[g_pending_count++] = ref;
+    if (g_pending_count >= g_protect_batch.load(std::memory_order_relaxed)) {
+        flushPendingLocked();
+    }
+}
+
+void flush() noexcept {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    flushPendingLocked();
+}
+
+void installFaultHandler() {
+    if (g_handler_installed.exchange(true)) {
+        return;
+    }
+    // 备用信号栈：栈溢出导致的 SIGSEGV 也能进处理函数（然后交给原来的处理函数）
+    constexpr size_t kAltStackSize = 64 * 1024;
+    if (void* stack = mapAnonymous(kAltStackSize, PROT_READ | PROT_WRITE)) {
+        stack_t alt {};
+        alt.ss_sp = stack;
+        alt.ss_size = kAltStackSize;
+        sigaltstack(&alt, nullptr);
+    }
+    struct sigaction action {};
+    action.sa_sigaction = onFault;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigaction(SIGSEGV, &action, &g_previous_segv);
+    sigaction(SIGBUS, &action, &g_previous_bus);
+}
+
+Stats stats() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_stats;
+}
+
+}  // namespace guarded_heap
+
+#endif
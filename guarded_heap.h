@@ -0,0 +1,69 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_GUARDED_HEAP_H
+#define HANDS_ON_CPP_GUARDED_HEAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+// ==================== 带保护页的隔离分配器（调试模式） ====================
+// 每个块独占若干页，后面紧跟一个不可访问的保护页，对象靠右放（按对齐要求向下取整），越过对齐留白就会触发 SIGSEGV。
+// 释放时先用 poison 填满，再 mprotect 成不可访问，放进 FIFO 隔离区；隔离区超过容量后
+// 最早释放的块才会被复用，所以悬空指针在这段时间内一访问就会立刻出错，
+// 出错时信号处理函数打印访问地址、块大小、分配位置和释放位置。
+// 为了能在灰度机器上长期开启：
+// - 按大小分级（1、2、4 ... 256 页），每级有自己的虚拟地址区间，块和元数据都能按地址直接算出来
+// - 释放的块攒够一批再统一 mprotect（并用 madvise 归还物理页），按地址排序后相邻的块合并成一次调用；
+//   还没保护的这一批读到的是 poison，写入在下一次批量保护时检查出来；默认逐个保护，灰度环境可以调大
+// - 可以只抽样保护每 N 次分配中的一次，其余的由调用方走普通 malloc
+// 超过 256 页或对齐要求超过一页的分配不保护。只支持 POSIX（mmap/mprotect），其他平台 tryAllocate 总是返回空。
+// 这个模块自己不调用 operator new，可以在替换后的全局 operator new 里使用（见 alloc_tracker.cpp）。
+
+namespace guarded_heap {
+
+struct Options {
+    uint32_t sample_interval = 1;          // 每 N 次分配保护一次，1 表示全部
+    size_t quarantine_bytes = 64u << 20;   // 隔离区容量（按占用的数据页计）
+    uint32_t protect_batch = 1;            // 攒够这么多个释放的块再 mprotect，1 表示立即保护（悬空访问立刻出错）
+    uint8_t poison = 0xDF;                 // 释放后填充的字节
+};
+
+// 可以随时调用，对之后的分配和释放生效
+void configure(const Options& options);
+Options options();
+
+// 抽样命中且大小合适时返回受保护的块，否则返回空（调用方应退回普通分配）。
+// site 是分配位置，出错时打印
+void* tryAllocate(size_t size, size_t alignment, const void* site) noexcept;
+
+// ptr 是否落在受保护区间里（只比较地址，很便宜）
+bool owns(const void* ptr) noexcept;
+
+// ptr（块内任意地址，调用前确认 owns）所在的块是否已分配且还没释放。
+// 释放了的块可能已经 mprotect 成不可访问，调用方读块里的内容之前先问这里
+bool isLive(const void* ptr) noexcept;
+
+// 释放 tryAllocate 返回的指针；重复释放或指针不是块的起始地址时打印报告并 abort
+void deallocate(void* ptr, const void* site) noexcept;
+
+// 把还没保护的释放块立即 mprotect
+void flush() noexcept;
+
+// 安装 SIGSEGV/SIGBUS 处理函数（使用备用信号栈）；不属于受保护区间的错误交给原来的处理函数
+void installFaultHandler();
+
+struct Stats {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t syscalls = 0;          // mprotect/madvise 调用次数
+    uint64_t live_blocks = 0;
+    uint64_t quarantined_bytes = 0;
+};
+
+Stats stats();
+
+}  // namespace guarded_heap
+
+#endif //HANDS_ON_CPP_GUARDED_HEAP_H
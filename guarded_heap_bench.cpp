@@ -0,0 +1,124 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 受保护分配的代价：和 alloc_tracker_bench 一样的负载（每批 1000 个 400 字节对象，分配、求和、释放），
+// 对照组是 malloc/free，受保护组先 tryAllocate，没抽中再退回 malloc，和 alloc_tracker 的受保护模式一致。
+// 比较全部保护时不同的 mprotect 批量大小，以及灰度环境里抽样保护的开销。
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "bench_harness.h"
+#include "guarded_heap.h"
+#include "simd_kernels.h"
+
+class TestObject {
+public:
+    TestObject(int value = 0) {
+        for (int i = 0; i < 100; i++) {
+            data[i] = value + i;
+        }
+    }
+
+    int getSum() const { return simd::sum(std::span<const int32_t>(data, 100)); }
+
+private:
+    int data[100];
+};
+
+template <typename Alloc, typename Release>
+void heapLoop(bench::State& state, int batch, Alloc alloc, Release release) {
+    std::vector<TestObject*> objects(batch);
+    unsigned next = 0;
+    for (auto _ : state) {
+        for (int j = 0; j < batch; j++) {
+            objects[j] = alloc(static_cast<int>(next++));
+        }
+        for (int j = 0; j < batch; j++) {
+            bench::doNotOptimize(objects[j]->getSum());
+        }
+        for (TestObject* obj : objects) {
+            release(obj);
+        }
+    }
+    state.setItemsPerIteration(batch);
+}
+
+void mallocLoop(bench::State& state, int batch) {
+    heapLoop(state, batch,
+        [](int i) { return ::new (std::malloc(sizeof(TestObject))) TestObject(i); },
+        [](TestObject* obj) {
+            obj->~TestObject();
+            std::free(obj);
+        });
+}
+
+void guardedLoop(bench::State& state, int batch, uint32_t sample_interval, uint32_t protect_batch) {
+    guarded_heap::Options options;
+    options.sample_interval = sample_interval;
+    options.protect_batch = protect_batch;
+    guarded_heap::configure(options);
+    const guarded_heap::Stats before = guarded_heap::stats();
+
+    heapLoop(state, batch,
+        [](int i) {
+            void* p = guarded_heap::tryAllocate(sizeof(TestObject), alignof(TestObject), nullptr);
+            return ::new (p ? p : std::malloc(sizeof(TestObject))) TestObject(i);
+        },
+        [](TestObject* obj) {
+            obj->~TestObject();
+            if (guarded_heap::owns(obj)) {
+                guarded_heap::deallocate(obj, nullptr);
+            } else {
+                std::free(obj);
+            }
+        });
+
+    guarded_heap::flush();
+    const guarded_heap::Stats after = guarded_heap::stats();
+    const double frees = static_cast<double>(after.frees - before.frees);
+    state.setCounter("guarded_pct", 100.0 * frees / (static_cast<double>(state.iterations()) * batch));
+    if (frees > 0) {
+        state.setCounter("syscalls_per_guarded",
+                         static_cast<double>(after.syscalls - before.syscalls) / frees);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int batch = 1000;
+
+    struct Config {
+        const char* name;
+        uint32_t sample_interval;
+        uint32_t protect_batch;
+    };
+    const Config configs[] = {
+        {"全部保护，逐个 mprotect", 1, 1},
+        {"全部保护，每 32 个一批", 1, 32},
+        {"全部保护，每 256 个一批", 1, 256},
+        {"抽样 1/100，每 32 个一批", 100, 32},
+        {"抽样 1/1000，每 32 个一批", 1000, 32},
+    };
+
+    bench::Runner runner(bench::parseOptions(argc, argv));
+    runner.add("malloc/free", [&](bench::State& state) { mallocLoop(state, batch); });
+    for (const Config& config : configs) {
+        runner.add(std::string("guarded: ") + config.name, [&](bench::State& state) {
+            guardedLoop(state, batch, config.sample_interval, config.protect_batch);
+        });
+    }
+    std::vector<bench::Result> results = runner.run();
+    if (results.size() != 1 + std::size(configs)) {
+        return 0;  // 用 --bench_filter 只跑了一部分
+    }
+
+    std::cout << "\n相对 malloc/free 的减速:" << std::endl;
+    for (size_t i = 1; i < results.size(); ++i) {
+        std::cout << "  " << results[i].name << ": " << results[i].median / results[0].median << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 侵入式引用计数 vs shared_ptr：
+// - 内存占用：句柄大小，以及每个对象实际分配的字节数和次数（替换全局 operator new 来统计）
+// - 单线程拷贝/销毁吞吐：往一个句柄数组里循环赋值，每次赋值 = 一次拷贝 + 一次释放
+// - 多线程：所有线程拷贝同一个对象（计数所在的缓存行来回争抢）和各自拷贝自己的对象
+// 用法：intrusive_bench [最大线程数]
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "intrusive_ptr.h"
+
+using Clock = std::chrono::steady_clock;
+
+// ==================== 分配统计 ====================
+
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_allocated_bytes{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// ==================== 被管理的对象 ====================
+// 和 ptr_ref_test.cpp 里的 Resource/CacheEntry 差不多大：一个 id 加一点数据
+
+struct Payload {
+    int64_t id = 0;
+    int64_t value = 0;
+};
+
+struct PlainObject : Payload {};
+
+struct AtomicObject : Payload, RefCounted<AtomicObject> {};
+
+struct SingleThreadObject : Payload, RefCounted<SingleThreadObject, PlainRefCount> {};
+
+struct WeakAtomicObject : Payload, WeakRefCounted<WeakAtomicObject> {};
+
+// ==================== 内存占用 ====================
+
+template <typename Make>
+void footprint(const char* name, size_t handle_size, Make make) {
+    const int objects = 1000;
+    const uint64_t bytes_before = g_allocated_bytes.load();
+    {
+        std::vector<decltype(make())> handles;
+        handles.reserve(objects);
+        const uint64_t vector_bytes = g_allocated_bytes.load() - bytes_before;
+        const uint64_t after_reserve = g_allocations.load();
+        for (int i = 0; i < objects; ++i) {
+            handles.push_back(make());
+        }
+        std::cout << "  " << std::left << std::setw(32) << name << std::right << " 句柄 " << std::setw(2)
+                  << handle_size << " 字节，每个对象分配 "
+                  << static_cast<double>(g_allocations.load() - after_reserve) / objects << " 次 / "
+                  << static_cast<double>(g_allocated_bytes.load() - bytes_before - vector_bytes) / objects
+                  << " 字节" << std::endl;
+    }
+}
+
+// ==================== 拷贝/销毁吞吐 ====================
+
+constexpr size_t kSlots = 1024;
+
+// 每一轮先把 source 拷贝进所有槽位（计数加一），再逐个释放（计数减一），返回拷贝次数。
+// 不直接对非空槽位赋值：shared_ptr 赋值时发现控制块相同会跳过计数操作，测不到真实开销。
+template <typename Handle>
+uint64_t copyLoop(const Handle& source, std::vector<Handle>& slots, uint64_t iterations) {
+    uint64_t copies = 0;
+    while (copies < iterations) {
+        for (auto& slot : slots) {
+            slot = source;
+        }
+        for (auto& slot : slots) {
+            slot.reset();
+        }
+        copies += slots.size();
+    }
+    return copies;
+}
+
+// threads 个线程同时拷贝；shared_object 为 true 时都拷贝同一个对象，否则各自一个
+template <typename Handle, typename Make>
+double copiesPerSecond(unsigned threads, bool shared_object, Make make) {
+    const uint64_t iterations = 4'000'000;
+    Handle common = make();
+    std::atomic<unsigned> ready{0};
+    std::atomic<bool> go{false};
+    std::atomic<uint64_t> copies{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            Handle own = shared_object ? common : make();
+            std::vector<Handle> slots(kSlots);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+            }
+            copies.fetch_add(copyLoop(own, slots, iterations));
+        });
+    }
+    while (ready.load() != threads) {
+    }
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(copies.load()) / seconds;
+}
+
+template <typename Handle, typename Make>
+void throughputRow(const char* name, unsigned threads, bool shared_object, Make make) {
+    std::cout << "    " << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << copiesPerSecond<Handle>(threads, shared_object, make) / 1e6 << " M 次/秒"
+              << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::stoul(argv[1]))
+                                          : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "内存占用（对象本身 " << sizeof(Payload) << " 字节）:" << std::endl;
+    footprint("shared_ptr(new T)", sizeof(std::shared_ptr<PlainObject>),
+              []() { return std::shared_ptr<PlainObject>(new PlainObject); });
+    footprint("make_shared<T>", sizeof(std::shared_ptr<PlainObject>),
+              []() { return std::make_shared<PlainObject>(); });
+    footprint("IntrusivePtr<原子计数>", sizeof(IntrusivePtr<AtomicObject>),
+              []() { return makeIntrusive<AtomicObject>(); });
+    footprint("IntrusivePtr<非原子计数>", sizeof(IntrusivePtr<SingleThreadObject>),
+              []() { return makeIntrusive<SingleThreadObject>(); });
+    footprint("IntrusivePtr<支持弱引用>", sizeof(IntrusivePtr<WeakAtomicObject>),
+              []() { return makeIntrusive<WeakAtomicObject>(); });
+    footprint("IntrusivePtr<支持弱引用> + 弱引用", sizeof(IntrusiveWeakPtr<WeakAtomicObject>), []() {
+        auto strong = makeIntrusive<WeakAtomicObject>();
+        IntrusiveWeakPtr<WeakAtomicObject> weak(strong);
+        return std::make_pair(strong, weak);
+    });
+
+    std::cout << "拷贝 + 销毁吞吐:" << std::endl;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        for (bool shared_object : {false, true}) {
+            if (threads == 1 && shared_object) {
+                continue;
+            }
+            std::cout << "  " << threads << " 线程，" << (shared_object ? "共享同一个对象" : "各自的对象") << ":"
+                      << std::endl;
+            throughputRow<std::shared_ptr<PlainObject>>("shared_ptr", threads, shared_object,
+                                                        []() { return std::make_shared<PlainObject>(); });
+            throughputRow<IntrusivePtr<AtomicObject>>("IntrusivePtr<原子计数>", threads, shared_object,
+                                                      []() { return makeIntrusive<AtomicObject>(); });
+            throughputRow<IntrusivePtr<WeakAtomicObject>>("IntrusivePtr<支持弱引用>", threads, shared_object,
+                                                          []() { return makeIntrusive<WeakAtomicObject>(); });
+            if (threads == 1) {
+                // 非原子计数不能跨线程共享，只在单线程里比较
+                throughputRow<IntrusivePtr<SingleThreadObject>>(
+                    "IntrusivePtr<非原子计数>", threads, shared_object,
+                    []() { return makeIntrusive<SingleThreadObject>(); });
+            }
+        }
+    }
+
+    return 0;
+}
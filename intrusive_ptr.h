@@ -0,0 +1,339 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_INTRUSIVE_PTR_H
+#define HANDS_ON_CPP_INTRUSIVE_PTR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// ==================== 侵入式引用计数指针 ====================
+// 引用计数直接放在对象里，和 shared_ptr 相比：
+// - 没有单独的控制块，new 一次就够了（shared_ptr(new T) 要两次）
+// - 句柄只有一个指针（8 字节，shared_ptr 是 16 字节）
+// - 计数跟着对象走，随时可以从裸指针（包括 this）重新得到 IntrusivePtr，不需要 enable_shared_from_this
+// 计数策略二选一：AtomicRefCount 可以跨线程共享；PlainRefCount 是普通整数，只能在单线程里用，但拷贝更便宜。
+//
+// 用法：class Foo : public RefCounted<Foo> {...};  auto p = makeIntrusive<Foo>(...);
+// 需要弱引用时继承 WeakRefCounted<Foo>，它多一个指向“弱引用锚点”的指针，锚点在第一次创建弱引用时才分配。
+
+// 原子计数：可以在多个线程之间拷贝、释放同一个对象的指针
+struct AtomicRefCount {
+    using Counter = std::atomic<uint32_t>;
+
+    static void increment(Counter& count) noexcept { count.fetch_add(1, std::memory_order_relaxed); }
+
+    // 返回减一之后的值；减到 0 的线程要能看到其他线程之前对对象的所有写入
+    static uint32_t decrement(Counter& count) noexcept {
+        return count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+    }
+
+    // 只在计数不为 0 时加一（弱引用提升为强引用时用）
+    static bool incrementIfNonZero(Counter& count) noexcept {
+        uint32_t current = count.load(std::memory_order_relaxed);
+        while (current != 0) {
+            if (count.compare_exchange_weak(current, current + 1, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static uint32_t load(const Counter& count) noexcept { return count.load(std::memory_order_relaxed); }
+
+    // 弱引用锚点上的锁，只在弱引用提升和对象销毁时短暂持有
+    class Lock {
+    public:
+        void lock() noexcept {
+            while (flag_.test_and_set(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+
+        void unlock() noexcept { flag_.clear(std::memory_order_release); }
+
+    private:
+        std::atomic_flag flag_ = ATOMIC_FLAG_INIT;
+    };
+};
+
+// 非原子计数：对象只在一个线程里使用时，省掉 lock 前缀指令
+struct PlainRefCount {
+    using Counter = uint32_t;
+
+    static void increment(Counter& count) noexcept { ++count; }
+    static uint32_t decrement(Counter& count) noexcept { return --count; }
+
+    static bool incrementIfNonZero(Counter& count) noexcept {
+        if (count == 0) {
+            return false;
+        }
+        ++count;
+        return true;
+    }
+
+    static uint32_t load(const Counter& count) noexcept { return count; }
+
+    struct Lock {
+        void lock() noexcept {}
+        void unlock() noexcept {}
+    };
+};
+
+template <typename T>
+class IntrusivePtr;
+
+template <typename T>
+class IntrusiveWeakPtr;
+
+// 只有强引用的基类：对象里只多一个 4 字节计数
+template <typename Derived, typename Policy = AtomicRefCount>
+class RefCounted {
+public:
+    using RefPolicy = Policy;
+
+    uint32_t refCount() const noexcept { return Policy::load(refs_); }
+
+protected:
+    RefCounted() noexcept = default;
+
+    // 拷贝对象时不拷贝计数，新对象从 0 开始
+    RefCounted(const RefCounted&) noexcept {}
+    RefCounted& operator=(const RefCounted&) noexcept { return *this; }
+
+    ~RefCounted() = default;
+
+private:
+    template <typename>
+    friend class IntrusivePtr;
+
+    void intrusiveAddRef() const noexcept { Policy::increment(refs_); }
+
+    void intrusiveRelease() const noexcept {
+        if (Policy::decrement(refs_) == 0) {
+            delete static_cast<const Derived*>(this);
+        }
+    }
+
+    mutable typename Policy::Counter refs_{0};
+};
+
+// 支持弱引用的基类
+// 对象持有一个锚点（弱引用数 + 锁 + 指回对象的指针），弱引用只指向锚点：
+// - 强引用减到 0 时，在锚点的锁里把 object 清空，然后销毁对象，锚点留到最后一个弱引用释放
+// - lock() 在同一把锁里读 object 并尝试把强引用数从非 0 加一，所以不会拿到正在销毁的对象
+// 没有弱引用时不分配锚点，强引用的开销和 RefCounted 一样。
+template <typename Derived, typename Policy = AtomicRefCount>
+class WeakRefCounted {
+public:
+    using RefPolicy = Policy;
+
+    uint32_t refCount() const noexcept { return Policy::load(refs_); }
+
+protected:
+    WeakRefCounted() noexcept = default;
+    WeakRefCounted(const WeakRefCounted&) noexcept {}
+    WeakRefCounted& operator=(const WeakRefCounted&) noexcept { return *this; }
+
+    ~WeakRefCounted() = default;
+
+private:
+    template <typename>
+    friend class IntrusivePtr;
+    template <typename>
+    friend class IntrusiveWeakPtr;
+
+    struct WeakAnchor {
+        explicit WeakAnchor(Derived* o) noexcept : object(o) {}
+
+        typename Policy::Counter refs{1};  // 弱引用数，对象本身也算一个
+        typename Policy::Lock lock;
+        Derived* object;  // 对象销毁后为空，读写都在 lock 里
+    };
+
+    static void addAnchorRef(WeakAnchor* anchor) noexcept { Policy::increment(anchor->refs); }
+
+    static void releaseAnchor(WeakAnchor* anchor) noexcept {
+        if (Policy::decrement(anchor->refs) == 0) {
+            delete anchor;
+        }
+    }
+
+    void intrusiveAddRef() const noexcept { Policy::increment(refs_); }
+
+    void intrusiveRelease() const noexcept {
+        if (Policy::decrement(refs_) != 0) {
+            return;
+        }
+        // 强引用已经是 0，不会再有人创建锚点，这里读到的就是最终值
+        if (WeakAnchor* anchor = anchor_.load(std::memory_order_acquire)) {
+            {
+                std::lock_guard<typename Policy::Lock> guard(anchor->lock);
+                anchor->object = nullptr;
+            }
+            releaseAnchor(anchor);
+        }
+        delete static_cast<const Derived*>(this);
+    }
+
+    // 返回锚点并为调用方加一个弱引用；只有持有强引用的线程会调用
+    WeakAnchor* acquireAnchor() const {
+        WeakAnchor* anchor = anchor_.load(std::memory_order_acquire);
+        if (!anchor) {
+            auto* created = new WeakAnchor(const_cast<Derived*>(static_cast<const Derived*>(this)));
+            if (anchor_.compare_exchange_strong(anchor, created, std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                anchor = created;
+            } else {
+                delete created;  // 另一个线程抢先创建了
+            }
+        }
+        addAnchorRef(anchor);
+        return anchor;
+    }
+
+    mutable typename Policy::Counter refs_{0};
+    mutable std::atomic<WeakAnchor*> anchor_{nullptr};
+};
+
+// 构造时不加计数，用于接管已经加过一次的引用
+struct AdoptRef {};
+
+template <typename T>
+class IntrusivePtr {
+public:
+    IntrusivePtr() noexcept = default;
+    IntrusivePtr(std::nullptr_t) noexcept {}
+
+    // 从裸指针构造会加一次引用，对象自己的 this 也可以
+    explicit IntrusivePtr(T* ptr) noexcept : ptr_(ptr) {
+        if (ptr_) {
+            ptr_->intrusiveAddRef();
+        }
+    }
+
+    IntrusivePtr(T* ptr, AdoptRef) noexcept : ptr_(ptr) {}
+
+    IntrusivePtr(const IntrusivePtr& other) noexcept : IntrusivePtr(other.ptr_) {}
+
+    IntrusivePtr(IntrusivePtr&& other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {}
+
+    template <typename U>
+    IntrusivePtr(const IntrusivePtr<U>& other) noexcept : IntrusivePtr(other.get()) {}
+
+    template <typename U>
+    IntrusivePtr(IntrusivePtr<U>&& other) noexcept : ptr_(other.detach()) {}
+
+    ~IntrusivePtr() {
+        if (ptr_) {
+            ptr_->intrusiveRelease();
+        }
+    }
+
+    // 指向同一个对象时什么都不做，省掉一对加减
+    IntrusivePtr& operator=(const IntrusivePtr& other) noexcept {
+        if (ptr_ != other.ptr_) {
+            IntrusivePtr(other).swap(*this);
+        }
+        return *this;
+    }
+
+    IntrusivePtr& operator=(IntrusivePtr&& other) noexcept {
+        IntrusivePtr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void reset() noexcept { IntrusivePtr().swap(*this); }
+
+    void swap(IntrusivePtr& other) noexcept { std::swap(ptr_, other.ptr_); }
+
+    // 交出所有权但不减计数，之后要用 AdoptRef 接回来
+    T* detach() noexcept { return std::exchange(ptr_, nullptr); }
+
+    T* get() const noexcept { return ptr_; }
+    T& operator*() const noexcept { return *ptr_; }
+    T* operator->() const noexcept { return ptr_; }
+    explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+    uint32_t useCount() const noexcept { return ptr_ ? ptr_->refCount() : 0; }
+
+    friend bool operator==(const IntrusivePtr& a, const IntrusivePtr& b) noexcept { return a.ptr_ == b.ptr_; }
+    friend bool operator==(const IntrusivePtr& a, std::nullptr_t) noexcept { return a.ptr_ == nullptr; }
+
+private:
+    template <typename>
+    friend class IntrusiveWeakPtr;
+
+    T* ptr_ = nullptr;
+};
+
+template <typename T, typename... Args>
+IntrusivePtr<T> makeIntrusive(Args&&... args) {
+    return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+// T 必须继承 WeakRefCounted<T>
+template <typename T>
+class IntrusiveWeakPtr {
+    using Policy = typename T::RefPolicy;
+    using Anchor = typename T::WeakAnchor;
+
+public:
+    IntrusiveWeakPtr() noexcept = default;
+
+    IntrusiveWeakPtr(const IntrusivePtr<T>& strong) : anchor_(strong ? strong->acquireAnchor() : nullptr) {}
+
+    IntrusiveWeakPtr(const IntrusiveWeakPtr& other) noexcept : anchor_(other.anchor_) {
+        if (anchor_) {
+            T::addAnchorRef(anchor_);
+        }
+    }
+
+    IntrusiveWeakPtr(IntrusiveWeakPtr&& other) noexcept : anchor_(std::exchange(other.anchor_, nullptr)) {}
+
+    ~IntrusiveWeakPtr() {
+        if (anchor_) {
+            T::releaseAnchor(anchor_);
+        }
+    }
+
+    IntrusiveWeakPtr& operator=(IntrusiveWeakPtr other) noexcept {
+        std::swap(anchor_, other.anchor_);
+        return *this;
+    }
+
+    void reset() noexcept { IntrusiveWeakPtr().swap(*this); }
+
+    void swap(IntrusiveWeakPtr& other) noexcept { std::swap(anchor_, other.anchor_); }
+
+    // 对象还活着就返回一个强引用，否则返回空
+    IntrusivePtr<T> lock() const noexcept {
+        if (!anchor_) {
+            return {};
+        }
+        std::lock_guard<typename Policy::Lock> guard(anchor_->lock);
+        T* object = anchor_->object;
+        if (object && Policy::incrementIfNonZero(object->refs_)) {
+            return IntrusivePtr<T>(object, AdoptRef{});
+        }
+        return {};
+    }
+
+    bool expired() const noexcept {
+        if (!anchor_) {
+            return true;
+        }
+        std::lock_guard<typename Policy::Lock> guard(anchor_->lock);
+        return anchor_->object == nullptr;
+    }
+
+private:
+    Anchor* anchor_ = nullptr;
+};
+
+#endif //HANDS_ON_CPP_INTRUSIVE_PTR_H
@@ -0,0 +1,467 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#include "logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+using log_detail::LogBuffer;
+using log_detail::RecordHeader;
+
+namespace {
+
+constexpr int kStdout = 1;
+constexpr int kStderr = 2;
+
+// 一次 writev 最多交出的块数，POSIX 保证 IOV_MAX 至少 16，Linux 是 1024
+constexpr size_t kMaxIov = 16;
+
+size_t roundUpPowerOfTwo(size_t n) {
+    size_t result = 4096;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+void writeFully(int fd, const char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        const int n = _write(fd, data, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+#else
+        const ssize_t n = ::write(fd, data, size);
+#endif
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;  // 输出坏了没有地方可以报告，丢掉
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+// 把 chunks[0, count) 写到 fd，每次 writev 最多 kMaxIov 块，处理部分写入；返回系统调用次数
+uint64_t writeChunks(int fd, const std::vector<std::string>& chunks, size_t count) {
+    uint64_t calls = 0;
+#ifdef _WIN32
+    for (size_t i = 0; i < count; ++i) {
+        writeFully(fd, chunks[i].data(), chunks[i].size());
+        ++calls;
+    }
+#else
+    iovec iov[kMaxIov];
+    size_t next = 0;
+    while (next < count) {
+        size_t n = 0;
+        for (; n < kMaxIov && next + n < count; ++n) {
+            iov[n].iov_base = const_cast<char*>(chunks[next + n].data());
+            iov[n].iov_len = chunks[next + n].size();
+        }
+        next += n;
+        size_t first = 0;
+        while (first < n) {
+            const ssize_t written = ::writev(fd, iov + first, static_cast<int>(n - first));
+            ++calls;
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return calls;
+            }
+            // 部分写入：跳过已经写完的块，调整第一块的起点
+            auto remaining = static_cast<size_t>(written);
+            while (first < n && remaining >= iov[first].iov_len) {
+                remaining -= iov[first].iov_len;
+                ++first;
+            }
+            if (first < n) {
+                iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + remaining;
+                iov[first].iov_len -= remaining;
+            }
+        }
+    }
+#endif
+    return calls;
+}
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug:
+            return "D";
+        case LogLevel::Info:
+            return "I";
+        case LogLevel::Warn:
+            return "W";
+        case LogLevel::Error:
+            return "E";
+        default:
+            return "?";
+    }
+}
+
+// 线程退出时标记自己的缓冲，后台线程写完后释放；同时清掉 Logger 里缓存的指针，
+// 之后这个线程（比如主线程的静态析构）再写日志会重新走慢路径
+struct ThreadSlot {
+    std::shared_ptr<LogBuffer> buffer;
+    LogBuffer** cached = nullptr;
+
+    ~ThreadSlot() {
+        if (buffer) {
+            buffer->close();
+            *cached = nullptr;
+        }
+    }
+};
+
+thread_local ThreadSlot t_slot;
+
+// 同步写出和超长日志用的临时空间
+std::vector<char>& syncScratch() {
+    thread_local std::vector<char> scratch;
+    return scratch;
+}
+
+}  // namespace
+
+Logger::Logger() {
+    out_.fd = kStdout;
+    err_.fd = kStderr;
+    std::atexit([]() { Logger::instance().shutdown(); });
+}
+
+void Logger::start(const LoggerOptions& options) {
+    std::lock_guard<std::mutex> lock(start_mutex_);
+    startLocked(options);
+}
+
+void Logger::startLocked(const LoggerOptions& options) {
+    stopBackend();
+    closeFile();
+    options_ = options;
+    options_.buffer_bytes = roundUpPowerOfTwo(options_.buffer_bytes);
+    options_.chunk_bytes = std::max<size_t>(options_.chunk_bytes, 4096);
+    out_.fd = kStdout;
+    err_.fd = kStderr;
+    if (!options_.path.empty()) {
+#ifdef _WIN32
+        const int fd = _open(options_.path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+        const int fd = ::open(options_.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+        if (fd >= 0) {
+            out_.fd = err_.fd = fd;
+            owns_file_ = true;
+        }
+    }
+    overflow_.store(options_.overflow, std::memory_order_relaxed);
+    start_ticks_ = now();
+    start_nanos_ = steadyNanos();
+    shut_down_ = false;
+    {
+        std::lock_guard<std::mutex> state_lock(state_mutex_);
+        stop_ = false;
+    }
+    running_.store(true, std::memory_order_release);
+    backend_ = std::thread(&Logger::backendLoop, this);
+}
+
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    if (!running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    const uint64_t target = ++flush_requested_;
+    backend_cv_.notify_one();
+    flush_cv_.wait(lock, [&]() { return flush_done_ >= target || stop_; });
+}
+
+void Logger::shutdown() {
+    std::lock_guard<std::mutex> lock(start_mutex_);
+    stopBackend();
+    closeFile();
+    shut_down_ = true;
+    // 还活着的线程可能仍然拿着自己的缓冲，只释放已经退出的线程的
+    std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+    std::erase_if(buffers_, [this](const std::shared_ptr<LogBuffer>& buffer) {
+        if (!buffer->closed()) {
+            return false;
+        }
+        retired_dropped_ += buffer->dropped.load(std::memory_order_relaxed);
+        retired_blocked_ += buffer->blocked.load(std::memory_order_relaxed);
+        return true;
+    });
+    buffers_.shrink_to_fit();
+    // Logger 本身永远不析构，输出块和快照在这里释放，退出时的泄漏报告里就不会有它们
+    snapshot_.shrink_to_fit();
+    for (Sink* sink : {&out_, &err_}) {
+        sink->chunks.clear();
+        sink->chunks.shrink_to_fit();
+    }
+}
+
+LoggerStats Logger::stats() const {
+    LoggerStats result;
+    result.records = records_.load(std::memory_order_relaxed);
+    result.bytes = bytes_.load(std::memory_order_relaxed);
+    result.writes = writes_.load(std::memory_order_relaxed);
+    result.sync = sync_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    result.dropped = retired_dropped_;
+    result.blocked = retired_blocked_;
+    for (const auto& buffer : buffers_) {
+        result.dropped += buffer->dropped.load(std::memory_order_relaxed);
+        result.blocked += buffer->blocked.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+char* Logger::reserveSlow(size_t size, bool& sync) {
+    LogBuffer* buffer = t_buffer_;
+    if (!buffer) {
+        buffer = registerThread();
+    }
+    if (buffer && running_.load(std::memory_order_acquire) && size <= buffer->capacity() / 2) {
+        if (char* p = buffer->reserve(size)) {
+            return p;
+        }
+        if (overflow_.load(std::memory_order_relaxed) == OverflowPolicy::Drop) {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        buffer->blocked.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(state_mutex_);
+            wake_ = true;
+        }
+        backend_cv_.notify_one();
+        while (running_.load(std::memory_order_acquire)) {
+            if (char* p = buffer->reserve(size)) {
+                return p;
+            }
+            std::this_thread::yield();
+        }
+    }
+    sync = true;
+    std::vector<char>& scratch = syncScratch();
+    scratch.resize(size);
+    return scratch.data();
+}
+
+LogBuffer* Logger::registerThread() {
+    size_t capacity = 0;
+    {
+        std::lock_guard<std::mutex> lock(start_mutex_);
+        if (shut_down_) {
+            return nullptr;
+        }
+        if (!running_.load(std::memory_order_acquire)) {
+            startLocked(options_);  // 第一条日志：用默认配置启动
+        }
+        capacity = options_.buffer_bytes;
+    }
+    std::shared_ptr<LogBuffer> buffer;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        buffer = std::make_shared<LogBuffer>(capacity, next_thread_index_++);
+        buffers_.push_back(buffer);
+    }
+    t_slot.buffer = buffer;
+    t_slot.cached = &t_buffer_;
+    t_buffer_ = buffer.get();
+    return t_buffer_;
+}
+
+void Logger::writeSync(const RecordHeader& header) {
+    std::string text;
+    appendRecord(header, t_buffer_ ? t_buffer_->threadIndex() : 0, text);
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    writeFully(header.level >= LogLevel::Warn ? err_.fd : out_.fd, text.data(), text.size());
+    sync_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Logger::appendRecord(const RecordHeader& header, uint32_t thread_index, std::string& out) const {
+    if (options_.header) {
+        const uint64_t ticks = header.timestamp > start_ticks_ ? header.timestamp - start_ticks_ : 0;
+        const auto elapsed =
+            static_cast<uint64_t>(static_cast<double>(ticks) * nanos_per_tick_.load(std::memory_order_relaxed));
+        char prefix[64];
+        char* p = prefix;
+        *p++ = '[';
+        p = std::to_chars(p, prefix + sizeof(prefix), elapsed / 1'000'000'000).ptr;
+        *p++ = '.';
+        const uint64_t micros = elapsed / 1000 % 1'000'000;
+        for (uint64_t scale = 100'000; scale > 0; scale /= 10) {
+            *p++ = static_cast<char>('0' + micros / scale % 10);
+        }
+        *p++ = ' ';
+        *p++ = *levelName(header.level);
+        *p++ = ' ';
+        *p++ = 'T';
+        p = std::to_chars(p, prefix + sizeof(prefix), thread_index).ptr;
+        *p++ = ']';
+        *p++ = ' ';
+        out.append(prefix, p);
+    }
+    header.format_fn(out, header.format, reinterpret_cast<const char*>(&header + 1));
+    out += '\n';
+}
+
+void Logger::backendLoop() {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    for (;;) {
+        const uint64_t target = flush_requested_;
+        const bool stopping = stop_;
+        lock.unlock();
+        const bool more = drain(options_.chunk_bytes * 16);
+        lock.lock();
+        if (more) {
+            continue;
+        }
+        // 这一轮把开始时所有已提交的日志都写完了
+        if (target > flush_done_) {
+            flush_done_ = target;
+            flush_cv_.notify_all();
+        }
+        if (stopping) {
+            return;
+        }
+        backend_cv_.wait_for(lock, options_.poll_interval,
+                             [this]() { return stop_ || wake_ || flush_requested_ > flush_done_; });
+        wake_ = false;
+    }
+}
+
+void Logger::stopBackend() {
+    if (!backend_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        stop_ = true;
+    }
+    backend_cv_.notify_one();
+    backend_.join();
+    running_.store(false, std::memory_order_release);
+    // 后台线程退出后调用线程是唯一的消费者，写完停止前最后一刻提交的日志
+    while (drain(options_.chunk_bytes * 16)) {
+    }
+    flush_cv_.notify_all();
+}
+
+bool Logger::drain(size_t max_bytes) {
+    if (options_.header) {
+        const uint64_t ticks = now() - start_ticks_;
+        if (ticks > 0) {
+            nanos_per_tick_.store(static_cast<double>(steadyNanos() - start_nanos_) / static_cast<double>(ticks),
+                                  std::memory_order_relaxed);
+        }
+    }
+    snapshot_.clear();
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        snapshot_.assign(buffers_.begin(), buffers_.end());
+    }
+
+    out_.used = 0;
+    err_.used = 0;
+    size_t total = 0;
+    uint64_t records = 0;
+    bool more = false;
+    for (;;) {
+        // 按时间戳归并：取各个缓冲队头最早的一条
+        LogBuffer* earliest = nullptr;
+        const RecordHeader* record = nullptr;
+        for (const auto& buffer : snapshot_) {
+            if (const RecordHeader* head = buffer->peek()) {
+                if (!record || head->timestamp < record->timestamp) {
+                    record = head;
+                    earliest = buffer.get();
+                }
+            }
+        }
+        if (!record) {
+            break;
+        }
+        Sink& sink = record->level >= LogLevel::Warn ? err_ : out_;
+        if (sink.used == sink.chunks.size()) {
+            sink.chunks.emplace_back().reserve(options_.chunk_bytes + 1024);
+        }
+        std::string& chunk = sink.chunks[sink.used];
+        const size_t before = chunk.size();
+        appendRecord(*record, earliest->threadIndex(), chunk);
+        total += chunk.size() - before;
+        ++records;
+        earliest->pop(record);
+        if (chunk.size() >= options_.chunk_bytes) {
+            ++sink.used;
+        }
+        if (total >= max_bytes) {
+            more = true;
+            break;
+        }
+    }
+    writeSinks();
+    records_.fetch_add(records, std::memory_order_relaxed);
+    bytes_.fetch_add(total, std::memory_order_relaxed);
+
+    // 线程已经退出、内容也写完的缓冲可以释放了
+    if (!more) {
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        std::erase_if(buffers_, [this](const std::shared_ptr<LogBuffer>& buffer) {
+            if (!buffer->closed() || !buffer->empty()) {
+                return false;
+            }
+            retired_dropped_ += buffer->dropped.load(std::memory_order_relaxed);
+            retired_blocked_ += buffer->blocked.load(std::memory_order_relaxed);
+            return true;
+        });
+    }
+    snapshot_.clear();
+    return more;
+}
+
+void Logger::writeSinks() {
+    for (Sink* sink : {&out_, &err_}) {
+        // 最后一块可能没写满，也要写出
+        size_t count = sink->used;
+        if (count < sink->chunks.size() && !sink->chunks[count].empty()) {
+            ++count;
+        }
+        if (count == 0) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(sync_mutex_);
+        writes_.fetch_add(writeChunks(sink->fd, sink->chunks, count), std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+            sink->chunks[i].clear();
+        }
+        sink->used = 0;
+    }
+}
+
+void Logger::closeFile() {
+    if (owns_file_) {
+#ifdef _WIN32
+        _close(out_.fd);
+#else
+        ::close(out_.fd);
+#endif
+        owns_file_ = false;
+    }
+    out_.fd = kStdout;
+    err_.fd = kStderr;
+}
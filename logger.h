@@ -0,0 +1,496 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_LOGGER_H
+#define HANDS_ON_CPP_LOGGER_H
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "cache_line.h"
+#include "singleton.h"
+
+// ==================== 异步日志 ====================
+// 示例里到处是 std::cout << ... << std::endl：每条都要拿流的锁、在调用线程里格式化，endl 还要 flush 一次系统调用，
+// 打印花的时间比示例本身的工作还多。Logger 把这些都挪出调用线程：
+// - 每个线程一个无锁的单生产者/单消费者环形缓冲。日志调用只写入格式串指针、时间戳和参数的二进制拷贝，
+//   不格式化、不加锁、没有系统调用
+// - 后台线程轮询所有缓冲，按时间戳归并，格式化成文本攒成大块，一次 writev 写出
+// - 级别在编译期过滤：低于 HANDS_ON_CPP_LOG_LEVEL 的 LOG_xxx 整条语句被丢掉，参数也不会求值
+// - 缓冲满了按 OverflowPolicy 处理：Block 等后台线程腾出空间（默认，不丢日志），Drop 丢掉并计数
+// 格式串用 {} 占位（{{ 和 }} 输出花括号），占位符个数在编译期检查。参数支持算术类型、
+// 字符串（const char*、std::string、std::string_view，内容会被拷贝）、std::filesystem::path 和其他指针（打印地址）。
+// 同一个线程的日志保持顺序；不同线程之间按时间戳归并，只保证同一轮写出的日志之间的先后。
+// 和直接写 stdout 的输出交错时，先调用 flush()。进程退出时自动写完剩余日志，之后的日志同步写出；
+// 单条日志超过缓冲一半大小时也同步写。
+// 注意：<syslog.h> 也定义了 LOG_INFO/LOG_DEBUG，不要和本文件一起包含。
+
+#ifndef HANDS_ON_CPP_LOG_LEVEL
+#define HANDS_ON_CPP_LOG_LEVEL 1
+#endif
+
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off,
+};
+
+// 编译期的最低级别，0 到 4 依次对应 Debug/Info/Warn/Error/Off
+inline constexpr LogLevel kLogLevel = static_cast<LogLevel>(HANDS_ON_CPP_LOG_LEVEL);
+
+enum class OverflowPolicy {
+    Block,  // 等后台线程腾出空间
+    Drop,   // 丢掉这条日志，计入 LoggerStats::dropped
+};
+
+struct LoggerOptions {
+    std::string path;                               // 空表示标准输出（Warn 及以上写标准错误），否则写这个文件
+    size_t buffer_bytes = 1 << 20;                  // 每个线程的环形缓冲大小，向上取到 2 的幂
+    OverflowPolicy overflow = OverflowPolicy::Block;
+    bool header = false;                            // 每行前面加上 [启动后的秒数 级别 线程号]
+    std::chrono::microseconds poll_interval{500};   // 后台线程没事可做时的轮询间隔
+    size_t chunk_bytes = 64 * 1024;                 // 输出块的大小，一次 writev 写出多块
+};
+
+struct LoggerStats {
+    uint64_t records = 0;  // 后台线程写出的条数
+    uint64_t bytes = 0;    // 后台线程写出的字节数
+    uint64_t writes = 0;   // writev 调用次数
+    uint64_t dropped = 0;  // Drop 策略下丢掉的条数
+    uint64_t blocked = 0;  // Block 策略下等待过空间的次数
+    uint64_t sync = 0;     // 同步写出的条数
+};
+
+namespace log_detail {
+
+using FormatFn = void (*)(std::string& out, const char* format, const char* payload);
+
+// 缓冲里每条记录的头，后面紧跟参数；整条记录 8 字节对齐
+struct RecordHeader {
+    FormatFn format_fn;  // nullptr 表示填充，直接跳到缓冲开头
+    const char* format;
+    uint64_t timestamp;  // Logger::now() 的读数
+    uint32_t size;       // 整条记录的字节数，包括头
+    LogLevel level;
+};
+
+// 参数在缓冲里的存储方式：算术类型按值，字符串是 4 字节长度加内容，指针存地址
+template <typename T>
+struct Codec {
+    static size_t size(T) { return sizeof(T); }
+
+    static void encode(char*& p, T value) {
+        std::memcpy(p, &value, sizeof(T));
+        p += sizeof(T);
+    }
+
+    static void append(std::string& out, const char*& p) {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        if constexpr (std::is_same_v<T, bool>) {
+            out += value ? "true" : "false";
+        } else if constexpr (std::is_same_v<T, char>) {
+            out += value;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            // 和 iostream 默认一样：6 位有效数字
+            char digits[64];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+            out.append(digits, result.ptr);
+        } else {
+            char digits[64];
+            const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            out.append(digits, result.ptr);
+        }
+    }
+};
+
+template <>
+struct Codec<std::string_view> {
+    static size_t size(std::string_view s) { return sizeof(uint32_t) + s.size(); }
+
+    static void encode(char*& p, std::string_view s) {
+        const auto length = static_cast<uint32_t>(s.size());
+        std::memcpy(p, &length, sizeof(length));
+        std::memcpy(p + sizeof(length), s.data(), s.size());
+        p += sizeof(length) + s.size();
+    }
+
+    static void append(std::string& out, const char*& p) {
+        uint32_t length;
+        std::memcpy(&length, p, sizeof(length));
+        out.append(p + sizeof(length), length);
+        p += sizeof(length) + length;
+    }
+};
+
+template <>
+struct Codec<const void*> {
+    static size_t size(const void*) { return sizeof(uintptr_t); }
+
+    static void encode(char*& p, const void* pointer) {
+        const auto value = reinterpret_cast<uintptr_t>(pointer);
+        std::memcpy(p, &value, sizeof(value));
+        p += sizeof(value);
+    }
+
+    static void append(std::string& out, const char*& p) {
+        uintptr_t value;
+        std::memcpy(&value, p, sizeof(value));
+        p += sizeof(value);
+        char digits[2 + 2 * sizeof(uintptr_t)] = {'0', 'x'};
+        const auto result = std::to_chars(digits + 2, digits + sizeof(digits), value, 16);
+        out.append(digits, result.ptr);
+    }
+};
+
+// 调用方的参数类型（已经 decay）到存储方式的映射；不支持的类型在这里编译失败
+template <typename T, typename Enable = void>
+struct LogArg;
+
+template <typename T>
+struct LogArg<T, std::enable_if_t<std::is_arithmetic_v<T>>> {
+    using Stored = T;
+    static T prepare(T value) { return value; }
+};
+
+template <typename T>
+struct LogArg<T, std::enable_if_t<std::is_same_v<T, const char*> || std::is_same_v<T, char*>>> {
+    using Stored = std::string_view;
+    static std::string_view prepare(const char* s) { return s ? std::string_view(s) : std::string_view("(null)"); }
+};
+
+template <typename T>
+struct LogArg<T, std::enable_if_t<std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>>> {
+    using Stored = std::string_view;
+    static std::string_view prepare(std::string_view s) { return s; }
+};
+
+// POSIX 上直接用 native() 不拷贝；Windows 的 native() 是宽字符，转成 UTF-8 的临时 string，调用结束前一直有效
+template <>
+struct LogArg<std::filesystem::path> {
+    using Stored = std::string_view;
+
+    static auto prepare(const std::filesystem::path& path) {
+        if constexpr (std::is_same_v<std::filesystem::path::value_type, char>) {
+            return std::string_view(path.native());
+        } else {
+            return path.string();
+        }
+    }
+};
+
+template <typename T>
+struct LogArg<T*, std::enable_if_t<!std::is_same_v<std::remove_cv_t<T>, char>>> {
+    using Stored = const void*;
+    static const void* prepare(const T* pointer) { return pointer; }
+};
+
+// 把 format 里下一个占位符之前的文字追加到 out，越过占位符；返回是否找到占位符
+inline bool appendLiteral(std::string& out, const char*& format) {
+    const char* p = format;
+    while (*p) {
+        if (p[0] == '{' && p[1] == '}') {
+            out.append(format, p);
+            format = p + 2;
+            return true;
+        }
+        if ((p[0] == '{' && p[1] == '{') || (p[0] == '}' && p[1] == '}')) {
+            out.append(format, p + 1);
+            p += 2;
+            format = p;
+            continue;
+        }
+        ++p;
+    }
+    out.append(format, p);
+    format = p;
+    return false;
+}
+
+// 后台线程调用：按参数类型依次解码，和格式串里的文字交替拼接
+template <typename... Stored>
+void formatRecord(std::string& out, const char* format, const char* payload) {
+    ((appendLiteral(out, format), Codec<Stored>::append(out, payload)), ...);
+    appendLiteral(out, format);
+}
+
+consteval size_t countPlaceholders(const char* s) {
+    size_t count = 0;
+    for (; *s; ++s) {
+        if (s[0] == '{' && s[1] == '}') {
+            ++count;
+            ++s;
+        } else if ((s[0] == '{' && s[1] == '{') || (s[0] == '}' && s[1] == '}')) {
+            ++s;
+        }
+    }
+    return count;
+}
+
+// 单生产者/单消费者的字节环形缓冲。head_/tail_ 是一直增长的字节计数，取模得到位置。
+// 一条记录总是连续存放：缓冲末尾放不下时，剩下的部分作为填充和记录一起提交，记录从开头写起。
+// 末尾不到一个头大小的零头不写填充头，消费者看到这么短的尾巴直接跳过
+class LogBuffer {
+public:
+    LogBuffer(size_t capacity, uint32_t thread_index)
+        : capacity_(capacity), mask_(capacity - 1), data_(new char[capacity]), thread_index_(thread_index) {}
+
+    LogBuffer(const LogBuffer&) = delete;
+    LogBuffer& operator=(const LogBuffer&) = delete;
+
+    // 生产者：预留 size 字节（8 的倍数）的连续空间，放不下时返回 nullptr。写完后调用 commit()
+    char* reserve(size_t size) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t offset = tail & mask_;
+        const size_t contiguous = capacity_ - offset;
+        const size_t padding = contiguous < size ? contiguous : 0;
+        const uint64_t end = tail + padding + size;
+        if (end - head_cache_ > capacity_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (end - head_cache_ > capacity_) {
+                return nullptr;
+            }
+        }
+        if (padding >= sizeof(RecordHeader)) {
+            ::new (static_cast<void*>(data_.get() + offset)) RecordHeader{nullptr, nullptr, 0, 0, LogLevel::Off};
+        }
+        reserved_end_ = end;
+        return data_.get() + ((end - size) & mask_);
+    }
+
+    void commit() { tail_.store(reserved_end_, std::memory_order_release); }
+
+    // 消费者：下一条记录，没有时返回 nullptr；处理完调用 pop()
+    const RecordHeader* peek() {
+        for (;;) {
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_cache_) {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+                if (head == tail_cache_) {
+                    return nullptr;
+                }
+            }
+            const size_t offset = head & mask_;
+            const size_t contiguous = capacity_ - offset;
+            if (contiguous >= sizeof(RecordHeader)) {
+                const auto* header = reinterpret_cast<const RecordHeader*>(data_.get() + offset);
+                if (header->format_fn) {
+                    return header;
+                }
+            }
+            head_.store(head + contiguous, std::memory_order_release);
+        }
+    }
+
+    void pop(const RecordHeader* header) {
+        head_.store(head_.load(std::memory_order_relaxed) + header->size, std::memory_order_release);
+    }
+
+    bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+    size_t capacity() const { return capacity_; }
+    uint32_t threadIndex() const { return thread_index_; }
+
+    // 线程退出时标记，后台线程写完剩余内容后释放
+    void close() { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // 只有生产者写，后台线程汇总时读
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> blocked{0};
+
+private:
+    const size_t capacity_;
+    const size_t mask_;
+    const std::unique_ptr<char[]> data_;
+    const uint32_t thread_index_;
+    std::atomic<bool> closed_{false};
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> tail_{0};
+    uint64_t head_cache_ = 0;    // 生产者看到的 head_，空间不够时才重新读
+    uint64_t reserved_end_ = 0;
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> head_{0};
+    uint64_t tail_cache_ = 0;    // 消费者看到的 tail_，读空了才重新读
+};
+
+}  // namespace log_detail
+
+// 格式串：构造在编译期进行，占位符个数和参数个数不一致时编译失败
+template <typename... Args>
+struct LogFormat {
+    template <size_t N>
+    consteval LogFormat(const char (&s)[N]) : text(s) {
+        if (log_detail::countPlaceholders(s) != sizeof...(Args)) {
+            throw "日志格式串里 {} 的个数和参数个数不一致";
+        }
+    }
+
+    const char* text;
+};
+
+class Logger {
+public:
+    Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // 进程里唯一的实例，永远不析构；进程退出时自动 shutdown()
+    static Logger& instance() { return Singleton<Logger>::instance(); }
+
+    // 按 options 配置并启动后台线程；第一条日志会用默认配置自动启动。
+    // 已经启动时先写完已有的日志再按新配置重启；已经存在的线程缓冲保持原来的大小
+    void start(const LoggerOptions& options);
+
+    // 等到调用之前提交的日志全部写出
+    void flush();
+
+    // 写完所有日志并停止后台线程，之后的日志同步写出
+    void shutdown();
+
+    LoggerStats stats() const;
+
+    template <typename... Stored>
+    void write(LogLevel level, const char* format, const Stored&... values) {
+        const size_t payload = (size_t{0} + ... + log_detail::Codec<Stored>::size(values));
+        const size_t size = (sizeof(log_detail::RecordHeader) + payload + 7) & ~size_t{7};
+        log_detail::LogBuffer* buffer = t_buffer_;
+        char* p = nullptr;
+        if (buffer && running_.load(std::memory_order_relaxed)) [[likely]] {
+            p = buffer->reserve(size);
+        }
+        bool sync = false;
+        if (!p) [[unlikely]] {
+            p = reserveSlow(size, sync);
+            if (!p) {
+                return;
+            }
+        }
+        auto* header = ::new (static_cast<void*>(p)) log_detail::RecordHeader{
+            &log_detail::formatRecord<Stored...>, format, now(), static_cast<uint32_t>(size), level};
+        char* out = p + sizeof(log_detail::RecordHeader);
+        (log_detail::Codec<Stored>::encode(out, values), ...);
+        if (sync) {
+            writeSync(*header);
+        } else {
+            t_buffer_->commit();
+        }
+    }
+
+private:
+    struct Sink {
+        int fd = -1;
+        std::vector<std::string> chunks;  // 复用，清空时保留容量
+        size_t used = 0;                  // 已经用到的块数（最后一块可能没写满）
+    };
+
+    // 时间戳只用来归并排序和算行首的相对时间。x86 上直接读 TSC，比 steady_clock::now() 便宜得多
+    //（日志调用的一半时间花在读时钟上），其他平台用 steady_clock 的纳秒数
+    static uint64_t now() {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        return __builtin_ia32_rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    static uint64_t steadyNanos() {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+    }
+
+    // 缓冲满、当前线程还没有缓冲、后台线程没在运行时走这里。返回 nullptr 表示丢弃；
+    // sync 为 true 时返回的是线程局部的临时空间，记录写好后同步写出
+    char* reserveSlow(size_t size, bool& sync);
+    log_detail::LogBuffer* registerThread();
+    void startLocked(const LoggerOptions& options);
+    void writeSync(const log_detail::RecordHeader& header);
+
+    void backendLoop();
+    void stopBackend();
+    // 写出当前所有缓冲里的日志；输出攒够 max_bytes 就先返回 true，表示还有没写完的
+    bool drain(size_t max_bytes);
+    void appendRecord(const log_detail::RecordHeader& header, uint32_t thread_index, std::string& out) const;
+    void writeSinks();
+    void closeFile();
+
+    static inline thread_local log_detail::LogBuffer* t_buffer_ = nullptr;
+
+    alignas(kCacheLineSize) std::atomic<bool> running_{false};
+    std::atomic<OverflowPolicy> overflow_{OverflowPolicy::Block};
+
+    alignas(kCacheLineSize) std::mutex start_mutex_;  // start/shutdown 互斥
+    LoggerOptions options_;
+    bool shut_down_ = false;
+    bool owns_file_ = false;
+    uint64_t start_ticks_ = 0;       // 启动时的 now() 和 steady_clock，用来把时间戳换算成秒
+    uint64_t start_nanos_ = 0;
+    std::atomic<double> nanos_per_tick_{1.0};  // 后台线程每轮重新估计
+    std::thread backend_;
+
+    mutable std::mutex registry_mutex_;
+    std::vector<std::shared_ptr<log_detail::LogBuffer>> buffers_;
+    uint32_t next_thread_index_ = 0;
+    uint64_t retired_dropped_ = 0;  // 已经释放的缓冲上的计数
+    uint64_t retired_blocked_ = 0;
+
+    std::mutex state_mutex_;  // 保护下面的唤醒和 flush 状态
+    std::condition_variable backend_cv_;
+    std::condition_variable flush_cv_;
+    bool stop_ = false;
+    bool wake_ = false;
+    uint64_t flush_requested_ = 0;
+    uint64_t flush_done_ = 0;
+
+    // 只有消费者（后台线程，或者停止后的调用线程）访问
+    std::vector<std::shared_ptr<log_detail::LogBuffer>> snapshot_;
+    Sink out_;
+    Sink err_;
+
+    std::mutex sync_mutex_;  // 同步写出时互斥
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> writes_{0};
+    std::atomic<uint64_t> sync_{0};
+};
+
+template <typename... Args>
+void logWrite(LogLevel level, LogFormat<std::type_identity_t<Args>...> format, const Args&... args) {
+    Logger::instance().write<typename log_detail::LogArg<std::decay_t<Args>>::Stored...>(
+        level, format.text, log_detail::LogArg<std::decay_t<Args>>::prepare(args)...);
+}
+
+// 级别低于 kLogLevel 时整条语句在编译期丢掉，参数不求值
+#define HANDS_ON_CPP_LOG(level, ...)              \
+    do {                                          \
+        if constexpr ((level) >= kLogLevel) {     \
+            logWrite((level), __VA_ARGS__);       \
+        }                                         \
+    } while (0)
+
+#define LOG_DEBUG(...) HANDS_ON_CPP_LOG(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) HANDS_ON_CPP_LOG(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...) HANDS_ON_CPP_LOG(LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) HANDS_ON_CPP_LOG(LogLevel::Error, __VA_ARGS__)
+
+#endif //HANDS_ON_CPP_LOGGER_H
@@ -0,0 +1,170 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 每条日志调用在调用线程里花的时间：std::cout << ... << std::endl vs Logger。
+// 日志内容和 createNestedDirectories 的一样：一个目录路径加一个深度。两种写法都写到临时文件
+// （cout 把 fd 1 dup2 到文件，Logger 用 LoggerOptions::path），比较的不是终端的显示速度。
+// 每次调用单独计时（已扣除计时本身的开销），报告中位数、p99、p99.9 和最大值，
+// 以及从第一条到全部写进文件的总时间（Logger 包括最后的 flush）。
+// Logger 的后台线程和调用线程抢同一批 CPU：核少时 Block 策略的尾延迟里包括等后台线程腾空间的时间，
+// Drop 策略不等，但会丢日志。
+// 用法：logger_bench [每个线程的条数]，默认 20 万
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "logger.h"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    std::vector<uint32_t> samples;  // 每次调用的纳秒数
+    double total_ms = 0;
+    uint64_t dropped = 0;
+    uint64_t blocked = 0;
+};
+
+uint64_t g_timer_overhead = 0;
+
+// 连续两次读时钟的中位间隔
+uint64_t measureTimerOverhead() {
+    std::vector<uint64_t> samples(100'000);
+    for (auto& sample : samples) {
+        const auto start = Clock::now();
+        const auto end = Clock::now();
+        sample = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+// 每个线程写 count 条，每条调用 log(path, depth) 并计时
+template <typename LogFn>
+Result runThreads(unsigned threads, size_t count, LogFn log) {
+    std::vector<std::vector<uint32_t>> samples(threads);
+    auto worker = [&](unsigned t) {
+        std::vector<uint32_t>& local = samples[t];
+        local.resize(count);
+        const std::string base = "/tmp/hands_on_cpp_tree/" + std::to_string(t + 1);
+        std::string path;
+        for (size_t i = 0; i < count; ++i) {
+            path = base;
+            path += '/';
+            path += std::to_string(i % 9 + 1);
+            path += '/';
+            path += std::to_string(i % 7 + 1);
+            const auto start = Clock::now();
+            log(path, static_cast<int>(i % 6 + 1));
+            const auto end = Clock::now();
+            const auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            local[i] = static_cast<uint32_t>(std::min<uint64_t>(ns > g_timer_overhead ? ns - g_timer_overhead : 0, UINT32_MAX));
+        }
+    };
+
+    Result result;
+    const auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+        workers.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& w : workers) {
+        w.join();
+    }
+    result.total_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    for (auto& local : samples) {
+        result.samples.insert(result.samples.end(), local.begin(), local.end());
+    }
+    return result;
+}
+
+Result runIostream(unsigned threads, size_t count, const fs::path& file, bool flush_each) {
+    std::cout.flush();
+    const int saved = dup(STDOUT_FILENO);
+    const int fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+
+    const auto start = Clock::now();
+    Result result = runThreads(threads, count, [flush_each](const std::string& path, int depth) {
+        if (flush_each) {
+            std::cout << "创建目录: " << path << " 深度 " << depth << std::endl;
+        } else {
+            std::cout << "创建目录: " << path << " 深度 " << depth << '\n';
+        }
+    });
+    std::cout.flush();
+    result.total_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    return result;
+}
+
+Result runLogger(unsigned threads, size_t count, const fs::path& file, OverflowPolicy overflow) {
+    LoggerOptions options;
+    options.path = file.string();
+    options.overflow = overflow;
+    Logger& logger = Logger::instance();
+    logger.start(options);
+    const LoggerStats before = logger.stats();
+
+    const auto start = Clock::now();
+    Result result = runThreads(threads, count, [](const std::string& path, int depth) {
+        LOG_INFO("创建目录: {} 深度 {}", path, depth);
+    });
+    logger.flush();
+    result.total_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    const LoggerStats after = logger.stats();
+    result.dropped = after.dropped - before.dropped;
+    result.blocked = after.blocked - before.blocked;
+    return result;
+}
+
+void printRow(const std::string& name, Result result) {
+    auto& s = result.samples;
+    std::sort(s.begin(), s.end());
+    auto at = [&s](double q) { return s[std::min(s.size() - 1, static_cast<size_t>(q * static_cast<double>(s.size())))]; };
+    std::cout << "  " << std::left << std::setw(28) << name << std::right << std::setw(8) << at(0.5) << std::setw(9)
+              << at(0.99) << std::setw(10) << at(0.999) << std::setw(11) << s.back() << std::fixed
+              << std::setprecision(1) << std::setw(11) << result.total_ms << std::setw(10) << result.dropped
+              << std::setw(10) << result.blocked << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::stoull(argv[1]) : 200'000;
+    const fs::path dir = fs::temp_directory_path();
+    const fs::path cout_file = dir / "hands_on_cpp_logger_bench_cout.txt";
+    const fs::path log_file = dir / "hands_on_cpp_logger_bench_log.txt";
+    g_timer_overhead = measureTimerOverhead();
+
+    std::cout << "每个线程 " << count << " 条，纳秒/次（已扣除计时开销 " << g_timer_overhead << " ns）" << std::endl;
+    std::cout << "  " << std::left << std::setw(28) << "写法" << std::right
+              << "  中位数     p99    p99.9     最大值   总毫秒      丢弃    等待" << std::endl;
+    for (unsigned threads : {1u, 4u}) {
+        const std::string suffix = "，" + std::to_string(threads) + " 线程";
+        printRow("cout + endl" + suffix, runIostream(threads, count, cout_file, true));
+        printRow("cout + '\\n'" + suffix, runIostream(threads, count, cout_file, false));
+        printRow("Logger Block" + suffix, runLogger(threads, count, log_file, OverflowPolicy::Block));
+        printRow("Logger Drop" + suffix, runLogger(threads, count, log_file, OverflowPolicy::Drop));
+    }
+    Logger::instance().shutdown();
+
+    std::error_code ec;
+    fs::remove(cout_file, ec);
+    fs::remove(log_file, ec);
+    return 0;
+}
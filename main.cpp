@@ -1,69 +1,369 @@
-#include <iostream>
 #include <filesystem>
 #include <string>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "fs_backend.h"
+#include "logger.h"
+#ifndef _WIN32
+#include "dir_fd.h"
+#include "mkdir_engine.h"
+#include "tree_scanner.h"
+#include "work_stealing_deque.h"
+#endif
 
 namespace fs = std::filesystem;
 
-void createNestedDirectories(const fs::path& base_path, int current_depth, int max_depth) {
-    if (current_depth > max_depth) {
-        return;
+// ==================== 并行目录生成器 ====================
+
+struct GeneratorOptions {
+    fs::path base_dir = fs::temp_directory_path() / "hands_on_cpp_tree";
+    int fan_out = 9;               // 每层的分支数
+    int max_depth = 3;             // 最大深度
+    unsigned threads = 0;          // 工作线程数，0 表示每个核心一个
+    unsigned queue_depth = 4096;   // --uring 模式下 io_uring 的队列大小
+    std::string backend = "disk";  // --serial 模式下的文件系统后端：disk、memory 或 null
+    bool quiet = false;            // 安静模式：不打印每个目录
+};
+
+struct GeneratorStats {
+    uint64_t created = 0;  // 新建的目录数
+    uint64_t existed = 0;  // 已存在（EEXIST）的目录数
+    uint64_t failed = 0;   // 失败的目录数
+    double seconds = 0.0;
+};
+
+#ifndef _WIN32
+
+// 一个任务：在 parent 目录下创建 fan_out 个子目录
+struct MkdirTask {
+    std::shared_ptr<DirFd> parent;
+    int depth;         // 子目录所在的深度
+    std::string path;  // 仅用于日志，安静模式下为空
+};
+
+class ParallelDirectoryGenerator {
+public:
+    explicit ParallelDirectoryGenerator(const GeneratorOptions& options) : options_(options) {
+        if (options_.threads == 0) {
+            options_.threads = std::max(1u, std::thread::hardware_concurrency());
+        }
     }
 
-    // 创建当前层的10个目录
-    for (int i = 1; i <= 9; ++i) {
-        fs::path dir_path = base_path / std::to_string(i);
+    GeneratorStats run() {
+        GeneratorStats stats;
+        std::error_code ec;
+        fs::create_directories(options_.base_dir, ec);  // 已存在时不算错误
 
-        try {
-            if (!fs::exists(dir_path)) {
-                if (fs::create_directory(dir_path)) {
-                    std::cout << "创建目录: " << dir_path << std::endl;
-                } else {
-                    std::cerr << "无法创建目录: " << dir_path << std::endl;
+        int base_fd = open(options_.base_dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (base_fd < 0) {
+            LOG_ERROR("无法打开基础目录: {}: {}", options_.base_dir, std::strerror(errno));
+            stats.failed = 1;
+            return stats;
+        }
+
+        queues_.clear();
+        for (unsigned i = 0; i < options_.threads; ++i) {
+            queues_.push_back(std::make_unique<WorkStealingDeque<MkdirTask>>());
+        }
+        worker_stats_.assign(options_.threads, GeneratorStats{});
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (options_.max_depth >= 1) {
+            pending_.store(1, std::memory_order_relaxed);
+            queues_[0]->push({std::make_shared<DirFd>(base_fd), 1,
+                              options_.quiet ? std::string() : options_.base_dir.string()});
+        } else {
+            close(base_fd);
+        }
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < options_.threads; ++i) {
+            workers.emplace_back(&ParallelDirectoryGenerator::workerLoop, this, i);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        stats.seconds = std::chrono::duration<double>(end - start).count();
+        for (const auto& local : worker_stats_) {
+            stats.created += local.created;
+            stats.existed += local.existed;
+            stats.failed += local.failed;
+        }
+        return stats;
+    }
+
+private:
+    void workerLoop(size_t id) {
+        GeneratorStats& local = worker_stats_[id];
+
+        // pending_ 在子任务入队之前加一、在任务处理完之后减一，所以只有全部完成时才会归零
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            std::optional<MkdirTask> task = queues_[id]->pop();
+            for (size_t k = 1; !task && k < queues_.size(); ++k) {
+                task = queues_[(id + k) % queues_.size()]->steal();
+            }
+            if (!task) {
+                std::this_thread::yield();
+                continue;
+            }
+            process(id, *task, local);
+            task.reset();  // 先释放父目录 fd，再宣布任务完成
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void process(size_t id, const MkdirTask& task, GeneratorStats& local) {
+        const int parent_fd = task.parent->get();
+
+        for (int i = 1; i <= options_.fan_out; ++i) {
+            const std::string name = std::to_string(i);
+
+            // 直接 mkdirat，EEXIST 视为成功，省掉一次 exists 的 stat
+            if (mkdirat(parent_fd, name.c_str(), 0755) == 0) {
+                ++local.created;
+            } else if (errno == EEXIST) {
+                ++local.existed;
+            } else {
+                ++local.failed;
+                reportError(task.path, name, "mkdirat");
+                continue;
+            }
+
+            std::string child_path;
+            if (!options_.quiet) {
+                child_path = task.path + '/' + name;
+                LOG_INFO("创建目录: {}", child_path);
+            }
+
+            if (task.depth < options_.max_depth) {
+                int fd = openat(parent_fd, name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (fd < 0) {
+                    ++local.failed;
+                    reportError(task.path, name, "openat");
                     continue;
                 }
+                pending_.fetch_add(1, std::memory_order_relaxed);
+                queues_[id]->push({std::make_shared<DirFd>(fd), task.depth + 1, std::move(child_path)});
             }
-
-            // 递归创建下一层
-            createNestedDirectories(dir_path, current_depth + 1, max_depth);
-        } catch (const fs::filesystem_error& e) {
-            std::cerr << "错误: " << e.what() << std::endl;
         }
     }
+
+    void reportError(const std::string& parent, const std::string& name, const char* op) {
+        LOG_ERROR("错误: {} {}/{}: {}", op, parent, name, std::strerror(errno));
+    }
+
+    GeneratorOptions options_;
+    std::vector<std::unique_ptr<WorkStealingDeque<MkdirTask>>> queues_;
+    std::vector<GeneratorStats> worker_stats_;
+    std::atomic<uint64_t> pending_{0};
+};
+
+int startParallel(const GeneratorOptions& options) {
+    LOG_INFO("开始并行创建目录结构: {}（分支数 {}，深度 {}）", options.base_dir, options.fan_out, options.max_depth);
+
+    ParallelDirectoryGenerator generator(options);
+    GeneratorStats stats = generator.run();
+
+    const uint64_t total = stats.created + stats.existed;
+    LOG_INFO("目录结构创建完成！新建 {}，已存在 {}，失败 {}，耗时 {} 秒，{} 目录/秒", stats.created, stats.existed,
+             stats.failed, stats.seconds, stats.seconds > 0 ? total / stats.seconds : 0.0);
+    return stats.failed == 0 ? 0 : 1;
 }
 
-int start() {
-    const fs::path base_dir = R"(C:\Users\Galaxy\workspace\test)";  // 基础目录名
-    const int max_depth = 3;                  // 最大深度6层
+// 单线程批量提交：io_uring 的 MKDIRAT，内核不支持时退回同步 mkdirat，见 mkdir_engine.h
+int startUring(const GeneratorOptions& options) {
+    LOG_INFO("开始批量创建目录结构: {}（分支数 {}，深度 {}）", options.base_dir, options.fan_out, options.max_depth);
 
-    try {
-        // 创建基础目录
-        if (!fs::exists(base_dir)) {
-            fs::create_directory(base_dir);
-        }
+    MkdirTreeOptions tree;
+    tree.base_dir = options.base_dir;
+    tree.fan_out = options.fan_out;
+    tree.max_depth = options.max_depth;
+    tree.queue_depth = options.queue_depth;
+    tree.log_each = !options.quiet;
+    const MkdirTreeStats stats = createTree(tree);
+
+    const uint64_t total = stats.created + stats.existed;
+    LOG_INFO("目录结构创建完成！新建 {}，已存在 {}，失败 {}，耗时 {} 秒，{} 目录/秒，{} 次系统调用（{}）", stats.created,
+             stats.existed, stats.failed, stats.seconds, stats.seconds > 0 ? total / stats.seconds : 0.0,
+             stats.syscalls, stats.used_uring ? "io_uring" : "mkdirat");
+    return stats.failed == 0 ? 0 : 1;
+}
+
+// 并行扫描基础目录，和 --fan-out/--depth 描述的形状比较，有差异时返回 1
+int startScan(const GeneratorOptions& options) {
+    LOG_INFO("开始扫描目录结构: {}（期望分支数 {}，深度 {}）", options.base_dir, options.fan_out, options.max_depth);
+
+    ScanOptions scan_options;
+    scan_options.threads = options.threads;
+    ScanStats stats;
+    const DirIndex index = scanTree(options.base_dir, scan_options, stats);
+    if (index.empty()) {
+        return 1;
+    }
+    LOG_INFO("扫描完成！{} 个条目，{} 个目录，{} 个错误，耗时 {} 秒，{} 条目/秒，索引 {} 字节（{} 个不同的名字）",
+             stats.entries, stats.directories, stats.errors, stats.seconds,
+             stats.seconds > 0 ? stats.entries / stats.seconds : 0.0, index.memoryBytes(), index.uniqueNames());
+
+    const TreeDiff diff = diffExpectedTree(index, options.fan_out, options.max_depth);
+    for (const std::string& path : diff.missing_paths) {
+        LOG_INFO("缺少: {}", path);
+    }
+    for (const std::string& path : diff.unexpected_paths) {
+        LOG_INFO("多出: {}", path);
+    }
+    LOG_INFO("期望 {} 个条目，缺少 {}，多出 {}", diff.expected, diff.missing, diff.unexpected);
+    return diff.matches() && stats.errors == 0 ? 0 : 1;
+}
+
+#else
+
+int startParallel(const GeneratorOptions&) {
+    LOG_ERROR("并行目录生成器依赖 mkdirat/openat，目前只支持 POSIX 系统");
+    return 1;
+}
+
+int startUring(const GeneratorOptions&) {
+    LOG_ERROR("批量目录生成器依赖 mkdirat，目前只支持 POSIX 系统");
+    return 1;
+}
+
+int startScan(const GeneratorOptions&) {
+    LOG_ERROR("目录扫描器依赖 openat/getdents64，目前只支持 POSIX 系统");
+    return 1;
+}
+
+#endif
 
-        std::cout << "开始创建目录结构..." << std::endl;
-        createNestedDirectories(base_dir, 1, max_depth);
-        std::cout << "目录结构创建完成！" << std::endl;
+// 单线程递归生成，文件系统操作交给 options.backend 选出的后端（见 fs_backend.h）
+int start(const GeneratorOptions& options) {
+    std::unique_ptr<FileSystemBackend> backend = makeBackend(options.backend);
+    if (!backend) {
+        LOG_ERROR("未知的文件系统后端: {}", options.backend);
+        return 1;
+    }
+
+    NestedTreeOptions tree;
+    tree.base_dir = options.base_dir;
+    tree.fan_out = options.fan_out;
+    tree.max_depth = options.max_depth;
+    tree.log_each = !options.quiet;
+
+    try {
+        LOG_INFO("开始创建目录结构: {}（后端 {}，分支数 {}，深度 {}）", options.base_dir, backend->name(),
+                 options.fan_out, options.max_depth);
+        const auto begin = std::chrono::steady_clock::now();
+        const uint64_t created = createNestedDirectories(*backend, tree);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        LOG_INFO("目录结构创建完成！新建 {}，耗时 {} 秒", created, seconds);
     } catch (const fs::filesystem_error& e) {
-        std::cerr << "主函数错误: " << e.what() << std::endl;
+        LOG_ERROR("主函数错误: {}", e.what());
         return 1;
     }
 
     return 0;
 }
 
+void printUsage(const char* program) {
+    LOG_INFO("用法: {} --parallel [--base DIR] [--fan-out N] [--depth N] [--threads N] [--quiet]", program);
+    LOG_INFO("      {} --uring [--base DIR] [--fan-out N] [--depth N] [--queue-depth N] [--quiet]", program);
+    LOG_INFO("      {} --scan [--base DIR] [--fan-out N] [--depth N] [--threads N]", program);
+    LOG_INFO("      {} --serial [--backend disk|memory|null] [--base DIR] [--fan-out N] [--depth N] [--quiet]", program);
+}
+
+// 解析命令行参数，失败时返回 std::nullopt
+std::optional<GeneratorOptions> parseGeneratorOptions(int argc, char* argv[]) {
+    GeneratorOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+
+        try {
+            if (arg == "--parallel" || arg == "--uring" || arg == "--scan" || arg == "--serial") {
+                continue;
+            } else if (arg == "--quiet") {
+                options.quiet = true;
+            } else if (arg == "--base") {
+                const char* value = next();
+                if (!value) return std::nullopt;
+                options.base_dir = value;
+            } else if (arg == "--fan-out") {
+                const char* value = next();
+                if (!value) return std::nullopt;
+                options.fan_out = std::stoi(value);
+            } else if (arg == "--depth") {
+                const char* value = next();
+                if (!value) return std::nullopt;
+                options.max_depth = std::stoi(value);
+            } else if (arg == "--threads") {
+                const char* value = next();
+                if (!value) return std::nullopt;
+                options.threads = static_cast<unsigned>(std::stoul(value));
+            } else if (arg == "--queue-depth") {
+                const char* value = next();
+                if (!value) return std::nullopt;
+                options.queue_depth = static_cast<unsigned>(std::stoul(value));
+            } else if (arg == "--backend") {
+                const char* value = next();
+                if (!value) return std::nullopt;
+                options.backend = value;
+            } else {
+                return std::nullopt;
+            }
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+    if (options.fan_out < 1 || options.max_depth < 0) {
+        return std::nullopt;
+    }
+    return options;
+}
+
 // TIP To <b>Run</b> code, press <shortcut actionId="Run"/> or click the <icon src="AllIcons.Actions.Execute"/> icon in the gutter.
-int main() {
+int main(int argc, char* argv[]) {
+    const std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--parallel" || mode == "--uring" || mode == "--scan" || mode == "--serial") {
+        auto options = parseGeneratorOptions(argc, argv);
+        if (!options) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (mode == "--scan") {
+            return startScan(*options);
+        }
+        if (mode == "--serial") {
+            return start(*options);
+        }
+        return mode == "--parallel" ? startParallel(*options) : startUring(*options);
+    }
+
     // TIP Press <shortcut actionId="RenameElement"/> when your caret is at the <b>lang</b> variable name to see how CLion can help you rename it.
     auto lang = "C++";
-    std::cout << "Hello and welcome to " << lang << "!\n";
+    LOG_INFO("Hello and welcome to {}!", lang);
 
     for (int i = 1; i <= 5; i++) {
         // TIP Press <shortcut actionId="Debug"/> to start debugging your code. We have set one <icon src="AllIcons.Debugger.Db_set_breakpoint"/> breakpoint for you, but you can always add more by pressing <shortcut actionId="ToggleLineBreakpoint"/>.
-        std::cout << "i = " << i << std::endl;
+        LOG_INFO("i = {}", i);
     }
 
-    // start();
+    // start(GeneratorOptions{});
 
     return 0;
     // TIP See CLion help at <a href="https://www.jetbrains.com/help/clion/">jetbrains.com/help/clion/</a>. Also, you can try interactive lessons for CLion by selecting 'Help | Learn IDE Features' from the main menu.
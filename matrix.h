@@ -0,0 +1,210 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_MATRIX_H
+#define HANDS_ON_CPP_MATRIX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// ==================== 连续存储的行主序矩阵 ====================
+// 和 int** 相比：只有一次（对齐的）分配，行与行首尾相接，遍历时硬件预取有效。
+// 可选把每行补齐到对齐边界（stride >= cols），这样每一行的起始地址都是对齐的，方便 SIMD。
+
+// 列视图：按 stride 跨行访问同一列
+template <typename T>
+class ColumnView {
+public:
+    ColumnView(T* first, size_t size, size_t stride) : first_(first), size_(size), stride_(stride) {}
+
+    T& operator[](size_t row) const { return first_[row * stride_]; }
+    size_t size() const { return size_; }
+
+private:
+    T* first_;
+    size_t size_;
+    size_t stride_;
+};
+
+template <typename T>
+class Matrix {
+    static_assert(std::is_trivially_destructible_v<T>, "Matrix 只用于数值类型");
+
+public:
+    Matrix() = default;
+
+    // alignment 必须是 2 的幂；pad_stride 为 true 时把每行补齐到 alignment 字节，并避开 4 KB 整数倍的行宽
+    Matrix(size_t rows, size_t cols, bool pad_stride = false, size_t alignment = 64)
+        : rows_(rows), cols_(cols), stride_(cols), alignment_(std::max(alignment, alignof(T))), pad_stride_(pad_stride) {
+        if ((alignment_ & (alignment_ - 1)) != 0) {
+            throw std::invalid_argument("Matrix 的对齐必须是 2 的幂");
+        }
+        if (pad_stride && alignment_ % sizeof(T) == 0) {
+            const size_t per_line = alignment_ / sizeof(T);
+            stride_ = (cols + per_line - 1) / per_line * per_line;
+            // 行宽正好是 4 KB 的倍数时，同一列的元素会落到同一个缓存组里互相驱逐，再多补一行缓存行
+            if ((stride_ * sizeof(T)) % 4096 == 0) {
+                stride_ += per_line;
+            }
+        }
+        const size_t count = rows_ * stride_;
+        if (count > 0) {
+            data_ = static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignment_)));
+            std::uninitialized_value_construct_n(data_, count);
+        }
+    }
+
+    ~Matrix() { release(); }
+
+    Matrix(const Matrix&) = delete;
+    Matrix& operator=(const Matrix&) = delete;
+
+    Matrix(Matrix&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          rows_(std::exchange(other.rows_, 0)),
+          cols_(std::exchange(other.cols_, 0)),
+          stride_(std::exchange(other.stride_, 0)),
+          alignment_(other.alignment_),
+          pad_stride_(other.pad_stride_) {}
+
+    Matrix& operator=(Matrix&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            rows_ = std::exchange(other.rows_, 0);
+            cols_ = std::exchange(other.cols_, 0);
+            stride_ = std::exchange(other.stride_, 0);
+            alignment_ = other.alignment_;
+            pad_stride_ = other.pad_stride_;
+        }
+        return *this;
+    }
+
+    T& operator()(size_t row, size_t col) { return data_[row * stride_ + col]; }
+    const T& operator()(size_t row, size_t col) const { return data_[row * stride_ + col]; }
+
+    T* rowData(size_t row) { return data_ + row * stride_; }
+    const T* rowData(size_t row) const { return data_ + row * stride_; }
+
+    std::span<T> row(size_t row) { return {rowData(row), cols_}; }
+    std::span<const T> row(size_t row) const { return {rowData(row), cols_}; }
+
+    ColumnView<T> column(size_t col) { return {data_ + col, rows_, stride_}; }
+    ColumnView<const T> column(size_t col) const { return {data_ + col, rows_, stride_}; }
+
+    void fill(const T& value) {
+        for (size_t r = 0; r < rows_; ++r) {
+            std::fill_n(rowData(r), cols_, value);
+        }
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t stride() const { return stride_; }  // 相邻两行首元素之间隔了多少个 T
+    size_t alignment() const { return alignment_; }
+    bool padStride() const { return pad_stride_; }
+
+    // 行列数不同、补齐和对齐设置相同的新矩阵（元素为 0），给要重新分配输出的算法用
+    Matrix withShape(size_t rows, size_t cols) const { return Matrix(rows, cols, pad_stride_, alignment_); }
+
+private:
+    void release() {
+        if (data_) {
+            ::operator delete(data_, std::align_val_t(alignment_));
+            data_ = nullptr;
+        }
+    }
+
+    T* data_ = nullptr;
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    size_t stride_ = 0;
+    size_t alignment_ = std::max<size_t>(64, alignof(T));  // 和构造函数的默认参数一致，默认构造的矩阵 withShape 出来也是 64 字节对齐
+    bool pad_stride_ = false;
+};
+
+// 分块转置：每次处理 block x block 的小块，读和写都落在缓存里。
+// dst 形状不对时按 dst 原来的补齐和对齐设置重新分配；dst 和 src 是同一个矩阵时先算到临时矩阵再移过去
+template <typename T>
+void transposeBlocked(const Matrix<T>& src, Matrix<T>& dst, size_t block = 16) {
+    if (block == 0) {
+        throw std::invalid_argument("分块大小不能为 0");
+    }
+    if (&dst == &src) {
+        Matrix<T> result = dst.withShape(src.cols(), src.rows());
+        transposeBlocked(src, result, block);
+        dst = std::move(result);
+        return;
+    }
+    if (dst.rows() != src.cols() || dst.cols() != src.rows()) {
+        dst = dst.withShape(src.cols(), src.rows());
+    }
+    for (size_t rb = 0; rb < src.rows(); rb += block) {
+        const size_t r_end = std::min(rb + block, src.rows());
+        for (size_t cb = 0; cb < src.cols(); cb += block) {
+            const size_t c_end = std::min(cb + block, src.cols());
+            for (size_t r = rb; r < r_end; ++r) {
+                const T* src_row = src.rowData(r);
+                for (size_t c = cb; c < c_end; ++c) {
+                    dst(c, r) = src_row[c];
+                }
+            }
+        }
+    }
+}
+
+// 分块乘法 C = A * B：按 i-k-j 顺序，最内层沿 B 和 C 的行连续访问，编译器可以向量化。
+// c 形状不对时按 c 原来的补齐和对齐设置重新分配；c 和 a 或 b 是同一个矩阵时（比如 a = a * b）
+// 先算到临时矩阵再移过去，否则清零 c 就把输入清掉了，内层循环的 __restrict 也不成立
+template <typename T>
+void multiplyBlocked(const Matrix<T>& a, const Matrix<T>& b, Matrix<T>& c, size_t block = 64) {
+    if (a.cols() != b.rows()) {
+        throw std::invalid_argument("矩阵维度不匹配");
+    }
+    if (block == 0) {
+        throw std::invalid_argument("分块大小不能为 0");
+    }
+    if (&c == &a || &c == &b) {
+        Matrix<T> result = c.withShape(a.rows(), b.cols());
+        multiplyBlocked(a, b, result, block);
+        c = std::move(result);
+        return;
+    }
+    if (c.rows() != a.rows() || c.cols() != b.cols()) {
+        c = c.withShape(a.rows(), b.cols());
+    } else {
+        c.fill(T{});
+    }
+
+    const size_t n = a.rows();
+    const size_t m = b.cols();
+    const size_t inner = a.cols();
+    for (size_t kb = 0; kb < inner; kb += block) {
+        const size_t k_end = std::min(kb + block, inner);
+        for (size_t jb = 0; jb < m; jb += block) {
+            const size_t j_end = std::min(jb + block, m);
+            for (size_t i = 0; i < n; ++i) {
+                const T* a_row = a.rowData(i);
+                T* __restrict c_row = c.rowData(i);
+                for (size_t k = kb; k < k_end; ++k) {
+                    const T a_ik = a_row[k];
+                    const T* __restrict b_row = b.rowData(k);
+                    for (size_t j = jb; j < j_end; ++j) {
+                        c_row[j] += a_ik * b_row[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif //HANDS_ON_CPP_MATRIX_H
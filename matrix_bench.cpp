@@ -0,0 +1,217 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 矩阵布局基准：int**（每行单独 new）对比连续存储的 Matrix<int>，
+// 测填充、求和、转置和乘法的吞吐量。矩阵大小从能放进 L1 一直到 1 GB；
+// 乘法是 O(n^3)，只在较小的尺寸上跑。
+// 前两行在两种布局上跑完全相同的朴素循环（逐元素转置、i-j-k 乘法），差别只来自布局；
+// 第三行是 Matrix 上的分块转置和分块乘法，和第二行比是算法的收益。
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "matrix.h"
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// 和 multiLevelPointerExample 一样的 int** 布局
+struct PointerMatrix {
+    explicit PointerMatrix(size_t n) : n(n), rows(new int*[n]) {
+        for (size_t i = 0; i < n; ++i) {
+            rows[i] = new int[n];
+        }
+    }
+
+    ~PointerMatrix() {
+        for (size_t i = 0; i < n; ++i) {
+            delete[] rows[i];
+        }
+        delete[] rows;
+    }
+
+    PointerMatrix(const PointerMatrix&) = delete;
+    PointerMatrix& operator=(const PointerMatrix&) = delete;
+
+    size_t n;
+    int** rows;
+};
+
+struct Timings {
+    double fill = -1;  // 负数表示没跑
+    double sum = -1;
+    double transpose = -1;
+    double multiply = -1;
+};
+
+Timings benchPointer(size_t n, bool with_multiply) {
+    Timings t;
+    PointerMatrix a(n);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            a.rows[i][j] = static_cast<int>(i * n + j);
+        }
+    }
+    t.fill = secondsSince(start);
+
+    start = Clock::now();
+    int64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            sum += a.rows[i][j];
+        }
+    }
+    t.sum = secondsSince(start);
+    volatile int64_t sink = sum;
+    (void)sink;
+
+    {
+        PointerMatrix b(n);
+        start = Clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                b.rows[j][i] = a.rows[i][j];
+            }
+        }
+        t.transpose = secondsSince(start);
+    }
+
+    if (with_multiply) {
+        PointerMatrix c(n);
+        start = Clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                int acc = 0;
+                for (size_t k = 0; k < n; ++k) {
+                    acc += a.rows[i][k] * a.rows[k][j];
+                }
+                c.rows[i][j] = acc;
+            }
+        }
+        t.multiply = secondsSince(start);
+        volatile int sink2 = c.rows[n / 2][n / 2];
+        (void)sink2;
+    }
+    return t;
+}
+
+// 和 benchPointer 相同的朴素循环，只是换成连续存储
+Timings benchContiguous(size_t n, bool with_multiply) {
+    Timings t;
+    Matrix<int> a(n, n, true);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        int* row = a.rowData(i);
+        for (size_t j = 0; j < n; ++j) {
+            row[j] = static_cast<int>(i * n + j);
+        }
+    }
+    t.fill = secondsSince(start);
+
+    start = Clock::now();
+    int64_t sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        for (int value : a.row(i)) {
+            sum += value;
+        }
+    }
+    t.sum = secondsSince(start);
+    volatile int64_t sink = sum;
+    (void)sink;
+
+    {
+        Matrix<int> b(n, n, true);
+        start = Clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                b(j, i) = a(i, j);
+            }
+        }
+        t.transpose = secondsSince(start);
+    }
+
+    if (with_multiply) {
+        Matrix<int> c(n, n, true);
+        start = Clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                int acc = 0;
+                for (size_t k = 0; k < n; ++k) {
+                    acc += a(i, k) * a(k, j);
+                }
+                c(i, j) = acc;
+            }
+        }
+        t.multiply = secondsSince(start);
+        volatile int sink2 = c(n / 2, n / 2);
+        (void)sink2;
+    }
+    return t;
+}
+
+// Matrix 上的分块转置和分块乘法；填充和求和和上面一样，不再测
+Timings benchBlocked(size_t n, bool with_multiply) {
+    Timings t;
+    Matrix<int> a(n, n, true);
+    for (size_t i = 0; i < n; ++i) {
+        int* row = a.rowData(i);
+        for (size_t j = 0; j < n; ++j) {
+            row[j] = static_cast<int>(i * n + j);
+        }
+    }
+
+    {
+        Matrix<int> b(n, n, true);
+        const auto start = Clock::now();
+        transposeBlocked(a, b);
+        t.transpose = secondsSince(start);
+    }
+
+    if (with_multiply) {
+        Matrix<int> c(n, n, true);
+        const auto start = Clock::now();
+        multiplyBlocked(a, a, c);
+        t.multiply = secondsSince(start);
+        volatile int sink2 = c(n / 2, n / 2);
+        (void)sink2;
+    }
+    return t;
+}
+
+void printRow(const char* name, size_t n, const Timings& t) {
+    const double bytes = static_cast<double>(n) * n * sizeof(int);
+    std::cout << "  " << name;
+    if (t.fill >= 0) {
+        std::cout << " 填充 " << bytes / t.fill / 1e9 << " GB/s, 求和 " << bytes / t.sum / 1e9 << " GB/s,";
+    }
+    std::cout << " 转置 " << bytes / t.transpose / 1e9 << " GB/s";
+    if (t.multiply >= 0) {
+        std::cout << ", 乘法 " << 2.0 * n * n * n / t.multiply / 1e9 << " GOPS";
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    // 第一个参数：最大矩阵字节数，默认 1 GB
+    const size_t max_bytes = argc > 1 ? std::stoull(argv[1]) : (size_t(1) << 30);
+    const size_t max_multiply_n = 1024;
+
+    // 边长每次翻倍：32x32 int = 4 KB（L1），一直到 16384x16384 int = 1 GB
+    for (size_t n = 32; n * n * sizeof(int) <= max_bytes; n *= 2) {
+        const bool with_multiply = n <= max_multiply_n;
+        std::cout << n << " x " << n << "（" << n * n * sizeof(int) / 1024 << " KB）:" << std::endl;
+        printRow("int**:       ", n, benchPointer(n, with_multiply));
+        printRow("Matrix:      ", n, benchContiguous(n, with_multiply));
+        printRow("Matrix 分块: ", n, benchBlocked(n, with_multiply));
+    }
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// Matrix：分块转置和乘法的输出和输入是同一个矩阵、分块大小为 0、重新分配输出时保留补齐和对齐设置。
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "matrix.h"
+#include "test_check.h"
+
+namespace {
+
+Matrix<int> sequence(size_t rows, size_t cols, bool pad_stride = false) {
+    Matrix<int> m(rows, cols, pad_stride);
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t c = 0; c < cols; ++c) {
+            m(r, c) = static_cast<int>(r * cols + c + 1);
+        }
+    }
+    return m;
+}
+
+// 朴素的 i-j-k 乘法，作为参照
+Matrix<int> reference(const Matrix<int>& a, const Matrix<int>& b) {
+    Matrix<int> c(a.rows(), b.cols());
+    for (size_t i = 0; i < a.rows(); ++i) {
+        for (size_t j = 0; j < b.cols(); ++j) {
+            for (size_t k = 0; k < a.cols(); ++k) {
+                c(i, j) += a(i, k) * b(k, j);
+            }
+        }
+    }
+    return c;
+}
+
+bool equal(const Matrix<int>& x, const Matrix<int>& y) {
+    if (x.rows() != y.rows() || x.cols() != y.cols()) {
+        return false;
+    }
+    for (size_t r = 0; r < x.rows(); ++r) {
+        for (size_t c = 0; c < x.cols(); ++c) {
+            if (x(r, c) != y(r, c)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+// 原地转置：非方阵，形状也要跟着变
+void testTransposeInPlace() {
+    Matrix<int> m = sequence(5, 3);
+    transposeBlocked(m, m, 2);
+    CHECK(m.rows() == 3 && m.cols() == 5);
+    bool ok = true;
+    for (size_t r = 0; r < 5; ++r) {
+        for (size_t c = 0; c < 3; ++c) {
+            ok = ok && m(c, r) == static_cast<int>(r * 3 + c + 1);
+        }
+    }
+    CHECK(ok);
+}
+
+// c 和 a 或 b 是同一个矩阵
+void testMultiplyAliased() {
+    const Matrix<int> b = sequence(4, 4);
+    Matrix<int> a = sequence(4, 4);
+    const Matrix<int> expected_left = reference(a, b);
+    multiplyBlocked(a, b, a, 3);
+    CHECK(equal(a, expected_left));
+
+    Matrix<int> s = sequence(4, 4);
+    const Matrix<int> expected_square = reference(s, s);
+    multiplyBlocked(s, s, s, 2);
+    CHECK(equal(s, expected_square));
+}
+
+void testZeroBlock() {
+    const Matrix<int> a = sequence(3, 3);
+    Matrix<int> out;
+    bool transpose_threw = false;
+    try {
+        transposeBlocked(a, out, 0);
+    } catch (const std::invalid_argument&) {
+        transpose_threw = true;
+    }
+    CHECK(transpose_threw);
+    bool multiply_threw = false;
+    try {
+        multiplyBlocked(a, a, out, 0);
+    } catch (const std::invalid_argument&) {
+        multiply_threw = true;
+    }
+    CHECK(multiply_threw);
+}
+
+// 输出形状不对要重新分配时，沿用它原来的补齐和对齐设置
+void testReallocKeepsLayout() {
+    const Matrix<int> a = sequence(3, 5);
+    Matrix<int> dst(1, 1, true, 128);
+    transposeBlocked(a, dst);
+    CHECK(dst.rows() == 5 && dst.cols() == 3);
+    CHECK(dst.padStride());
+    CHECK(dst.alignment() == 128);
+    CHECK(dst.stride() % (128 / sizeof(int)) == 0);
+    CHECK(reinterpret_cast<uintptr_t>(dst.data()) % 128 == 0);
+
+    Matrix<int> c(2, 2, true, 256);
+    multiplyBlocked(a, sequence(5, 7), c);
+    CHECK(c.rows() == 3 && c.cols() == 7);
+    CHECK(c.padStride());
+    CHECK(reinterpret_cast<uintptr_t>(c.data()) % 256 == 0);
+    CHECK(equal(c, reference(a, sequence(5, 7))));
+}
+
+int main() {
+    testTransposeInPlace();
+    testMultiplyAliased();
+    testZeroBlock();
+    testReallocKeepsLayout();
+    return testResult();
+}
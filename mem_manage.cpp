@@ -2,10 +2,27 @@
 // Created by Galaxy on 2025/6/30.
 //
 #include <iostream>
-#include <chrono>
+#include <algorithm>
+#include <fstream>
 #include <vector>
 #include <memory>
-#include <windows.h>
+#include <memory_resource>
+#include <string>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "arena_allocator.h"
+#include "bench_harness.h"
+#include "console.h"
+#include "simd_kernels.h"
+
+#ifdef _WIN32
+#include <psapi.h>  // 要在 console.h 引入 windows.h 之后
+#endif
 
 class TestObject {
 private:
@@ -18,12 +35,9 @@ public:
         }
     }
 
+    // 交给向量化算子库，运行时按 CPU 选择 SSE4.2/AVX2/AVX-512 版本
     int getSum() const {
-        int sum = 0;
-        for (int i = 0; i < 100; i++) {
-            sum += data[i];
-        }
-        return sum;
+        return simd::sum(std::span<const int32_t>(data, 100));
     }
 };
 
@@ -77,34 +91,168 @@ void heapAllocationDemo() {
     delete heapObj;
 }
 
+// 当前进程的峰值常驻内存（KB），从进程启动（或上一次 resetPeakRss）算起
+long peakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;  // macOS 上单位是字节
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+#ifdef __linux__
+// /proc/self/status 里的一项（KB），读不到返回 -1
+long procStatusKb(const std::string& key) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, key.size(), key) == 0 && line.size() > key.size() && line[key.size()] == ':') {
+            return std::stol(line.substr(key.size() + 1));
+        }
+    }
+    return -1;
+}
+#endif
+
+// 把峰值常驻内存重置成当前值，返回当前常驻内存（KB）；不支持时返回 -1。
+// 只有 Linux 可以重置（写 /proc/self/clear_refs，内核 4.0 起）；重置前先 malloc_trim，
+// 把之前的用例留在堆里的空闲页还给内核，不然这个用例复用这些页时不算增长
+long resetPeakRss() {
+#ifdef __linux__
+#ifdef __GLIBC__
+    malloc_trim(0);
+#endif
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if (!(clear_refs << "5" << std::flush)) {
+        return -1;
+    }
+    return procStatusKb("VmRSS");
+#else
+    return -1;
+#endif
+}
+
+// 用例函数外面包一层，记下这个用例运行期间的峰值常驻内存：
+// - rss_peak_delta_kb：峰值减去开始时的常驻内存，每个用例单独计算
+// - rss_peak_total_kb：不能重置的平台上退回进程累计的峰值，会继承前面用例的峰值，各行之间不能直接比较
+bench::Runner::Function withPeakRss(bench::Runner::Function fn) {
+    return [fn = std::move(fn)](bench::State& state) {
+        const long start_kb = resetPeakRss();
+        fn(state);
+#ifdef __linux__
+        const long peak_kb = start_kb >= 0 ? procStatusKb("VmHWM") : -1;
+#else
+        const long peak_kb = -1;
+#endif
+        if (peak_kb >= 0) {
+            state.setCounter("rss_peak_delta_kb", static_cast<double>(std::max(peak_kb - start_kb, 0L)));
+        } else {
+            state.setCounter("rss_peak_total_kb", static_cast<double>(peakRssKb()));
+        }
+    };
+}
+
+// 按批次分配：每批先分配 batch 个对象，求和之后再整批释放，模拟一次请求内的短生命周期对象。
+// 一次迭代是一批。
+template <typename Alloc, typename Release>
+void runBatches(bench::State& state, int batch, Alloc alloc, Release release) {
+    std::vector<TestObject*> objects(batch);
+    unsigned next = 0;
+    for (auto _ : state) {
+        for (int j = 0; j < batch; j++) {
+            objects[j] = alloc(static_cast<int>(next++));
+        }
+        for (int j = 0; j < batch; j++) {
+            bench::doNotOptimize(objects[j]->getSum());
+        }
+        release(objects);
+    }
+    state.setItemsPerIteration(batch);
+}
+
 // 性能对比
-void performanceComparison() {
+void performanceComparison(const bench::Options& options) {
     std::cout << "\n=== 性能对比 ===" << std::endl;
 
-    const int iterations = 1000000;
+    const int batch = 1000;  // 每批对象数（一次"请求"）
+    bench::Runner runner(options);
 
     // 栈分配性能测试
-    auto start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < iterations; i++) {
-        TestObject stackObj(i);
-        volatile int sum = stackObj.getSum();  // 防止编译器优化
-    }
-    auto end = std::chrono::high_resolution_clock::now();
-    auto stackTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    runner.add("栈", withPeakRss([&](bench::State& state) {
+        unsigned next = 0;
+        for (auto _ : state) {
+            for (int j = 0; j < batch; j++) {
+                TestObject stackObj(static_cast<int>(next++));
+                bench::doNotOptimize(stackObj.getSum());
+            }
+        }
+        state.setItemsPerIteration(batch);
+    }));
 
     // 堆分配性能测试
-    start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < iterations; i++) {
-        TestObject* heapObj = new TestObject(i);
-        volatile int sum = heapObj->getSum();
-        delete heapObj;
+    runner.add("堆 new/delete", withPeakRss([&](bench::State& state) {
+        runBatches(state, batch,
+            [](int i) { return new TestObject(i); },
+            [](std::vector<TestObject*>& objects) {
+                for (TestObject* obj : objects) {
+                    delete obj;
+                }
+            });
+    }));
+
+    // 单调分配器：每批结束 reset() 一次，内存块留给下一批
+    runner.add("单调分配器", withPeakRss([&](bench::State& state) {
+        MonotonicArena arena(batch * sizeof(TestObject) + 4096);
+        std::pmr::polymorphic_allocator<> alloc(&arena);
+        runBatches(state, batch,
+            [&](int i) { return alloc.new_object<TestObject>(i); },
+            [&](std::vector<TestObject*>&) { arena.reset(); });  // TestObject 可平凡析构，直接丢弃
+    }));
+
+    // 定长对象池
+    runner.add("ObjectPool", withPeakRss([&](bench::State& state) {
+        ObjectPool<TestObject> pool(batch);
+        runBatches(state, batch,
+            [&](int i) { return pool.create(i); },
+            [&](std::vector<TestObject*>& objects) {
+                for (TestObject* obj : objects) {
+                    pool.destroy(obj);
+                }
+            });
+    }));
+
+    // 标准库的 pmr 池
+    runner.add("pmr::unsynchronized_pool", withPeakRss([&](bench::State& state) {
+        std::pmr::unsynchronized_pool_resource pool;
+        std::pmr::polymorphic_allocator<> alloc(&pool);
+        runBatches(state, batch,
+            [&](int i) { return alloc.new_object<TestObject>(i); },
+            [&](std::vector<TestObject*>& objects) {
+                for (TestObject* obj : objects) {
+                    alloc.delete_object(obj);
+                }
+            });
+    }));
+
+    std::vector<bench::Result> results = runner.run();
+    if (results.empty()) {
+        return;
+    }
+    std::cout << "每批 " << batch << " 个对象，按中位数相对 " << results[0].name << ":" << std::endl;
+    for (const auto& result : results) {
+        std::cout << result.name << ": " << result.medianPerItem() << " ns/op, "
+                  << result.median / std::max(results[0].median, 1e-9) << " 倍" << std::endl;
     }
-    end = std::chrono::high_resolution_clock::now();
-    auto heapTime = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-
-    std::cout << "栈分配时间: " << stackTime.count() << " 微秒" << std::endl;
-    std::cout << "堆分配时间: " << heapTime.count() << " 微秒" << std::endl;
-    std::cout << "堆分配比栈分配慢: " << (double)heapTime.count() / stackTime.count() << " 倍" << std::endl;
 }
 
 // 何时使用栈vs堆的示例
@@ -184,11 +332,12 @@ void stackOverflowDemo() {
     }
 }
 
-int main() {
-    SetConsoleOutputCP(CP_UTF8);  // 设置控制台输出为UTF-8
+// 性能对比的参数见 bench_harness.h，例如 --bench_repetitions=30 --bench_json=mem.json
+int main(int argc, char* argv[]) {
+    setupConsole();
     stackAllocationDemo();
     heapAllocationDemo();
-    performanceComparison();
+    performanceComparison(bench::parseOptions(argc, argv));
     usageGuidelines();
     stackOverflowDemo();
 
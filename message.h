@@ -0,0 +1,117 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_MESSAGE_H
+#define HANDS_ON_CPP_MESSAGE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <utility>
+
+// ==================== 不可变消息 ====================
+// 短消息（不超过 kInlineCapacity 字节）直接存在对象里，拷贝就是拷贝这几十个字节，不分配内存；
+// 长消息只在构造时分配一次：引用计数和内容放在同一块内存里，之后的拷贝只增加引用计数。
+// 所以一次 notify 无论有多少观察者，最多一次分配。
+
+class Message {
+public:
+    static constexpr size_t kInlineCapacity = 40;
+
+    Message() noexcept : size_(0), is_inline_(true) {}
+
+    explicit Message(std::string_view text) : size_(static_cast<uint32_t>(text.size())) {
+        is_inline_ = text.size() <= kInlineCapacity;
+        if (is_inline_) {
+            std::memcpy(storage_.bytes, text.data(), text.size());
+        } else {
+            void* memory = ::operator new(sizeof(Shared) + text.size());
+            storage_.shared = ::new (memory) Shared{};
+            std::memcpy(payload(), text.data(), text.size());
+        }
+    }
+
+    Message(const Message& other) noexcept : size_(other.size_), is_inline_(other.is_inline_) {
+        if (is_inline_) {
+            std::memcpy(storage_.bytes, other.storage_.bytes, size_);
+        } else {
+            storage_.shared = other.storage_.shared;
+            storage_.shared->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Message(Message&& other) noexcept : size_(other.size_), is_inline_(other.is_inline_) {
+        if (is_inline_) {
+            std::memcpy(storage_.bytes, other.storage_.bytes, size_);
+        } else {
+            storage_.shared = other.storage_.shared;
+            other.size_ = 0;
+            other.is_inline_ = true;
+        }
+    }
+
+    Message& operator=(const Message& other) noexcept {
+        if (this != &other) {
+            Message copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    Message& operator=(Message&& other) noexcept {
+        if (this != &other) {
+            Message moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    ~Message() { release(); }
+
+    void swap(Message& other) noexcept {
+        std::swap(storage_, other.storage_);
+        std::swap(size_, other.size_);
+        std::swap(is_inline_, other.is_inline_);
+    }
+
+    std::string_view view() const noexcept {
+        return {is_inline_ ? storage_.bytes : payload(), size_};
+    }
+
+    operator std::string_view() const noexcept { return view(); }
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    bool isInline() const noexcept { return is_inline_; }
+
+private:
+    // 长消息的头部，内容紧跟在后面
+    struct Shared {
+        std::atomic<uint32_t> refs{1};
+    };
+
+    char* payload() const noexcept { return reinterpret_cast<char*>(storage_.shared + 1); }
+
+    void release() noexcept {
+        if (!is_inline_ && storage_.shared->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            storage_.shared->~Shared();
+            ::operator delete(storage_.shared);
+        }
+    }
+
+    // 两种存储方式共用一块空间，union 本身可以平凡拷贝，swap 时整体交换
+    union Storage {
+        char bytes[kInlineCapacity];
+        Shared* shared;
+    };
+
+    Storage storage_;
+    uint32_t size_;
+    bool is_inline_;
+};
+
+#endif //HANDS_ON_CPP_MESSAGE_H
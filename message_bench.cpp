@@ -0,0 +1,227 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 消息路径的分配次数：替换全局 operator new 来计数，对比改造前后每次 notify 的分配次数。
+// - 改造前：update/notify 收 const std::string&，异步版本每条消息 make_shared<std::string>，队列是 std::deque
+// - 改造后：update/notify 收 std::string_view，异步版本用 Message（短消息内联，长消息一次分配、引用计数共享）
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "async_subject.h"
+
+// ==================== 分配计数 ====================
+
+std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// ==================== 改造前的实现 ====================
+
+class LegacyObserver {
+public:
+    void update(const std::string& message) { bytes_ += message.size(); }
+
+private:
+    uint64_t bytes_ = 0;
+};
+
+class LegacySubject {
+public:
+    void attach(std::shared_ptr<LegacyObserver> observer) { observers_.push_back(observer); }
+
+    void notify(const std::string& message) {
+        for (auto& weak : observers_) {
+            if (auto observer = weak.lock()) {
+                observer->update(message);
+            }
+        }
+    }
+
+    void flush() {}
+
+private:
+    std::vector<std::weak_ptr<LegacyObserver>> observers_;
+};
+
+// 改造前 AsyncSubject 的消息路径：每条消息 make_shared<const std::string>，任务放进 std::deque
+class LegacyAsyncSubject {
+public:
+    LegacyAsyncSubject() : worker_(&LegacyAsyncSubject::workerLoop, this) {}
+
+    ~LegacyAsyncSubject() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        worker_.join();
+    }
+
+    void attach(std::shared_ptr<LegacyObserver> observer) { observers_.push_back(observer); }
+
+    void notify(const std::string& message) {
+        auto shared_message = std::make_shared<const std::string>(message);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t begin = 0; begin < observers_.size(); begin += kBatch) {
+                tasks_.push_back({shared_message, begin});
+            }
+        }
+        cv_.notify_one();
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this]() { return tasks_.empty() && !busy_; });
+    }
+
+private:
+    static constexpr size_t kBatch = 256;
+
+    struct Task {
+        std::shared_ptr<const std::string> message;
+        size_t begin;
+    };
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            Task task = std::move(tasks_.front());
+            tasks_.pop_front();
+            busy_ = true;
+            lock.unlock();
+            const size_t end = std::min(task.begin + kBatch, observers_.size());
+            for (size_t i = task.begin; i < end; ++i) {
+                if (auto observer = observers_[i].lock()) {
+                    observer->update(*task.message);
+                }
+            }
+            lock.lock();
+            busy_ = false;
+            idle_.notify_all();
+        }
+    }
+
+    std::vector<std::weak_ptr<LegacyObserver>> observers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_;
+    std::deque<Task> tasks_;
+    bool busy_ = false;
+    bool stop_ = false;
+    std::thread worker_;
+};
+
+// ==================== 改造后的观察者 ====================
+
+class ViewObserver {
+public:
+    void update(std::string_view message) { bytes_ += message.size(); }
+
+private:
+    uint64_t bytes_ = 0;
+};
+
+class ViewSubject {
+public:
+    void attach(std::shared_ptr<ViewObserver> observer) { observers_.push_back(observer); }
+
+    void notify(std::string_view message) {
+        for (auto& weak : observers_) {
+            if (auto observer = weak.lock()) {
+                observer->update(message);
+            }
+        }
+    }
+
+    void flush() {}
+
+private:
+    std::vector<std::weak_ptr<ViewObserver>> observers_;
+};
+
+// ==================== 计数 ====================
+
+// 发布方像业务代码一样直接传字面量（const char*）
+template <typename SubjectT, typename ObserverT>
+double allocationsPerNotify(SubjectT& subject, const char* payload) {
+    const int observers = 1000;
+    const int messages = 1000;
+    std::vector<std::shared_ptr<ObserverT>> owned;
+    for (int i = 0; i < observers; ++i) {
+        owned.push_back(std::make_shared<ObserverT>());
+        subject.attach(owned.back());
+    }
+
+    // 先预热一轮，让队列、线程栈等一次性的分配发生在计数之前
+    subject.notify(payload);
+    subject.flush();
+
+    const uint64_t before = g_allocations.load();
+    for (int m = 0; m < messages; ++m) {
+        subject.notify(payload);
+    }
+    subject.flush();
+    return static_cast<double>(g_allocations.load() - before) / messages;
+}
+
+int main() {
+    const char* short_payload = "AAPL 123.45";  // 放得进 std::string 的 SSO（15 字节）
+    const char* medium_payload = "价格更新: AAPL 123.45";  // 超过 SSO，但能内联进 Message（40 字节）
+    const char* long_payload =
+        "价格更新: AAPL 123.45 +0.8%, MSFT 410.12 -0.3%, GOOG 171.01 +1.2%, AMZN 185.33 +0.1%";
+
+    for (const char* payload : {short_payload, medium_payload, long_payload}) {
+        std::cout << "消息长度 " << std::string_view(payload).size() << " 字节，每次 notify 的分配次数:" << std::endl;
+        {
+            LegacySubject subject;
+            std::cout << "  改造前 同步: " << allocationsPerNotify<LegacySubject, LegacyObserver>(subject, payload)
+                      << std::endl;
+        }
+        {
+            ViewSubject subject;
+            std::cout << "  改造后 同步: " << allocationsPerNotify<ViewSubject, ViewObserver>(subject, payload)
+                      << std::endl;
+        }
+        {
+            LegacyAsyncSubject subject;
+            std::cout << "  改造前 异步: "
+                      << allocationsPerNotify<LegacyAsyncSubject, LegacyObserver>(subject, payload) << std::endl;
+        }
+        {
+            AsyncSubject<ViewObserver> subject(1, 256, 4096);
+            std::cout << "  改造后 异步: "
+                      << allocationsPerNotify<AsyncSubject<ViewObserver>, ViewObserver>(subject, payload)
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}
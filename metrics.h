@@ -0,0 +1,330 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_METRICS_H
+#define HANDS_ON_CPP_METRICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "singleton.h"
+
+// ==================== 统计指标 ====================
+// 计数器、仪表和延迟直方图。写入只做 relaxed 原子加，不加锁：
+// - 每个指标按 CPU 分片（PerCpu），不同 CPU 上的线程写不同的缓存行，互不争用
+// - 读取把各分片加起来，O(分片数)，不会阻塞写入方；
+//   读到的是各分片在略有先后的时刻的值，不是严格一致的快照，用于统计足够
+// 取代每次查看状态都扫一遍容器的写法：状态在发生变化的地方顺手记下来，查看时直接读。
+
+// 只增不减的计数
+class Counter {
+public:
+    void add(uint64_t n = 1) { shards_.local().fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t value() const {
+        uint64_t total = 0;
+        shards_.forEach([&total](const std::atomic<uint64_t>& shard) {
+            total += shard.load(std::memory_order_relaxed);
+        });
+        return total;
+    }
+
+private:
+    PerCpu<std::atomic<uint64_t>> shards_;
+};
+
+// 可增可减的当前值（比如条目数）。每个分片只记增量，单个分片可能是负的，总和才有意义
+class Gauge {
+public:
+    void add(int64_t delta) { shards_.local().fetch_add(delta, std::memory_order_relaxed); }
+
+    int64_t value() const {
+        int64_t total = 0;
+        shards_.forEach([&total](const std::atomic<int64_t>& shard) {
+            total += shard.load(std::memory_order_relaxed);
+        });
+        return total;
+    }
+
+private:
+    PerCpu<std::atomic<int64_t>> shards_;
+};
+
+// ==================== 延迟直方图 ====================
+// HDR 风格的对数-线性分桶：小于 16 的值每个值一个桶，之后每个区间 [2^e, 2^(e+1)) 均分成 16 个桶。
+// 相对误差不超过 1/16（约 6%），覆盖整个 uint64_t 只要 976 个桶；算桶号只要一次 countl_zero 和移位。
+
+struct LogLinearBuckets {
+    static constexpr unsigned kSubBits = 4;
+    static constexpr size_t kSubBuckets = size_t{1} << kSubBits;
+    static constexpr size_t kCount = (64 - kSubBits + 1) * kSubBuckets;
+
+    static size_t index(uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        const unsigned shift = 63 - static_cast<unsigned>(std::countl_zero(value)) - kSubBits;
+        return (shift + 1) * kSubBuckets + static_cast<size_t>((value >> shift) - kSubBuckets);
+    }
+
+    static uint64_t lowerBound(size_t index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        const unsigned shift = static_cast<unsigned>(index / kSubBuckets - 1);
+        return static_cast<uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+    }
+
+    // 桶内最大的值（包含）
+    static uint64_t upperBound(size_t index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        const unsigned shift = static_cast<unsigned>(index / kSubBuckets - 1);
+        return lowerBound(index) + ((uint64_t{1} << shift) - 1);
+    }
+};
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    std::array<uint64_t, LogLinearBuckets::kCount> buckets{};
+
+    double mean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+
+    // 第 q 分位（0 到 1）所在桶的上界，没有数据时返回 0
+    uint64_t percentile(double q) const {
+        if (count == 0) {
+            return 0;
+        }
+        const double clamped = q < 0.0 ? 0.0 : (q > 1.0 ? 1.0 : q);
+        const uint64_t rank =
+            std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped * static_cast<double>(count))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                return LogLinearBuckets::upperBound(i);
+            }
+        }
+        return max();
+    }
+
+    uint64_t max() const {
+        for (size_t i = buckets.size(); i-- > 0;) {
+            if (buckets[i]) {
+                return LogLinearBuckets::upperBound(i);
+            }
+        }
+        return 0;
+    }
+};
+
+// 每个分片约 8 KB，分片数等于 CPU 数；数量不多的延迟指标用它没问题，不适合给每个对象建一个
+class Histogram {
+public:
+    void record(uint64_t value) {
+        Shard& shard = shards_.local();
+        shard.buckets[LogLinearBuckets::index(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> duration) {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        record(static_cast<uint64_t>(ns > 0 ? ns : 0));
+    }
+
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot result;
+        shards_.forEach([&result](const Shard& shard) {
+            for (size_t i = 0; i < LogLinearBuckets::kCount; ++i) {
+                result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+            }
+            result.sum += shard.sum.load(std::memory_order_relaxed);
+        });
+        for (uint64_t n : result.buckets) {
+            result.count += n;
+        }
+        return result;
+    }
+
+private:
+    struct Shard {
+        std::array<std::atomic<uint64_t>, LogLinearBuckets::kCount> buckets{};
+        std::atomic<uint64_t> sum{0};
+    };
+
+    PerCpu<Shard> shards_;
+};
+
+// 作用域结束时把经过的纳秒数记进直方图
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// ==================== 注册表和导出 ====================
+// 按名字登记指标，同名的只创建一次，后来者拿到同一个对象；返回的引用在注册表的生命周期内一直有效。
+// 登记和导出加锁，写指标不经过注册表，所以导出不会阻塞写入方。
+// 名字要符合 Prometheus 的规则（字母、数字、下划线），不同类型的指标不要重名。
+
+enum class MetricsFormat {
+    Text,        // 每行一个指标，直方图给出 count/sum/mean/分位数
+    Prometheus,  // Prometheus 文本格式
+};
+
+class MetricsRegistry {
+public:
+    Counter& counter(std::string_view name, std::string_view help = {}) { return find(counters_, name, help); }
+    Gauge& gauge(std::string_view name, std::string_view help = {}) { return find(gauges_, name, help); }
+    Histogram& histogram(std::string_view name, std::string_view help = {}) {
+        return find(histograms_, name, help);
+    }
+
+    void write(std::ostream& out, MetricsFormat format) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (format == MetricsFormat::Text) {
+            writeText(out);
+        } else {
+            writePrometheus(out);
+        }
+    }
+
+    // 先写临时文件再 rename，抓取方（比如 node_exporter 的 textfile 收集器）不会读到写了一半的文件
+    bool writeFile(const std::string& path, MetricsFormat format) const {
+        const std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::trunc);
+            if (!out) {
+                return false;
+            }
+            write(out, format);
+            out.flush();
+            if (!out) {
+                std::remove(temp.c_str());
+                return false;
+            }
+        }
+        if (std::rename(temp.c_str(), path.c_str()) != 0) {
+            std::remove(temp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+private:
+    template <typename Metric>
+    struct Named {
+        std::string help;
+        std::unique_ptr<Metric> metric;
+    };
+
+    template <typename Metric>
+    using Table = std::map<std::string, Named<Metric>, std::less<>>;
+
+    template <typename Metric>
+    Metric& find(Table<Metric>& table, std::string_view name, std::string_view help) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = table.find(name);
+        if (it == table.end()) {
+            it = table.emplace(std::string(name), Named<Metric>{std::string(help), std::make_unique<Metric>()}).first;
+        }
+        return *it->second.metric;
+    }
+
+    void writeText(std::ostream& out) const {
+        for (const auto& [name, named] : counters_) {
+            out << name << ' ' << named.metric->value() << '\n';
+        }
+        for (const auto& [name, named] : gauges_) {
+            out << name << ' ' << named.metric->value() << '\n';
+        }
+        for (const auto& [name, named] : histograms_) {
+            const HistogramSnapshot s = named.metric->snapshot();
+            out << name << " count=" << s.count << " sum=" << s.sum << " mean=" << s.mean()
+                << " p50=" << s.percentile(0.5) << " p90=" << s.percentile(0.9) << " p99=" << s.percentile(0.99)
+                << " max=" << s.max() << '\n';
+        }
+    }
+
+    static void writeHeader(std::ostream& out, const std::string& name, const std::string& help, const char* type) {
+        if (!help.empty()) {
+            out << "# HELP " << name << ' ' << help << '\n';
+        }
+        out << "# TYPE " << name << ' ' << type << '\n';
+    }
+
+    // 直方图的 le 取 2^k - 1：分桶边界和 2 的幂对齐，这样累计数是精确的；
+    // 只输出到最大值所在的区间为止，桶少而且每次导出的边界基本不变
+    void writePrometheus(std::ostream& out) const {
+        for (const auto& [name, named] : counters_) {
+            writeHeader(out, name, named.help, "counter");
+            out << name << ' ' << named.metric->value() << '\n';
+        }
+        for (const auto& [name, named] : gauges_) {
+            writeHeader(out, name, named.help, "gauge");
+            out << name << ' ' << named.metric->value() << '\n';
+        }
+        for (const auto& [name, named] : histograms_) {
+            const HistogramSnapshot s = named.metric->snapshot();
+            writeHeader(out, name, named.help, "histogram");
+            uint64_t cumulative = 0;
+            size_t bucket = 0;
+            for (unsigned k = 0; k < 64 && cumulative < s.count; ++k) {
+                const uint64_t le = (uint64_t{1} << k) - 1;
+                while (bucket < s.buckets.size() && LogLinearBuckets::upperBound(bucket) <= le) {
+                    cumulative += s.buckets[bucket++];
+                }
+                out << name << "_bucket{le=\"" << le << "\"} " << cumulative << '\n';
+            }
+            out << name << "_bucket{le=\"+Inf\"} " << s.count << '\n';
+            out << name << "_sum " << s.sum << '\n';
+            out << name << "_count " << s.count << '\n';
+        }
+    }
+
+    mutable std::mutex mutex_;
+    Table<Counter> counters_;
+    Table<Gauge> gauges_;
+    Table<Histogram> histograms_;
+};
+
+// 进程级的默认注册表。用函数内静态对象而不是 Singleton<MetricsRegistry>：退出时要析构，否则表里的节点、名字和直方图分片
+// 都会出现在 alloc_tracker 的退出泄漏报告里。析构顺序是安全的：
+// - 构造时取过 defaultMetrics() 的静态对象（持有指标引用的那些）晚于它构造，所以先于它析构
+// - alloc_tracker 的 atexit 在静态初始化阶段就注册了，在它析构之后才运行，看到的是释放干净的堆
+// main 返回之后不要再从还在运行的线程里写指标。持有指标指针的对象要在注册表之前销毁；
+// WeakCache 发出去的条目可以活得更久，缓存销毁之后它们的删除器不再碰仪表。
+inline MetricsRegistry& defaultMetrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+#endif //HANDS_ON_CPP_METRICS_H
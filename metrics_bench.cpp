@@ -0,0 +1,136 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 统计指标的写入和读取开销：
+// - 多线程写：所有线程加同一个原子变量 vs 按 CPU 分片的 Counter；
+//   加锁的分桶数组 vs 分片的 Histogram（桶一样，只差锁和分片）
+// - 读：ptr_ref_test.cpp 里 showCacheStatus 原来的写法（遍历 10 万个 weak_ptr 数活跃项）vs Gauge::value，
+//   以及 Histogram 快照和分位数计算
+// 多线程部分先跑，之后 bench::Runner 会把主线程绑到一个 CPU 上。
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_harness.h"
+#include "metrics.h"
+
+using Clock = std::chrono::steady_clock;
+
+// 加锁版本的直方图，分桶和 Histogram 相同
+class LockedHistogram {
+public:
+    void record(uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++buckets_[LogLinearBuckets::index(value)];
+        sum_ += value;
+    }
+
+private:
+    std::mutex mutex_;
+    std::array<uint64_t, LogLinearBuckets::kCount> buckets_{};
+    uint64_t sum_ = 0;
+};
+
+// threads 个线程各执行 iterations 次 op(i)，返回每次的平均纳秒数
+template <typename Op>
+double nsPerOp(unsigned threads, uint64_t iterations, Op op) {
+    std::atomic<unsigned> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+            }
+            for (uint64_t i = 0; i < iterations; ++i) {
+                op(i);
+            }
+        });
+    }
+    while (ready.load() != threads) {
+    }
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return ns / static_cast<double>(iterations);
+}
+
+template <typename Op>
+void row(const char* name, unsigned threads, Op op) {
+    const uint64_t iterations = 10'000'000 / threads;
+    std::cout << "    " << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << nsPerOp(threads, iterations, op) << " ns/次" << std::endl;
+}
+
+// 延迟值大致落在几百纳秒到几十微秒之间，分散到不同的桶
+uint64_t fakeLatency(uint64_t i) { return 200 + (i * 2654435761u) % 50'000; }
+
+int main(int argc, char* argv[]) {
+    const unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::atomic<uint64_t> shared{0};
+    Counter counter;
+    LockedHistogram locked_histogram;
+    Histogram histogram;
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        std::cout << threads << " 线程写入:" << std::endl;
+        row("共享原子变量 fetch_add", threads, [&](uint64_t) { shared.fetch_add(1, std::memory_order_relaxed); });
+        row("Counter::add", threads, [&](uint64_t) { counter.add(); });
+        row("加锁直方图", threads, [&](uint64_t i) { locked_histogram.record(fakeLatency(i)); });
+        row("Histogram::record", threads, [&](uint64_t i) { histogram.record(fakeLatency(i)); });
+    }
+
+    // showCacheStatus 原来的写法需要的数据：10 万个条目，一半已过期
+    const size_t n = 100'000;
+    std::vector<std::shared_ptr<int>> alive;
+    std::unordered_map<int, std::weak_ptr<int>> cache;
+    Gauge live;
+    for (size_t i = 0; i < n; ++i) {
+        auto value = std::make_shared<int>(static_cast<int>(i));
+        cache[static_cast<int>(i)] = value;
+        if (i % 2 == 0) {
+            alive.push_back(value);
+            live.add(1);
+        }
+    }
+
+    bench::Runner runner(bench::parseOptions(argc, argv));
+    runner.add("活跃项 [遍历 10 万个 weak_ptr]", [&](bench::State& state) {
+        for (auto _ : state) {
+            size_t active = 0;
+            for (const auto& pair : cache) {
+                active += !pair.second.expired();
+            }
+            bench::doNotOptimize(active);
+        }
+    });
+    runner.add("活跃项 [Gauge::value]", [&](bench::State& state) {
+        for (auto _ : state) {
+            bench::doNotOptimize(live.value());
+        }
+    });
+    runner.add("Histogram 快照 + p99", [&](bench::State& state) {
+        for (auto _ : state) {
+            bench::doNotOptimize(histogram.snapshot().percentile(0.99));
+        }
+    });
+    runner.run();
+
+    const HistogramSnapshot s = histogram.snapshot();
+    std::cout << "校验: Counter " << counter.value() << " 次，Histogram " << s.count << " 次，p50 "
+              << s.percentile(0.5) << " p99 " << s.percentile(0.99) << " max " << s.max() << std::endl;
+    return 0;
+}
@@ -0,0 +1,400 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#include "mkdir_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HANDS_ON_CPP_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include "logger.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 子目录的相对路径：parent 为空表示基础目录本身
+void appendChild(std::string& path, int index) {
+    char digits[16];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), index);
+    if (!path.empty()) {
+        path += '/';
+    }
+    path.append(digits, result.ptr);
+}
+
+int openBase(const MkdirTreeOptions& options) {
+    std::error_code ec;
+    fs::create_directories(options.base_dir, ec);  // 已存在时不算错误
+    const int fd = open(options.base_dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("无法打开基础目录: {}: {}", options.base_dir, std::strerror(errno));
+    }
+    return fd;
+}
+
+void mkdirTreeSync(int base_fd, std::string& path, int depth, const MkdirTreeOptions& options, MkdirTreeStats& stats) {
+    const size_t length = path.size();
+    for (int i = 1; i <= options.fan_out; ++i) {
+        appendChild(path, i);
+        ++stats.syscalls;
+        if (mkdirat(base_fd, path.c_str(), 0755) == 0) {
+            ++stats.created;
+            if (options.log_each) {
+                LOG_INFO("创建目录: {}/{}", options.base_dir, path);
+            }
+        } else if (errno == EEXIST) {
+            ++stats.existed;
+        } else {
+            ++stats.failed;
+            LOG_ERROR("错误: mkdirat {}/{}: {}", options.base_dir, path, std::strerror(errno));
+            path.resize(length);
+            continue;
+        }
+        if (depth < options.max_depth) {
+            mkdirTreeSync(base_fd, path, depth + 1, options, stats);
+        }
+        path.resize(length);
+    }
+}
+
+}  // namespace
+
+MkdirTreeStats createTreeSync(const MkdirTreeOptions& options) {
+    MkdirTreeStats stats;
+    const auto start = std::chrono::steady_clock::now();
+    const int base_fd = openBase(options);
+    if (base_fd < 0) {
+        stats.failed = 1;
+        return stats;
+    }
+    if (options.max_depth >= 1) {
+        std::string path;
+        mkdirTreeSync(base_fd, path, 1, options, stats);
+    }
+    close(base_fd);
+    stats.seconds = secondsSince(start);
+    return stats;
+}
+
+#ifdef HANDS_ON_CPP_HAS_IO_URING
+
+// 提交队列、完成队列和 SQE 数组三块共享内存。head/tail 和内核并发读写，用 atomic_ref 按 acquire/release 访问
+struct UringMkdirEngine::Ring {
+    int fd = -1;
+    void* sq_ring = MAP_FAILED;
+    size_t sq_ring_size = 0;
+    void* cq_ring = MAP_FAILED;
+    size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned sq_local_tail = 0;  // 已经填好、还没发布给内核的位置
+    unsigned sq_mask = 0;
+    unsigned sq_entries = 0;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned cq_mask = 0;
+    unsigned cq_entries = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    ~Ring() {
+        if (sqes) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        if (sq_ring != MAP_FAILED) {
+            munmap(sq_ring, sq_ring_size);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    // 建好环并确认内核支持 MKDIRAT，失败返回 errno
+    int setup(unsigned entries) {
+        io_uring_params params{};
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return errno;
+        }
+
+        std::vector<unsigned char> probe_storage(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+        auto* probe = reinterpret_cast<io_uring_probe*>(probe_storage.data());
+        if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0) {
+            return errno;
+        }
+        if (probe->last_op < IORING_OP_MKDIRAT ||
+            !(probe->ops[IORING_OP_MKDIRAT].flags & IO_URING_OP_SUPPORTED)) {
+            return EOPNOTSUPP;
+        }
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        }
+        sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_ring == MAP_FAILED) {
+            return errno;
+        }
+        cq_ring = single_mmap ? sq_ring
+                              : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                     IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            return errno;
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes_map = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                              IORING_OFF_SQES);
+        if (sqes_map == MAP_FAILED) {
+            return errno;
+        }
+        sqes = static_cast<io_uring_sqe*>(sqes_map);
+
+        auto* sq = static_cast<char*>(sq_ring);
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries = params.sq_entries;
+        sq_local_tail = *sq_tail;
+        // SQE 按顺序使用，间接数组固定成恒等映射
+        auto* array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        for (unsigned i = 0; i < sq_entries; ++i) {
+            array[i] = i;
+        }
+
+        auto* cq = static_cast<char*>(cq_ring);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cq_entries = params.cq_entries;
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return 0;
+    }
+
+    // 取下一个空闲 SQE；调用方保证提交队列没满。填好的 SQE 在 enter 之前统一发布
+    io_uring_sqe* nextSqe() {
+        io_uring_sqe* sqe = &sqes[sq_local_tail++ & sq_mask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    // 提交 to_submit 个，至少等 wait 个完成；返回内核接受的个数，出错返回 -errno
+    int enter(unsigned to_submit, unsigned wait) {
+        std::atomic_ref<unsigned>(*sq_tail).store(sq_local_tail, std::memory_order_release);
+        const unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+        for (;;) {
+            const long ret = syscall(__NR_io_uring_enter, fd, to_submit, wait, flags, nullptr, 0);
+            if (ret >= 0) {
+                return static_cast<int>(ret);
+            }
+            if (errno != EINTR) {
+                return -errno;
+            }
+        }
+    }
+
+    template <typename Fn>
+    unsigned reap(Fn&& fn) {
+        unsigned head = *cq_head;
+        const unsigned tail = std::atomic_ref<unsigned>(*cq_tail).load(std::memory_order_acquire);
+        const unsigned count = tail - head;
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes[head & cq_mask];
+            fn(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref<unsigned>(*cq_head).store(head, std::memory_order_release);
+        return count;
+    }
+};
+
+UringMkdirEngine::UringMkdirEngine(unsigned queue_depth) {
+    auto ring = std::make_unique<Ring>();
+    error_ = ring->setup(std::max(queue_depth, 8u));
+    if (error_ == 0) {
+        ring_ = std::move(ring);
+    }
+}
+
+UringMkdirEngine::~UringMkdirEngine() = default;
+
+MkdirTreeStats UringMkdirEngine::run(const MkdirTreeOptions& options) {
+    MkdirTreeStats stats;
+    stats.used_uring = true;
+    const auto start = std::chrono::steady_clock::now();
+    const int base_fd = openBase(options);
+    if (base_fd < 0) {
+        stats.failed = 1;
+        return stats;
+    }
+
+    // 节点：在飞的请求和建好了等着展开子目录的目录。deque 追加时不移动已有元素，SQE 里指向 path 的指针一直有效
+    struct Node {
+        std::string path;  // 相对基础目录
+        int depth = 0;
+    };
+    std::deque<Node> nodes(1);  // 0 号是基础目录本身
+    std::vector<uint32_t> free_nodes;
+    std::vector<uint32_t> ready = {0};  // 后进先出：深度优先展开，节点数保持在 深度 x 分支数 的量级
+    auto allocate = [&]() -> uint32_t {
+        if (!free_nodes.empty()) {
+            const uint32_t id = free_nodes.back();
+            free_nodes.pop_back();
+            return id;
+        }
+        nodes.emplace_back();
+        return static_cast<uint32_t>(nodes.size() - 1);
+    };
+
+    Ring& ring = *ring_;
+    const int fan_out = options.fan_out;
+    // 完成队列默认是提交队列的两倍，在飞的请求不超过提交队列大小就不会溢出
+    const unsigned max_in_flight = ring.sq_entries;
+    unsigned in_flight = 0;
+    unsigned unsubmitted = 0;
+    bool aborted = options.max_depth < 1 || fan_out < 1 || static_cast<unsigned>(fan_out) > max_in_flight;
+    if (static_cast<unsigned>(fan_out) > max_in_flight) {
+        LOG_ERROR("分支数 {} 超过了 io_uring 队列大小 {}", fan_out, max_in_flight);
+        stats.failed = 1;
+    }
+
+    auto complete = [&](uint64_t user_data, int32_t res) {
+        const auto id = static_cast<uint32_t>(user_data);
+        Node& node = nodes[id];
+        --in_flight;
+        bool expand = false;
+        if (res == 0) {
+            ++stats.created;
+            expand = true;
+            if (options.log_each) {
+                LOG_INFO("创建目录: {}/{}", options.base_dir, node.path);
+            }
+        } else if (res == -EEXIST) {
+            ++stats.existed;
+            expand = true;
+        } else {
+            ++stats.failed;
+            LOG_ERROR("错误: mkdirat {}/{}: {}", options.base_dir, node.path, std::strerror(-res));
+        }
+        if (expand && node.depth < options.max_depth) {
+            ready.push_back(id);
+        } else {
+            free_nodes.push_back(id);
+        }
+    };
+
+    while (!aborted && (!ready.empty() || in_flight > 0)) {
+        // 展开已经建好的目录：每个父目录的 fan_out 个子目录串成一条 HARDLINK 链
+        while (!ready.empty() && in_flight + fan_out <= max_in_flight) {
+            const uint32_t parent = ready.back();
+            ready.pop_back();
+            for (int i = 1; i <= fan_out; ++i) {
+                const uint32_t child = allocate();
+                Node& node = nodes[child];
+                node.path = nodes[parent].path;
+                appendChild(node.path, i);
+                node.depth = nodes[parent].depth + 1;
+
+                io_uring_sqe* sqe = ring.nextSqe();
+                sqe->opcode = IORING_OP_MKDIRAT;
+                sqe->fd = base_fd;
+                sqe->addr = reinterpret_cast<uint64_t>(node.path.c_str());
+                sqe->len = 0755;
+                sqe->user_data = child;
+                if (i < fan_out) {
+                    sqe->flags = IOSQE_IO_HARDLINK;
+                }
+            }
+            free_nodes.push_back(parent);
+            in_flight += fan_out;
+            unsubmitted += fan_out;
+        }
+
+        // 还能继续展开时只提交不等待；否则等够一条链的完成再醒来。MKDIRAT 总是交给 io-wq 工作线程做，
+        // 每次只等一个的话几乎每个完成都要进出一次内核，批量就没了
+        unsigned wait = 0;
+        if (ready.empty() || in_flight + fan_out > max_in_flight) {
+            wait = std::min(static_cast<unsigned>(fan_out), in_flight);
+        }
+        const int submitted = ring.enter(unsubmitted, wait);
+        ++stats.syscalls;
+        if (submitted < 0 && submitted != -EAGAIN && submitted != -EBUSY) {
+            LOG_ERROR("io_uring_enter 失败: {}", std::strerror(-submitted));
+            // 只有没提交的请求在这里算失败；已经提交的在下面等它们完成，由 complete 计数
+            stats.failed += unsubmitted;
+            aborted = true;
+            break;
+        }
+        if (submitted > 0) {
+            unsubmitted -= static_cast<unsigned>(submitted);
+        }
+        ring.reap(complete);
+    }
+    // 出错退出时等已经提交的请求做完，path 要一直有效到内核不再使用
+    while (aborted && in_flight > unsubmitted) {
+        if (ring.enter(0, 1) < 0) {
+            // 等不到结果，剩下的请求结果未知，按失败算
+            stats.failed += in_flight - unsubmitted;
+            break;
+        }
+        ring.reap(complete);
+    }
+
+    close(base_fd);
+    stats.seconds = secondsSince(start);
+    return stats;
+}
+
+#else
+
+struct UringMkdirEngine::Ring {};
+
+UringMkdirEngine::UringMkdirEngine(unsigned) : error_(ENOSYS) {}
+
+UringMkdirEngine::~UringMkdirEngine() = default;
+
+MkdirTreeStats UringMkdirEngine::run(const MkdirTreeOptions& options) { return createTreeSync(options); }
+
+#endif
+
+MkdirTreeStats createTree(const MkdirTreeOptions& options) {
+    // 单核时 io-wq 工作线程和提交线程轮流占一个核，只多了线程切换，同步 mkdirat 更快
+    if (std::thread::hardware_concurrency() <= 1) {
+        return createTreeSync(options);
+    }
+    UringMkdirEngine engine(options.queue_depth);
+    if (engine.valid()) {
+        return engine.run(options);
+    }
+    LOG_WARN("io_uring 不可用（{}），改用同步 mkdirat", std::strerror(engine.error()));
+    return createTreeSync(options);
+}
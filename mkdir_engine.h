@@ -0,0 +1,72 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_MKDIR_ENGINE_H
+#define HANDS_ON_CPP_MKDIR_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+// ==================== 批量建目录 ====================
+// 建一棵完整的目录树：每层 fan_out 个子目录，名字是 1..fan_out，和 main.cpp 的 createNestedDirectories 一样。
+// createNestedDirectories 每个节点一次 exists（stat）加一次 create_directory，都是阻塞的系统调用，
+// 建几百万个目录时时间都花在进出内核上。这里有两条路径：
+// - UringMkdirEngine：io_uring 的 IORING_OP_MKDIRAT，一次 io_uring_enter 提交和收割成百上千个请求。
+//   一个目录的完成事件回来（成功或 EEXIST）之后才把它的子目录排进队列；同一个父目录下的子目录用
+//   IOSQE_IO_HARDLINK 串成一条链依次执行：它们在内核里本来就要抢父目录的 inode 锁，串行不损失并发，
+//   也避免多个 io-wq 工作线程在同一把锁上排队。HARDLINK 保证某个子目录失败（比如已存在）不会取消后面的兄弟
+// - createTreeSync：同步 mkdirat，路径相对基础目录，EEXIST 视为成功，省掉 exists 的 stat
+// createTree 在多核机器上优先用 io_uring，内核不支持（ENOSYS、被 seccomp 禁止、没有 MKDIRAT）时退回同步路径。
+// MKDIRAT 在内核里没有非阻塞路径，总是交给 io-wq 工作线程执行，省下的是进出内核的次数，代价是线程间的交接：
+// 单核上 tmpfs 实测同步 mkdirat 约 30 万目录/秒，io_uring 约 20 万，所以单核直接走同步路径（见 mkdir_bench）。
+// 直接用系统调用，不依赖 liburing。只支持 Linux，其他 POSIX 系统只有同步路径。
+
+struct MkdirTreeOptions {
+    std::filesystem::path base_dir;  // 不存在时先创建
+    int fan_out = 9;                 // 每层的分支数
+    int max_depth = 3;               // 最大深度
+    unsigned queue_depth = 4096;     // io_uring 的提交队列大小，也是同时在飞的请求上限
+    bool log_each = false;           // 每建一个目录打一条日志
+};
+
+struct MkdirTreeStats {
+    uint64_t created = 0;   // 新建的目录数
+    uint64_t existed = 0;   // 已存在（EEXIST）的目录数
+    uint64_t failed = 0;    // 失败的目录数（父目录失败时子目录不会再尝试，不计入）
+    uint64_t syscalls = 0;  // 建目录用的系统调用次数（io_uring_enter 或 mkdirat）
+    bool used_uring = false;
+    double seconds = 0.0;
+};
+
+// 同步路径：深度优先，每个目录一次 mkdirat
+MkdirTreeStats createTreeSync(const MkdirTreeOptions& options);
+
+class UringMkdirEngine {
+public:
+    // 创建失败（内核不支持等）时 valid() 为 false，error() 是对应的 errno
+    explicit UringMkdirEngine(unsigned queue_depth = 4096);
+    ~UringMkdirEngine();
+
+    UringMkdirEngine(const UringMkdirEngine&) = delete;
+    UringMkdirEngine& operator=(const UringMkdirEngine&) = delete;
+
+    bool valid() const { return ring_ != nullptr; }
+    int error() const { return error_; }
+
+    MkdirTreeStats run(const MkdirTreeOptions& options);
+
+private:
+    struct Ring;
+
+    std::unique_ptr<Ring> ring_;
+    int error_ = 0;
+};
+
+// 多核时优先 io_uring，单核或不可用时用 createTreeSync
+MkdirTreeStats createTree(const MkdirTreeOptions& options);
+
+#endif //HANDS_ON_CPP_MKDIR_ENGINE_H
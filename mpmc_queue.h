@@ -0,0 +1,351 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_MPMC_QUEUE_H
+#define HANDS_ON_CPP_MPMC_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cache_line.h"
+
+// 忙等时的退避：先空转几次，再让出 CPU
+class SpinBackoff {
+public:
+    void pause() {
+        if (count_ < 6) {
+            for (int i = 0; i < (1 << count_); ++i) {
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#endif
+            }
+            ++count_;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    void reset() { count_ = 0; }
+
+private:
+    int count_ = 0;
+};
+
+// ==================== 无锁有界 MPMC 队列（Vyukov） ====================
+// 环形缓冲区的每个槽位带一个序号：
+// - 序号 == pos 表示槽位空闲，可以被第 pos 个 push 使用
+// - 序号 == pos + 1 表示槽位已写入，可以被第 pos 个 pop 读取
+// 生产者和消费者只在 head/tail 上 CAS，槽位之间互不干扰。
+
+template <typename T>
+class MpmcQueue {
+    static_assert(std::is_nothrow_move_constructible_v<T>, "T 的移动构造不能抛异常");
+
+public:
+    // capacity 会向上取整到 2 的幂
+    explicit MpmcQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        cells_ = std::unique_ptr<Cell[]>(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // 析构时没有别的线程在用队列，直接就地析构还没取走的元素；不要求 T 能默认构造
+    ~MpmcQueue() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            const size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+            for (size_t pos = dequeue_pos_.load(std::memory_order_relaxed); pos != tail; ++pos) {
+                Cell& cell = cells_[pos & mask_];
+                if (cell.sequence.load(std::memory_order_acquire) == pos + 1) {
+                    std::launder(reinterpret_cast<T*>(cell.storage))->~T();
+                }
+            }
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // 只有成功时才会移走 item，失败时调用方可以原样重试。
+    // 占到槽位之后构造元素不能抛异常，否则槽位永远不会发布，消费者卡在这里：
+    // 构造可能抛异常时（比如拷贝 std::string）先在占槽位之前构造好 T，再移动进去。
+    // 失败时移走的是这个临时对象，item 不变；右值做不到这一点，要先转换成 T
+    template <typename U>
+    bool try_push(U&& item) {
+        if constexpr (std::is_nothrow_constructible_v<T, U&&>) {
+            return pushNoThrow(std::forward<U>(item));
+        } else {
+            static_assert(std::is_lvalue_reference_v<U>, "从右值构造 T 可能抛异常，先转换成 T 再 push");
+            T value(item);
+            return pushNoThrow(std::move(value));
+        }
+    }
+
+    bool try_pop(T& out) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    T* item = std::launder(reinterpret_cast<T*>(cell.storage));
+                    out = std::move(*item);
+                    item->~T();
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // 空的
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 阻塞版本：满/空时退避重试
+    void push(T item) {
+        SpinBackoff backoff;
+        while (!try_push(std::move(item))) {
+            backoff.pause();
+        }
+    }
+
+    T pop() {
+        T item;
+        SpinBackoff backoff;
+        while (!try_pop(item)) {
+            backoff.pause();
+        }
+        return item;
+    }
+
+    // 一次 CAS 占用连续的多个槽位，返回实际写入的数量（可能小于 n）
+    size_t try_push_n(T* items, size_t n) {
+        if (n == 0) {
+            return 0;  // countReady 返回 0 不代表队列满，下面的循环会一直重试
+        }
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t ready = countReady(pos, 0, n);
+            if (ready == 0) {
+                Cell& cell = cells_[pos & mask_];
+                auto diff = static_cast<std::intptr_t>(cell.sequence.load(std::memory_order_acquire)) -
+                            static_cast<std::intptr_t>(pos);
+                if (diff < 0) {
+                    return 0;
+                }
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                for (size_t i = 0; i < ready; ++i) {
+                    Cell& cell = cells_[(pos + i) & mask_];
+                    ::new (cell.storage) T(std::move(items[i]));
+                    cell.sequence.store(pos + i + 1, std::memory_order_release);
+                }
+                return ready;
+            }
+        }
+    }
+
+    size_t try_pop_n(T* out, size_t n) {
+        if (n == 0) {
+            return 0;
+        }
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t ready = countReady(pos, 1, n);
+            if (ready == 0) {
+                Cell& cell = cells_[pos & mask_];
+                auto diff = static_cast<std::intptr_t>(cell.sequence.load(std::memory_order_acquire)) -
+                            static_cast<std::intptr_t>(pos + 1);
+                if (diff < 0) {
+                    return 0;
+                }
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                for (size_t i = 0; i < ready; ++i) {
+                    Cell& cell = cells_[(pos + i) & mask_];
+                    T* item = std::launder(reinterpret_cast<T*>(cell.storage));
+                    out[i] = std::move(*item);
+                    item->~T();
+                    cell.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+                }
+                return ready;
+            }
+        }
+    }
+
+    // 阻塞直到 n 个全部写入
+    void push_n(T* items, size_t n) {
+        SpinBackoff backoff;
+        while (n > 0) {
+            size_t pushed = try_push_n(items, n);
+            if (pushed == 0) {
+                backoff.pause();
+                continue;
+            }
+            backoff.reset();
+            items += pushed;
+            n -= pushed;
+        }
+    }
+
+    // 阻塞直到至少取到一个，返回取到的数量；n 为 0 时直接返回 0
+    size_t pop_n(T* out, size_t n) {
+        if (n == 0) {
+            return 0;
+        }
+        SpinBackoff backoff;
+        for (;;) {
+            size_t popped = try_pop_n(out, n);
+            if (popped > 0) {
+                return popped;
+            }
+            backoff.pause();
+        }
+    }
+
+private:
+    template <typename V>
+    bool pushNoThrow(V&& value) noexcept {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    ::new (cell.storage) T(std::forward<V>(value));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // 满了
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // 从 pos 开始数连续可用的槽位（offset 为 0 数空槽，为 1 数已写入的槽）
+    size_t countReady(size_t pos, size_t offset, size_t n) const {
+        size_t limit = n < capacity() ? n : capacity();
+        size_t ready = 0;
+        while (ready < limit &&
+               cells_[(pos + ready) & mask_].sequence.load(std::memory_order_acquire) == pos + ready + offset) {
+            ++ready;
+        }
+        return ready;
+    }
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(kCacheLineSize) std::atomic<size_t> enqueue_pos_{0};
+    alignas(kCacheLineSize) std::atomic<size_t> dequeue_pos_{0};  // 对齐让整个对象补齐到缓存行，后面的成员不会共享这一行
+};
+
+// ==================== 互斥锁 + 条件变量的有界队列（基准） ====================
+// 用预先分配好的环形缓冲区存元素，稳态下 push/pop 不会再分配内存（std::deque 会反复申请/释放块）。
+
+template <typename T>
+class BlockingQueue {
+public:
+    explicit BlockingQueue(size_t capacity) : items_(capacity > 0 ? capacity : 1) {}
+
+    void push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this]() { return count_ < items_.size(); });
+        pushLocked(std::move(item));
+        lock.unlock();
+        not_empty_.notify_one();
+    }
+
+    T pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this]() { return count_ > 0; });
+        T item = popLocked();
+        lock.unlock();
+        not_full_.notify_one();
+        return item;
+    }
+
+    template <typename U>
+    bool try_push(U&& item) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (count_ == items_.size()) {
+                return false;
+            }
+            pushLocked(std::forward<U>(item));
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (count_ == 0) {
+                return false;
+            }
+            out = popLocked();
+        }
+        not_full_.notify_one();
+        return true;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+private:
+    template <typename U>
+    void pushLocked(U&& item) {
+        items_[(head_ + count_) % items_.size()] = std::forward<U>(item);
+        ++count_;
+    }
+
+    T popLocked() {
+        T item = std::move(items_[head_]);
+        items_[head_] = T{};  // 及时释放元素持有的资源（比如 shared_ptr）
+        head_ = (head_ + 1) % items_.size();
+        --count_;
+        return item;
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::vector<T> items_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+};
+
+#endif //HANDS_ON_CPP_MPMC_QUEUE_H
@@ -0,0 +1,184 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// MpmcQueue：批量接口的边界（n 为 0、超过容量、队列满/空），构造元素抛异常、析构剩余元素，
+// 以及多生产者多消费者下不丢不重。
+// 卡死的情况靠 ctest 的 TIMEOUT 判失败。
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "mpmc_queue.h"
+#include "test_check.h"
+
+// n 为 0：空队列、有元素、满队列三种状态下都立即返回 0，不改变队列
+void testZeroCount() {
+    MpmcQueue<int> queue(4);
+    int buffer[4] = {1, 2, 3, 4};
+    int out[4] = {};
+
+    CHECK(queue.try_push_n(buffer, 0) == 0);
+    CHECK(queue.try_pop_n(out, 0) == 0);
+    CHECK(queue.pop_n(out, 0) == 0);
+    queue.push_n(buffer, 0);
+
+    CHECK(queue.try_push_n(buffer, 2) == 2);
+    CHECK(queue.try_push_n(buffer, 0) == 0);
+    CHECK(queue.try_pop_n(out, 0) == 0);
+    CHECK(queue.pop_n(out, 0) == 0);
+
+    CHECK(queue.try_push_n(buffer + 2, 2) == 2);  // 满了
+    CHECK(queue.try_push_n(buffer, 0) == 0);
+    CHECK(queue.try_pop_n(out, 0) == 0);
+    CHECK(queue.pop_n(out, 0) == 0);
+
+    CHECK(queue.try_pop_n(out, 4) == 4);
+    CHECK(out[0] == 1 && out[1] == 2 && out[2] == 3 && out[3] == 4);
+}
+
+// 满时 try_push_n 返回 0，空时 try_pop_n 返回 0；n 超过容量时最多处理一整圈
+void testBatchBounds() {
+    MpmcQueue<int> queue(4);
+    std::vector<int> items = {1, 2, 3, 4, 5, 6};
+    std::vector<int> out(6, 0);
+
+    CHECK(queue.try_pop_n(out.data(), 6) == 0);
+    CHECK(queue.try_push_n(items.data(), 6) == 4);
+    CHECK(queue.try_push_n(items.data() + 4, 2) == 0);
+    CHECK(queue.try_pop_n(out.data(), 3) == 3);
+    CHECK(queue.try_push_n(items.data() + 4, 2) == 2);  // 跨过数组末尾
+    CHECK(queue.try_pop_n(out.data() + 3, 6) == 3);
+    for (int i = 0; i < 6; ++i) {
+        CHECK(out[i] == i + 1);
+    }
+}
+
+// 多生产者多消费者混用单个和批量接口，每个值恰好出队一次
+void testConcurrent() {
+    constexpr int kProducers = 3;
+    constexpr int kConsumers = 3;
+    constexpr uint64_t kPerProducer = 20'000;
+    MpmcQueue<uint64_t> queue(64);
+    std::atomic<uint64_t> consumed{0};
+    std::vector<std::vector<uint64_t>> seen(kConsumers);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&queue, p]() {
+            uint64_t batch[8];
+            for (uint64_t i = 0; i < kPerProducer; i += 8) {
+                for (uint64_t k = 0; k < 8; ++k) {
+                    batch[k] = p * kPerProducer + i + k;
+                }
+                if (i % 16 == 0) {
+                    queue.push_n(batch, 8);
+                } else {
+                    for (uint64_t value : batch) {
+                        queue.push(value);
+                    }
+                }
+            }
+        });
+    }
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&, c]() {
+            uint64_t batch[8];
+            while (consumed.load(std::memory_order_relaxed) < kProducers * kPerProducer) {
+                const size_t popped = queue.try_pop_n(batch, c == 0 ? 1 : 8);
+                if (popped == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                seen[c].insert(seen[c].end(), batch, batch + popped);
+                consumed.fetch_add(popped, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<int> counts(kProducers * kPerProducer, 0);
+    for (const auto& values : seen) {
+        for (uint64_t value : values) {
+            CHECK(value < counts.size());
+            if (value < counts.size()) {
+                ++counts[value];
+            }
+        }
+    }
+    int wrong = 0;
+    for (int count : counts) {
+        wrong += count != 1;
+    }
+    CHECK(wrong == 0);
+}
+
+// 拷贝构造可能抛异常、不能默认构造、记录存活数量的元素
+struct Tracked {
+    static inline int live = 0;
+    int value;
+    bool throw_on_copy = false;
+
+    explicit Tracked(int v, bool throws = false) : value(v), throw_on_copy(throws) { ++live; }
+    Tracked(const Tracked& other) : value(other.value), throw_on_copy(other.throw_on_copy) {
+        if (throw_on_copy) {
+            throw std::runtime_error("copy");
+        }
+        ++live;
+    }
+    Tracked(Tracked&& other) noexcept : value(other.value), throw_on_copy(other.throw_on_copy) { ++live; }
+    Tracked& operator=(Tracked&& other) noexcept {
+        value = other.value;
+        throw_on_copy = other.throw_on_copy;
+        return *this;
+    }
+    ~Tracked() { --live; }
+};
+
+// 拷贝进队列时抛异常：异常在占槽位之前抛出，后面的 push/pop 照常进行（以前消费者会卡在没发布的槽位上）
+void testPushThrows() {
+    MpmcQueue<Tracked> queue(4);
+    const Tracked bad(1, true);
+    bool threw = false;
+    try {
+        queue.try_push(bad);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    const Tracked good(2);
+    CHECK(queue.try_push(good));
+    Tracked out(0);
+    CHECK(queue.try_pop(out));
+    CHECK(out.value == 2);
+    CHECK(!queue.try_pop(out));
+}
+
+// 析构时就地析构还没取走的元素，不需要默认构造
+void testDestroyRemaining() {
+    const int before = Tracked::live;
+    {
+        MpmcQueue<Tracked> queue(8);
+        for (int i = 0; i < 5; ++i) {
+            CHECK(queue.try_push(Tracked(i)));
+        }
+        Tracked out(0);
+        CHECK(queue.try_pop(out));
+        CHECK(Tracked::live == before + 5);  // 队列里 4 个加 out
+    }
+    CHECK(Tracked::live == before);
+}
+
+int main() {
+    testZeroCount();
+    testBatchBounds();
+    testPushThrows();
+    testDestroyRemaining();
+    testConcurrent();
+    return testResult();
+}
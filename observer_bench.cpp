@@ -0,0 +1,130 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 观察者通知基准：10k 个观察者，对比同步 Subject::notify 和 AsyncSubject。
+// 报告每秒能发布多少条消息（等全部投递完）以及发布者调用 notify 的延迟（p50/p99）。
+// 跑到一半会销毁 10% 的观察者，顺带测过期观察者的清理。
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "async_subject.h"
+
+using Clock = std::chrono::steady_clock;
+
+// 可以模拟慢处理：每次 update 忙等 work_ns 纳秒
+class CountingObserver {
+public:
+    explicit CountingObserver(int work_ns) : work_ns_(work_ns) {}
+
+    void update(std::string_view message) {
+        bytes_ += message.size();
+        if (work_ns_ > 0) {
+            auto until = Clock::now() + std::chrono::nanoseconds(work_ns_);
+            while (Clock::now() < until) {
+            }
+        }
+    }
+
+    uint64_t bytes() const { return bytes_; }
+
+private:
+    int work_ns_;
+    uint64_t bytes_ = 0;
+};
+
+// ptr_ref_test.cpp 里同步 Subject 的同构版本（去掉打印）
+class SyncSubject {
+public:
+    void attach(std::shared_ptr<CountingObserver> observer) { observers_.push_back(observer); }
+
+    void notify(std::string_view message) {
+        size_t kept = 0;
+        for (size_t i = 0; i < observers_.size(); ++i) {
+            if (auto observer = observers_[i].lock()) {
+                observer->update(message);
+                if (kept != i) {
+                    observers_[kept] = std::move(observers_[i]);
+                }
+                ++kept;
+            }
+        }
+        observers_.resize(kept);
+    }
+
+    void flush() {}
+
+private:
+    std::vector<std::weak_ptr<CountingObserver>> observers_;
+};
+
+struct Result {
+    double messages_per_sec;
+    double p50_us;
+    double p99_us;
+};
+
+template <typename SubjectT>
+Result run(SubjectT& subject, int observers, int messages, int work_ns) {
+    std::vector<std::shared_ptr<CountingObserver>> owned;
+    for (int i = 0; i < observers; ++i) {
+        owned.push_back(std::make_shared<CountingObserver>(work_ns));
+        subject.attach(owned.back());
+    }
+
+    std::vector<double> latencies;
+    latencies.reserve(messages);
+    const std::string payload = "价格更新: AAPL 123.45";
+
+    auto start = Clock::now();
+    for (int m = 0; m < messages; ++m) {
+        if (m == messages / 2) {
+            // 每 10 个销毁一个
+            for (size_t i = 0; i < owned.size(); i += 10) {
+                owned[i].reset();
+            }
+        }
+        auto before = Clock::now();
+        subject.notify(payload);
+        latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - before).count());
+    }
+    subject.flush();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    return {messages / seconds, latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]};
+}
+
+void print(const char* name, const Result& r) {
+    std::cout << "  " << name << r.messages_per_sec << " 消息/秒, notify 延迟 p50 " << r.p50_us
+              << " us, p99 " << r.p99_us << " us" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const int observers = 10000;
+    const int messages = 200;
+    const unsigned workers = argc > 1 ? static_cast<unsigned>(std::stoul(argv[1]))
+                                      : std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "观察者: " << observers << "，消息: " << messages << "，分发线程: " << workers << std::endl;
+    for (int work_ns : {0, 200}) {
+        std::cout << "每次 update 耗时约 " << work_ns << " ns:" << std::endl;
+        {
+            SyncSubject subject;
+            print("同步 notify: ", run(subject, observers, messages, work_ns));
+        }
+        {
+            AsyncSubject<CountingObserver> subject(workers, 256, 4096);
+            print("异步 notify: ", run(subject, observers, messages, work_ns));
+        }
+    }
+
+    return 0;
+}
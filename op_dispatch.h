@@ -0,0 +1,120 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_OP_DISPATCH_H
+#define HANDS_ON_CPP_OP_DISPATCH_H
+
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// ==================== 编译期分派的算子表 ====================
+// int (*operations[])(int, int) 在热循环里逐元素间接调用：每个元素一次跳转，编译器看不到函数体，
+// 既不能内联也不能向量化。OpTable 把“运行时选算子”挪到循环外面：
+// - 每个算子是一个空类型，operator() 是 constexpr，可以是内置的 AddOp/MultiplyOp，也可以是不捕获的 lambda
+// - dispatch 按编号匹配一次，把算子的类型交给回调；回调里对整段 span 循环，每个算子各实例化一份循环体
+// 用法：
+//   constexpr auto absDiff = [](auto a, auto b) { return a > b ? a - b : b - a; };
+//   using Ops = OpTable<AddOp, MultiplyOp, decltype(absDiff)>;
+//   Ops::apply(column_op, lhs, rhs, out);   // column_op 是运行时的编号
+
+struct AddOp {
+    template <typename T>
+    constexpr T operator()(T a, T b) const {
+        return a + b;
+    }
+};
+
+struct MultiplyOp {
+    template <typename T>
+    constexpr T operator()(T a, T b) const {
+        return a * b;
+    }
+};
+
+// out[i] = op(a[i], b[i])；单独的函数模板，每个算子一份，编译器能看到完整的循环体。
+// out 可以就是 a 或 b（原地更新），所以指针不加 __restrict，编译器向量化时会加一次运行期的重叠检查；
+// 错开几个元素的部分重叠不支持
+template <typename Op, typename T>
+void applyElementwise(Op op, std::span<const T> a, std::span<const T> b, std::span<T> out) {
+    assert(a.size() == out.size() && b.size() == out.size());
+    const size_t n = out.size();
+    const T* pa = a.data();
+    const T* pb = b.data();
+    T* po = out.data();
+    for (size_t i = 0; i < n; ++i) {
+        po[i] = op(pa[i], pb[i]);
+    }
+}
+
+// out[i] = op(a[i], scalar)，比如整列乘一个系数；out 同样可以就是 a
+template <typename Op, typename T>
+void applyScalar(Op op, std::span<const T> a, T scalar, std::span<T> out) {
+    assert(a.size() == out.size());
+    const size_t n = out.size();
+    const T* pa = a.data();
+    T* po = out.data();
+    for (size_t i = 0; i < n; ++i) {
+        po[i] = op(pa[i], scalar);
+    }
+}
+
+template <typename... Ops>
+class OpTable {
+    static_assert(sizeof...(Ops) > 0, "OpTable 至少要有一个算子");
+    static_assert((std::is_empty_v<Ops> && ...), "算子必须是无状态的（不捕获的 lambda 或空结构体）");
+    static_assert((std::is_default_constructible_v<Ops> && ...), "算子必须可以默认构造");
+
+public:
+    static constexpr size_t size = sizeof...(Ops);
+
+    // 算子在表里的编号
+    template <typename Op>
+    static constexpr size_t indexOf() {
+        constexpr bool matches[] = {std::is_same_v<Op, Ops>...};
+        for (size_t i = 0; i < size; ++i) {
+            if (matches[i]) {
+                return i;
+            }
+        }
+        return size;
+    }
+
+    // 以编号为 op 的算子调用 fn(Op{})；编号越界时什么都不做，返回 false
+    template <typename Fn>
+    static bool dispatch(size_t op, Fn&& fn) {
+        return dispatchImpl(op, fn, std::index_sequence_for<Ops...>{});
+    }
+
+    template <typename T>
+    static bool apply(size_t op, std::span<const T> a, std::span<const T> b, std::span<T> out) {
+        return dispatch(op, [&](auto fn) { applyElementwise(fn, a, b, out); });
+    }
+
+    template <typename T>
+    static bool apply(size_t op, std::span<const T> a, T scalar, std::span<T> out) {
+        return dispatch(op, [&](auto fn) { applyScalar(fn, a, scalar, out); });
+    }
+
+    // 单个值，方便和函数指针数组一样按编号调用（不在热循环里用）
+    template <typename T>
+    static T call(size_t op, T a, T b) {
+        T result{};
+        dispatch(op, [&](auto fn) { result = fn(a, b); });
+        return result;
+    }
+
+private:
+    // 折叠表达式展开成一串比较，编译器一般会生成跳转表
+    template <typename Fn, size_t... I>
+    static bool dispatchImpl(size_t op, Fn& fn, std::index_sequence<I...>) {
+        using Tuple = std::tuple<Ops...>;
+        return ((op == I ? (fn(std::tuple_element_t<I, Tuple>{}), true) : false) || ...);
+    }
+};
+
+#endif //HANDS_ON_CPP_OP_DISPATCH_H
@@ -0,0 +1,120 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 对一列 int32 数据应用运行时选出的二元算子（out[i] = op(a[i], b[i])），比较几种分派方式：
+// - 函数指针数组，逐元素间接调用（ptr_ref_test.cpp 里 functionPointerExample 的写法）
+// - std::function，逐元素调用
+// - 虚函数，逐元素调用
+// - OpTable::call，循环里逐元素按编号分派（循环体简单时编译器可能自己把分派提到循环外，不能指望）
+// - OpTable::apply，循环外分派一次，循环体内联、可以向量化
+// 算子编号经过 doNotOptimize，编译器不能在编译期知道选了哪个。
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "bench_harness.h"
+#include "op_dispatch.h"
+
+constexpr auto absDiff = [](auto a, auto b) { return a > b ? a - b : b - a; };
+using Ops = OpTable<AddOp, MultiplyOp, decltype(absDiff)>;
+
+int addFn(int a, int b) { return a + b; }
+int multiplyFn(int a, int b) { return a * b; }
+int absDiffFn(int a, int b) { return absDiff(a, b); }
+
+int (*const kFunctions[])(int, int) = {addFn, multiplyFn, absDiffFn};
+
+struct BinaryOp {
+    virtual ~BinaryOp() = default;
+    virtual int apply(int a, int b) const = 0;
+};
+
+template <typename Op>
+struct BinaryOpImpl final : BinaryOp {
+    int apply(int a, int b) const override { return Op{}(a, b); }
+};
+
+std::unique_ptr<BinaryOp> makeVirtual(size_t op) {
+    switch (op) {
+        case 0: return std::make_unique<BinaryOpImpl<AddOp>>();
+        case 1: return std::make_unique<BinaryOpImpl<MultiplyOp>>();
+        default: return std::make_unique<BinaryOpImpl<decltype(absDiff)>>();
+    }
+}
+
+size_t opaque(size_t op) {
+    bench::doNotOptimize(op);
+    return op;
+}
+
+int main(int argc, char* argv[]) {
+    const size_t n = 4096;  // 三列一共 48 KB，放得进 L2
+    std::vector<int32_t> a(n), b(n), out(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = static_cast<int32_t>(i * 7 % 1000);
+        b[i] = static_cast<int32_t>(i * 13 % 1000);
+    }
+
+    bench::Runner runner(bench::parseOptions(argc, argv));
+    const std::pair<const char*, size_t> selected[] = {{"add", 0}, {"absDiff", 2}};
+    for (const auto& [op_name, op_index] : selected) {
+        const std::string suffix = std::string(" [") + op_name + "]";
+        const size_t op = op_index;
+
+        runner.add("函数指针逐元素" + suffix, [&, op](bench::State& state) {
+            for (auto _ : state) {
+                int (*fn)(int, int) = kFunctions[opaque(op)];
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = fn(a[i], b[i]);
+                }
+                bench::clobberMemory();
+            }
+            state.setItemsPerIteration(n);
+        });
+        runner.add("std::function 逐元素" + suffix, [&, op](bench::State& state) {
+            for (auto _ : state) {
+                std::function<int(int, int)> fn = kFunctions[opaque(op)];
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = fn(a[i], b[i]);
+                }
+                bench::clobberMemory();
+            }
+            state.setItemsPerIteration(n);
+        });
+        runner.add("虚函数逐元素" + suffix, [&, op](bench::State& state) {
+            std::unique_ptr<BinaryOp> fn = makeVirtual(opaque(op));
+            for (auto _ : state) {
+                const BinaryOp* p = fn.get();
+                bench::doNotOptimize(p);
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = p->apply(a[i], b[i]);
+                }
+                bench::clobberMemory();
+            }
+            state.setItemsPerIteration(n);
+        });
+        runner.add("OpTable::call 循环内分派" + suffix, [&, op](bench::State& state) {
+            for (auto _ : state) {
+                const size_t selected_op = opaque(op);
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = Ops::call(selected_op, a[i], b[i]);
+                }
+                bench::clobberMemory();
+            }
+            state.setItemsPerIteration(n);
+        });
+        runner.add("OpTable::apply 循环外分派" + suffix, [&, op](bench::State& state) {
+            for (auto _ : state) {
+                Ops::apply<int32_t>(opaque(op), a, b, out);
+                bench::clobberMemory();
+            }
+            state.setItemsPerIteration(n);
+        });
+    }
+    runner.run();
+    return 0;
+}
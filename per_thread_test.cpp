@@ -0,0 +1,62 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// PerThread：析构后编号被下一个 PerThread 复用，线程局部数组里旧对象留下的槽位不能被新对象当成自己的。
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "singleton.h"
+#include "test_check.h"
+
+// 反复创建、使用、销毁：每个新对象在当前线程上都从零开始
+void testReuseAfterDestroy() {
+    bool fresh = true;
+    for (int i = 0; i < 1000; ++i) {
+        auto counter = std::make_unique<PerThread<uint64_t>>();
+        fresh = fresh && counter->local() == 0;
+        counter->local() += 7;
+    }
+    CHECK(fresh);
+}
+
+// 同时存在的对象编号不同，一个销毁后另一个的实例不受影响
+void testLiveNeighbours() {
+    PerThread<uint64_t> kept;
+    kept.local() = 42;
+    for (int i = 0; i < 100; ++i) {
+        PerThread<uint64_t> temporary;
+        temporary.local() = static_cast<uint64_t>(i);
+    }
+    CHECK(kept.local() == 42);
+    CHECK(kept.instances() == 1);
+}
+
+// 一个线程先后访问两个占用同一编号的对象：第二个对象在这个线程上新建实例，不沿用旧指针
+void testStaleSlotOnOtherThread() {
+    auto first = std::make_unique<PerThread<uint64_t>>();
+    std::unique_ptr<PerThread<uint64_t>> second;
+    bool fresh = false;
+    std::thread worker([&] {
+        first->local() = 5;
+        first.reset();
+        second = std::make_unique<PerThread<uint64_t>>();
+        fresh = second->local() == 0;
+        second->local() = 9;
+    });
+    worker.join();
+    CHECK(fresh);
+    uint64_t total = 0;
+    second->forEach([&total](uint64_t value) { total += value; });
+    CHECK(total == 9);
+    CHECK(second->instances() == 1);
+}
+
+int main() {
+    testReuseAfterDestroy();
+    testLiveNeighbours();
+    testStaleSlotOnOtherThread();
+    return testResult();
+}
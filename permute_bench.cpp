@@ -0,0 +1,251 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 批量交换/重排算子 vs 逐元素 std::swap 的朴素写法（ptr_ref_test.cpp 里 swapByReference 的批量版本）：
+// - 交换两段区间、原地反转：朴素循环逐元素 std::swap
+// - gather/scatter（按随机排列取/放）：朴素循环
+// - 原地置换：朴素写法是先 gather 到临时数组再拷回，对比沿置换环移动的 permuteInPlace
+// 每个算子在 L2 内（16K 个 int32）和远超 LLC（4M 个 int32）两种大小下，对比各指令集版本，最后按内存流量折算 GB/s。
+// 开始前先拿朴素写法的结果校验每个版本的每种元素类型（int32、int64、float）和每个算子，有不一致就失败退出。
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bench_harness.h"
+#include "simd_kernels.h"
+
+const simd::Isa kIsas[] = {simd::Isa::Scalar, simd::Isa::Sse42, simd::Isa::Avx2, simd::Isa::Avx512};
+
+// 元素值带上类型特有的位：int64 的高 32 位、float 的小数部分，只搬了低 32 位或者按整数搬的版本会对不上
+template <typename T>
+T valueAt(size_t i) {
+    if constexpr (std::is_same_v<T, int64_t>) {
+        return static_cast<int64_t>(i) * 0x100000001ll;
+    } else if constexpr (std::is_same_v<T, float>) {
+        return static_cast<float>(i) + 0.25f;
+    } else {
+        return static_cast<T>(i);
+    }
+}
+
+template <typename T>
+struct Data {
+    std::vector<T> a, b, out;
+    std::vector<uint32_t> perm;
+
+    explicit Data(size_t n) : a(n), b(n), out(n), perm(n) {
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = valueAt<T>(i);
+            b[i] = valueAt<T>(n + i);
+        }
+        std::iota(perm.begin(), perm.end(), 0u);
+        std::shuffle(perm.begin(), perm.end(), std::mt19937(7));
+    }
+};
+
+// ==================== 朴素写法 ====================
+
+template <typename T>
+void naiveSwapRanges(std::vector<T>& a, std::vector<T>& b) {
+    for (size_t i = 0; i < a.size(); ++i) {
+        std::swap(a[i], b[i]);
+    }
+}
+
+template <typename T>
+void naiveReverse(std::vector<T>& v) {
+    for (size_t i = 0, j = v.size(); i + 1 < j; ++i) {
+        std::swap(v[i], v[--j]);
+    }
+}
+
+template <typename T>
+void naiveGather(const std::vector<T>& in, const std::vector<uint32_t>& index, std::vector<T>& out) {
+    for (size_t i = 0; i < index.size(); ++i) {
+        out[i] = in[index[i]];
+    }
+}
+
+template <typename T>
+void naiveScatter(const std::vector<T>& in, const std::vector<uint32_t>& index, std::vector<T>& out) {
+    for (size_t i = 0; i < index.size(); ++i) {
+        out[index[i]] = in[i];
+    }
+}
+
+template <typename T>
+void naivePermute(std::vector<T>& values, const std::vector<uint32_t>& perm, std::vector<T>& scratch) {
+    naiveGather(values, perm, scratch);
+    std::copy(scratch.begin(), scratch.end(), values.begin());
+}
+
+// ==================== 校验 ====================
+// 每个指令集版本、每种元素类型、每个算子都和朴素写法比较，不一致时打印是哪一个，全部比完再返回
+
+template <typename T>
+bool verifyType(simd::Isa isa, const char* type) {
+    bool all_ok = true;
+    auto check = [&](bool ok, const char* op, size_t n) {
+        if (!ok) {
+            std::cerr << simd::isaName(isa) << " 版本的 " << op << "<" << type << ">（" << n
+                      << " 个元素）结果和朴素写法不一致" << std::endl;
+            all_ok = false;
+        }
+    };
+    // 空、单个、不到一个向量、不是向量宽度整数倍（覆盖尾部）
+    for (size_t n : {size_t{0}, size_t{1}, size_t{7}, size_t{1003}}) {
+        Data<T> expected(n);
+        Data<T> actual(n);
+
+        naiveSwapRanges(expected.a, expected.b);
+        simd::swapRanges(std::span(actual.a), std::span(actual.b));
+        check(expected.a == actual.a && expected.b == actual.b, "swapRanges", n);
+
+        naiveReverse(expected.a);
+        simd::reverse(std::span(actual.a));
+        check(expected.a == actual.a, "reverse", n);
+
+        naiveGather(expected.a, expected.perm, expected.out);
+        simd::gather(std::span<const T>(actual.a), actual.perm, std::span(actual.out));
+        check(expected.out == actual.out, "gather", n);
+
+        naiveScatter(expected.b, expected.perm, expected.out);
+        simd::scatter(std::span<const T>(actual.b), actual.perm, std::span(actual.out));
+        check(expected.out == actual.out, "scatter", n);
+
+        std::vector<T> scratch(n);
+        naivePermute(expected.a, expected.perm, scratch);
+        simd::permuteInPlace(std::span(actual.a), actual.perm);
+        check(expected.a == actual.a, "permuteInPlace", n);
+    }
+    return all_ok;
+}
+
+bool verify(simd::Isa isa) {
+    simd::setActiveIsa(isa);
+    const bool ok32 = verifyType<int32_t>(isa, "int32");
+    const bool ok64 = verifyType<int64_t>(isa, "int64");
+    const bool okf = verifyType<float>(isa, "float");
+    return ok32 && ok64 && okf;
+}
+
+int main(int argc, char* argv[]) {
+    // 分派器可能选中的每个版本都要校验；CPU 不支持的跳过并说明
+    std::vector<simd::Isa> isas;
+    bool verified = true;
+    for (simd::Isa isa : kIsas) {
+        if (!simd::setActiveIsa(isa)) {
+            std::cout << simd::isaName(isa) << ": 这台机器不支持或没有编译，跳过" << std::endl;
+            continue;
+        }
+        verified = verify(isa) && verified;
+        isas.push_back(isa);
+    }
+    if (!verified) {
+        return 1;
+    }
+    simd::setActiveIsa(simd::detectIsa());
+
+    bench::Runner runner(bench::parseOptions(argc, argv));
+    std::map<std::string, double> bytes_per_iteration;  // 用于折算 GB/s
+    std::vector<std::unique_ptr<Data<int32_t>>> datasets;
+
+    for (size_t n : {size_t{16} << 10, size_t{4} << 20}) {
+        datasets.push_back(std::make_unique<Data<int32_t>>(n));
+        Data<int32_t>& d = *datasets.back();
+        const std::string size = n < (1u << 20) ? " 16K" : " 4M";
+        const double element = sizeof(int32_t);
+        const double index = sizeof(uint32_t);
+
+        auto add = [&](const std::string& name, double bytes, bench::Runner::Function fn) {
+            bytes_per_iteration[name + size] = bytes;
+            runner.add(name + size, [n, fn = std::move(fn)](bench::State& state) {
+                fn(state);
+                state.setItemsPerIteration(n);
+            });
+        };
+        auto addIsas = [&](const std::string& name, double bytes, auto kernel) {
+            for (simd::Isa isa : isas) {
+                add(name + " [" + simd::isaName(isa) + "]", bytes, [isa, kernel](bench::State& state) {
+                    simd::setActiveIsa(isa);
+                    for (auto _ : state) {
+                        kernel();
+                        bench::clobberMemory();
+                    }
+                });
+            }
+        };
+
+        // 交换：两段都读一遍写一遍
+        add("交换 [std::swap 循环]", 4 * n * element, [&d](bench::State& state) {
+            for (auto _ : state) {
+                naiveSwapRanges(d.a, d.b);
+                bench::clobberMemory();
+            }
+        });
+        addIsas("交换", 4 * n * element, [&d]() { simd::swapRanges(std::span(d.a), std::span(d.b)); });
+
+        add("反转 [std::swap 循环]", 2 * n * element, [&d](bench::State& state) {
+            for (auto _ : state) {
+                naiveReverse(d.a);
+                bench::clobberMemory();
+            }
+        });
+        addIsas("反转", 2 * n * element, [&d]() { simd::reverse(std::span(d.a)); });
+
+        // gather/scatter：读下标、读输入、写输出
+        add("gather [朴素循环]", n * (index + 2 * element), [&d](bench::State& state) {
+            for (auto _ : state) {
+                naiveGather(d.a, d.perm, d.out);
+                bench::clobberMemory();
+            }
+        });
+        addIsas("gather", n * (index + 2 * element),
+                [&d]() { simd::gather(std::span<const int32_t>(d.a), d.perm, std::span(d.out)); });
+
+        add("scatter [朴素循环]", n * (index + 2 * element), [&d](bench::State& state) {
+            for (auto _ : state) {
+                naiveScatter(d.a, d.perm, d.out);
+                bench::clobberMemory();
+            }
+        });
+        addIsas("scatter", n * (index + 2 * element),
+                [&d]() { simd::scatter(std::span<const int32_t>(d.a), d.perm, std::span(d.out)); });
+
+        // 原地置换：按有效流量（读下标、读写每个元素一次）折算，两种写法用同一个分母
+        add("原地置换 [gather 到临时数组再拷回]", n * (index + 2 * element), [&d](bench::State& state) {
+            std::vector<int32_t> scratch(d.a.size());
+            for (auto _ : state) {
+                naivePermute(d.a, d.perm, scratch);
+                bench::clobberMemory();
+            }
+        });
+        add("原地置换 [沿置换环 permuteInPlace]", n * (index + 2 * element), [&d](bench::State& state) {
+            for (auto _ : state) {
+                simd::permuteInPlace(std::span(d.a), d.perm);
+                bench::clobberMemory();
+            }
+        });
+    }
+
+    std::vector<bench::Result> results = runner.run();
+
+    std::cout << "\n内存流量折算 (GB/s):" << std::endl;
+    for (const bench::Result& result : results) {
+        std::cout << "  " << std::left << std::setw(48) << result.name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(8) << bytes_per_iteration[result.name] / result.median
+                  << std::endl;
+    }
+    return 0;
+}
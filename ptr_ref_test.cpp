@@ -2,33 +2,49 @@
 // Created by sim on 2025/6/30.
 //
 
-#include <iostream>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <vector>
-#include <windows.h>
+
+#include "alloc_tracker.h"
+#include "arena_tree.h"
+#include "async_subject.h"
+#include "concurrent_cache.h"
+#include "console.h"
+#include "flat_hash_map.h"
+#include "intrusive_ptr.h"
+#include "logger.h"
+#include "matrix.h"
+#include "metrics.h"
+#include "op_dispatch.h"
+#include "singleton.h"
+#include "weak_cache.h"
 
 // ==================== 1. 指针和引用的基本区别 ====================
 
 void pointerVsReference() {
-    std::cout << "=== 指针 vs 引用 ===" << std::endl;
+    LOG_INFO("=== 指针 vs 引用 ===");
 
     int a = 10, b = 20;
 
     // 指针示例
     int* ptr = &a;          // 指针可以为空，可以重新赋值
-    std::cout << "指针指向a: " << *ptr << std::endl;
+    LOG_INFO("指针指向a: {}", *ptr);
     ptr = &b;               // 指针可以改变指向
-    std::cout << "指针指向b: " << *ptr << std::endl;
+    LOG_INFO("指针指向b: {}", *ptr);
     ptr = nullptr;          // 指针可以为空
 
     // 引用示例
     int& ref = a;           // 引用必须初始化，不能为空
-    std::cout << "引用a: " << ref << std::endl;
+    LOG_INFO("引用a: {}", ref);
     // int& ref2;           // 错误：引用必须初始化
     // ref = b;             // 这是赋值操作，不是改变引用指向
     ref = 30;               // 实际上是给a赋值
-    std::cout << "修改引用后a的值: " << a << std::endl;
+    LOG_INFO("修改引用后a的值: {}", a);
 }
 
 // ==================== 2. 智能指针示例 ====================
@@ -36,15 +52,15 @@ void pointerVsReference() {
 class Resource {
 public:
     Resource(int id) : id_(id) {
-        std::cout << "Resource " << id_ << " 构造" << std::endl;
+        LOG_INFO("Resource {} 构造", id_);
     }
 
     ~Resource() {
-        std::cout << "Resource " << id_ << " 析构" << std::endl;
+        LOG_INFO("Resource {} 析构", id_);
     }
 
     void use() const {
-        std::cout << "使用 Resource " << id_ << std::endl;
+        LOG_INFO("使用 Resource {}", id_);
     }
 
 private:
@@ -52,11 +68,11 @@ private:
 };
 
 void smartPointerExamples() {
-    std::cout << "\n=== 智能指针示例 ===" << std::endl;
+    LOG_INFO("\n=== 智能指针示例 ===");
 
     // unique_ptr - 独占所有权
     {
-        std::cout << "--- unique_ptr ---" << std::endl;
+        LOG_INFO("--- unique_ptr ---");
         std::unique_ptr<Resource> uptr = std::make_unique<Resource>(1);
         uptr->use();
 
@@ -64,42 +80,84 @@ void smartPointerExamples() {
         std::unique_ptr<Resource> uptr2 = std::move(uptr);  // 移动语义
 
         if (!uptr) {
-            std::cout << "uptr 已经被移动，现在为空" << std::endl;
+            LOG_INFO("uptr 已经被移动，现在为空");
         }
         uptr2->use();
     } // uptr2 在此处自动析构
 
     // shared_ptr - 共享所有权
     {
-        std::cout << "\n--- shared_ptr ---" << std::endl;
+        LOG_INFO("\n--- shared_ptr ---");
         std::shared_ptr<Resource> sptr1 = std::make_shared<Resource>(2);
-        std::cout << "引用计数: " << sptr1.use_count() << std::endl;
+        LOG_INFO("引用计数: {}", sptr1.use_count());
 
         {
             std::shared_ptr<Resource> sptr2 = sptr1;  // 可以拷贝
-            std::cout << "引用计数: " << sptr1.use_count() << std::endl;
+            LOG_INFO("引用计数: {}", sptr1.use_count());
             sptr2->use();
         } // sptr2 离开作用域，引用计数减1
 
-        std::cout << "引用计数: " << sptr1.use_count() << std::endl;
+        LOG_INFO("引用计数: {}", sptr1.use_count());
     } // sptr1 离开作用域，对象被析构
 
     // weak_ptr - 解决循环引用
     {
-        std::cout << "\n--- weak_ptr ---" << std::endl;
+        LOG_INFO("\n--- weak_ptr ---");
         std::shared_ptr<Resource> sptr = std::make_shared<Resource>(3);
         std::weak_ptr<Resource> wptr = sptr;
 
-        std::cout << "shared_ptr 引用计数: " << sptr.use_count() << std::endl;
-        std::cout << "weak_ptr 过期了吗? " << (wptr.expired() ? "是" : "否") << std::endl;
+        LOG_INFO("shared_ptr 引用计数: {}", sptr.use_count());
+        LOG_INFO("weak_ptr 过期了吗? {}", (wptr.expired() ? "是" : "否"));
 
         if (auto locked = wptr.lock()) {  // 安全访问
             locked->use();
         }
 
         sptr.reset();  // 释放shared_ptr
-        std::cout << "shared_ptr 重置后，weak_ptr 过期了吗? " << (wptr.expired() ? "是" : "否") << std::endl;
+        LOG_INFO("shared_ptr 重置后，weak_ptr 过期了吗? {}", (wptr.expired() ? "是" : "否"));
+    }
+}
+
+// 手写的智能指针: 引用计数放在对象里（见 intrusive_ptr.h）
+class CountedResource : public WeakRefCounted<CountedResource> {
+public:
+    CountedResource(int id) : id_(id) {
+        LOG_INFO("CountedResource {} 构造", id_);
+    }
+
+    ~CountedResource() {
+        LOG_INFO("CountedResource {} 析构", id_);
+    }
+
+    // 计数在对象里，可以直接从 this 得到新的强引用，不需要 enable_shared_from_this
+    IntrusivePtr<CountedResource> self() { return IntrusivePtr<CountedResource>(this); }
+
+    void use() const {
+        LOG_INFO("使用 CountedResource {}", id_);
+    }
+
+private:
+    int id_;
+};
+
+void intrusivePtrExample() {
+    LOG_INFO("\n=== 侵入式智能指针 ===");
+    LOG_INFO("句柄大小: IntrusivePtr {} 字节, shared_ptr {} 字节",
+             sizeof(IntrusivePtr<CountedResource>), sizeof(std::shared_ptr<Resource>));
+
+    IntrusivePtr<CountedResource> ptr1 = makeIntrusive<CountedResource>(4);
+    IntrusiveWeakPtr<CountedResource> weak(ptr1);
+    {
+        IntrusivePtr<CountedResource> ptr2 = ptr1->self();
+        LOG_INFO("引用计数: {}", ptr1.useCount());
+        if (auto locked = weak.lock()) {
+            locked->use();
+        }
     }
+    LOG_INFO("引用计数: {}", ptr1.useCount());
+
+    ptr1.reset();
+    LOG_INFO("强引用释放后，弱引用过期了吗? {}", (weak.expired() ? "是" : "否"));
 }
 
 // ==================== 9. weak_ptr 的具体使用场景 ====================
@@ -111,11 +169,11 @@ class Child;
 class Parent {
 public:
     Parent(const std::string& name) : name_(name) {
-        std::cout << "Parent " << name_ << " 创建" << std::endl;
+        LOG_INFO("Parent {} 创建", name_);
     }
 
     ~Parent() {
-        std::cout << "Parent " << name_ << " 销毁" << std::endl;
+        LOG_INFO("Parent {} 销毁", name_);
     }
 
     void addChild(std::shared_ptr<Child> child) {
@@ -132,11 +190,11 @@ private:
 class Child {
 public:
     Child(const std::string& name) : name_(name) {
-        std::cout << "Child " << name_ << " 创建" << std::endl;
+        LOG_INFO("Child {} 创建", name_);
     }
 
     ~Child() {
-        std::cout << "Child " << name_ << " 销毁" << std::endl;
+        LOG_INFO("Child {} 销毁", name_);
     }
 
     // 使用 weak_ptr 避免循环引用
@@ -146,9 +204,9 @@ public:
 
     void visitParent() const {
         if (auto parent = parent_.lock()) {  // 安全访问
-            std::cout << "Child " << name_ << " 访问 Parent" << std::endl;
+            LOG_INFO("Child {} 访问 Parent", name_);
         } else {
-            std::cout << "Child " << name_ << " 的 Parent 已不存在" << std::endl;
+            LOG_INFO("Child {} 的 Parent 已不存在", name_);
         }
     }
 
@@ -160,15 +218,15 @@ private:
 };
 
 void Parent::showChildren() const {
-    std::cout << "Parent " << name_ << " 的子节点: ";
+    std::string names;
     for (const auto& child : children_) {
-        std::cout << child->getName() << " ";
+        names += child->getName() + " ";
     }
-    std::cout << std::endl;
+    LOG_INFO("Parent {} 的子节点: {}", name_, names);
 }
 
 void parentChildCircularReference() {
-    std::cout << "\n=== 父子循环引用场景 ===" << std::endl;
+    LOG_INFO("\n=== 父子循环引用场景 ===");
 
     {
         auto parent = std::make_shared<Parent>("爸爸");
@@ -184,12 +242,36 @@ void parentChildCircularReference() {
         parent->showChildren();
         child1->visitParent();
 
-        std::cout << "Parent 引用计数: " << parent.use_count() << std::endl;
+        LOG_INFO("Parent 引用计数: {}", parent.use_count());
         // 如果 Child 使用 shared_ptr<Parent>，这里引用计数会是 3
         // 使用 weak_ptr 后，引用计数是 1
     } // 所有对象在这里正常销毁
 
-    std::cout << "作用域结束，对象已销毁" << std::endl;
+    LOG_INFO("作用域结束，对象已销毁");
+}
+
+// 同样的父子关系用 ArenaTree 表示：节点放在连续数组里，父子之间只存下标，
+// 访问父节点不需要 lock()，也不存在循环引用；整棵树随 ArenaTree 一起销毁
+void arenaTreeExample() {
+    LOG_INFO("\n=== 基于下标的树 ===");
+
+    ArenaTree<std::string> tree;
+    const auto parent = tree.addRoot("爸爸");
+    const auto child1 = tree.addChild(parent, "孩子1");
+    tree.addChild(parent, "孩子2");
+    tree.addChild(child1, "孙子1");
+
+    std::string names;
+    tree.forEachChild(parent, [&](auto child) { names += tree[child] + " "; });
+    LOG_INFO("Parent {} 的子节点: {}", tree[parent], names);
+
+    LOG_INFO("Child {} 访问 Parent {}", tree[child1], tree[tree.parent(child1)]);
+
+    std::string depth_first, breadth_first;
+    tree.visitDepthFirst(parent, [&](auto id) { depth_first += tree[id] + " "; });
+    tree.visitBreadthFirst(parent, [&](auto id) { breadth_first += tree[id] + " "; });
+    LOG_INFO("深度优先: {}", depth_first);
+    LOG_INFO("广度优先: {}", breadth_first);
 }
 
 // 场景2: 观察者模式中的应用
@@ -198,15 +280,16 @@ class Subject;
 class Observer {
 public:
     Observer(int id) : id_(id) {
-        std::cout << "Observer " << id_ << " 创建" << std::endl;
+        LOG_INFO("Observer {} 创建", id_);
     }
 
     ~Observer() {
-        std::cout << "Observer " << id_ << " 销毁" << std::endl;
+        LOG_INFO("Observer {} 销毁", id_);
     }
 
-    void update(const std::string& message) {
-        std::cout << "Observer " << id_ << " 收到消息: " << message << std::endl;
+    // 用 string_view 接收，调用方不需要为了通知先构造一个 std::string
+    void update(std::string_view message) {
+        LOG_INFO("Observer {} 收到消息: {}", id_, message);
     }
 
     int getId() const { return id_; }
@@ -217,51 +300,67 @@ private:
 
 class Subject {
 public:
-    Subject() {
-        std::cout << "Subject 创建" << std::endl;
+    // 统计登记在 metrics 注册表里，同名的 Subject 共用一组指标
+    explicit Subject(MetricsRegistry& metrics = defaultMetrics(), const std::string& name = "subject")
+        : delivered_(metrics.counter(name + "_delivered_total", "投递给观察者的消息数")),
+          dropped_(metrics.counter(name + "_dropped_total", "notify 时发现已销毁而移除的观察者数")),
+          registered_(metrics.gauge(name + "_observers", "登记的观察者数")),
+          notify_latency_(metrics.histogram(name + "_notify_latency_ns", "一次 notify 的耗时（纳秒）")) {
+        LOG_INFO("Subject 创建");
     }
 
+    // 同名的 Subject 共用指标，自己登记的观察者要从仪表里扣掉，不然销毁之后还一直算着
     ~Subject() {
-        std::cout << "Subject 销毁" << std::endl;
+        registered_.add(-static_cast<int64_t>(observers_.size()));
+        LOG_INFO("Subject 销毁");
     }
 
     void attach(std::shared_ptr<Observer> observer) {
         observers_.push_back(observer);  // 使用 weak_ptr 存储观察者
+        registered_.add(1);
     }
 
-    void notify(const std::string& message) {
-        std::cout << "Subject 通知所有观察者..." << std::endl;
+    void notify(std::string_view message) {
+        ScopedTimer timer(notify_latency_);
+        LOG_INFO("Subject 通知所有观察者...");
 
-        // 遍历时需要检查 weak_ptr 是否有效
-        auto it = observers_.begin();
-        while (it != observers_.end()) {
-            if (auto observer = it->lock()) {
+        // 遍历时需要检查 weak_ptr 是否有效；有效的往前挪，最后一次性截断，
+        // 避免在 vector 中间 erase 导致每次移除都是 O(n)
+        size_t kept = 0;
+        for (size_t i = 0; i < observers_.size(); ++i) {
+            if (auto observer = observers_[i].lock()) {
                 observer->update(message);
-                ++it;
+                if (kept != i) {
+                    observers_[kept] = std::move(observers_[i]);
+                }
+                ++kept;
             } else {
                 // 观察者已被销毁，从列表中移除
-                std::cout << "移除已销毁的观察者" << std::endl;
-                it = observers_.erase(it);
+                LOG_INFO("移除已销毁的观察者");
             }
         }
+        const size_t dropped = observers_.size() - kept;
+        observers_.resize(kept);
+        delivered_.add(kept);
+        dropped_.add(dropped);
+        registered_.add(-static_cast<int64_t>(dropped));
     }
 
+    // 直接读统计，不再遍历列表；已销毁的观察者要到下一次 notify 才会移除，在那之前仍然计入
     void showObserverCount() {
-        size_t active_count = 0;
-        for (auto& weak_obs : observers_) {
-            if (!weak_obs.expired()) {
-                active_count++;
-            }
-        }
-        std::cout << "活跃观察者数量: " << active_count << std::endl;
+        LOG_INFO("登记的观察者数量: {}", registered_.value());
     }
 
 private:
     std::vector<std::weak_ptr<Observer>> observers_;  // 使用 weak_ptr 避免强引用
+    Counter& delivered_;
+    Counter& dropped_;
+    Gauge& registered_;
+    Histogram& notify_latency_;
 };
 
 void observerPatternExample() {
-    std::cout << "\n=== 观察者模式场景 ===" << std::endl;
+    LOG_INFO("\n=== 观察者模式场景 ===");
 
     auto subject = std::make_shared<Subject>();
 
@@ -279,23 +378,43 @@ void observerPatternExample() {
 
         // obs2 离开作用域被销毁
         obs2.reset();
-        std::cout << "\nObserver 2 被销毁后:" << std::endl;
+        LOG_INFO("\nObserver 2 被销毁后:");
         subject->notify("第二条消息");
     } // obs1 和 obs3 在这里被销毁
 
-    std::cout << "\n所有观察者离开作用域后:" << std::endl;
+    LOG_INFO("\n所有观察者离开作用域后:");
     subject->notify("第三条消息");
 }
 
+// 观察者模式的异步版本: notify 只入队，由分发线程批量投递
+void asyncObserverExample() {
+    LOG_INFO("\n=== 异步观察者场景 ===");
+
+    AsyncSubject<Observer> subject(2);
+    auto obs1 = std::make_shared<Observer>(1);
+    auto obs2 = std::make_shared<Observer>(2);
+    subject.attach(obs1);
+    subject.attach(obs2);
+
+    subject.notify("异步消息");
+    subject.flush();  // 等分发线程投递完
+
+    obs2.reset();
+    subject.notify("Observer 2 销毁后的异步消息");
+    subject.flush();
+    LOG_INFO("已投递: {}, 压缩掉的过期观察者: {}, 剩余观察者: {}", subject.delivered(), subject.expired(),
+             subject.observerCount());
+}
+
 // 场景3: 缓存系统中的应用
 class CacheEntry {
 public:
     CacheEntry(int id, const std::string& data) : id_(id), data_(data) {
-        std::cout << "CacheEntry " << id_ << " 创建" << std::endl;
+        LOG_INFO("CacheEntry {} 创建", id_);
     }
 
     ~CacheEntry() {
-        std::cout << "CacheEntry " << id_ << " 销毁" << std::endl;
+        LOG_INFO("CacheEntry {} 销毁", id_);
     }
 
     const std::string& getData() const { return data_; }
@@ -306,57 +425,72 @@ private:
     std::string data_;
 };
 
+// 存储和过期条目的回收交给 WeakCache：每次 get 顺手回收一小批过期条目，不用等 cleanup 一次扫完整个 map。
+// 索引用 FlatHashMap，键值对直接放在连续数组里，插入不用为每个条目分配节点
 class Cache {
 public:
+    using Index = WeakCache<int, CacheEntry, FlatHashMap<int, std::weak_ptr<CacheEntry>>>;
+
+    // 统计登记在 metrics 注册表里，同名的 Cache 共用一组指标；注册表要比缓存活得久，条目可以更久
+    explicit Cache(MetricsRegistry& metrics = defaultMetrics(), const std::string& name = "cache")
+        : hits_(metrics.counter(name + "_hits_total", "命中次数")),
+          misses_(metrics.counter(name + "_misses_total", "未命中、新建条目的次数")),
+          expired_(metrics.counter(name + "_expired_total", "查找时发现已过期而重新创建的条目数")),
+          cleaned_(metrics.counter(name + "_cleanup_removed_total", "cleanup 移除的过期条目数")),
+          entries_(metrics.gauge(name + "_entries", "索引中的条目数（包括已过期但还没移除的）")),
+          live_(metrics.gauge(name + "_live_entries", "还有人持有的条目数")),
+          cache_(WeakCacheOptions{.entries = &entries_, .live = &live_}) {}
+
     std::shared_ptr<CacheEntry> get(int id) {
-        auto it = cache_.find(id);
-        if (it != cache_.end()) {
-            // 尝试从 weak_ptr 获取 shared_ptr
-            if (auto entry = it->second.lock()) {
-                std::cout << "缓存命中: " << id << std::endl;
-                return entry;
-            } else {
-                // 缓存项已过期，移除
-                std::cout << "缓存项 " << id << " 已过期，移除" << std::endl;
-                cache_.erase(it);
-            }
+        Index::Outcome outcome;
+        auto entry = cache_.get(id, [](int key) {
+            return std::make_unique<CacheEntry>(key, "数据" + std::to_string(key));
+        }, &outcome);
+
+        switch (outcome) {
+            case Index::Outcome::Hit:
+                LOG_INFO("缓存命中: {}", id);
+                hits_.add();
+                break;
+            case Index::Outcome::Expired:
+                // 缓存项已过期，换成了新建的条目
+                LOG_INFO("缓存项 {} 已过期，重新创建", id);
+                expired_.add();
+                misses_.add();
+                break;
+            case Index::Outcome::Miss:
+                LOG_INFO("创建新缓存项: {}", id);
+                misses_.add();
+                break;
         }
-
-        // 创建新的缓存项
-        std::cout << "创建新缓存项: " << id << std::endl;
-        auto entry = std::make_shared<CacheEntry>(id, "数据" + std::to_string(id));
-        cache_[id] = entry;  // 存储 weak_ptr
         return entry;
     }
 
+    // 一次扫完整个 map；平时不需要调用，过期条目会在后续的 get 里被逐步回收
     void cleanup() {
-        std::cout << "清理过期缓存..." << std::endl;
-        auto it = cache_.begin();
-        while (it != cache_.end()) {
-            if (it->second.expired()) {
-                std::cout << "移除过期缓存项: " << it->first << std::endl;
-                it = cache_.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        LOG_INFO("清理过期缓存...");
+        const size_t removed = cache_.cleanup();
+        LOG_INFO("移除过期缓存项: {} 个", removed);
+        cleaned_.add(removed);
     }
 
+    // 直接读统计，O(分片数)，不再遍历整个 map
     void showCacheStatus() {
-        std::cout << "缓存状态 - 总项数: " << cache_.size() << ", 活跃: ";
-        int active = 0;
-        for (const auto& pair : cache_) {
-            if (!pair.second.expired()) active++; // 离开作用域后，std::weak_ptr的expired()方法会返回true
-        }
-        std::cout << active << std::endl;
+        LOG_INFO("缓存状态 - 总项数: {}, 活跃: {}", entries_.value(), live_.value());
     }
 
 private:
-    std::unordered_map<int, std::weak_ptr<CacheEntry>> cache_;
+    Counter& hits_;
+    Counter& misses_;
+    Counter& expired_;
+    Counter& cleaned_;
+    Gauge& entries_;
+    Gauge& live_;  // 条目的删除器在最后一个持有者释放时减一
+    Index cache_;
 };
 
 void cacheExample() {
-    std::cout << "\n=== 缓存系统场景 ===" << std::endl;
+    LOG_INFO("\n=== 缓存系统场景 ===");
 
     Cache cache;
 
@@ -368,29 +502,80 @@ void cacheExample() {
         // 再次获取相同的项，应该命中缓存
         auto entry1_again = cache.get(1);
 
-        std::cout << "entry1 和 entry1_again 是同一个对象吗? "
-                  << (entry1.get() == entry1_again.get() ? "是" : "否") << std::endl;
+        LOG_INFO("entry1 和 entry1_again 是同一个对象吗? {}", (entry1.get() == entry1_again.get() ? "是" : "否"));
     } // entry1, entry2, entry1_again 离开作用域
 
-    std::cout << "\n引用离开作用域后:" << std::endl;
+    LOG_INFO("\n引用离开作用域后:");
     cache.showCacheStatus();
 
-    // 尝试再次获取，应该创建新对象
+    // 尝试再次获取，应该创建新对象；这次 get 顺手回收了已过期的 2，cleanup 已经没有要清理的
     auto entry3 = cache.get(1);
     cache.cleanup();  // 手动清理
     cache.showCacheStatus();
 }
 
+// 场景3的多线程版本: 分片缓存 + 强引用 LRU + 合并并发未命中
+void concurrentCacheExample() {
+    LOG_INFO("\n=== 并发缓存场景 ===");
+
+    // 强引用层只够放两个条目
+    ConcurrentCache<int, CacheEntry> cache(2 * sizeof(CacheEntry), 1);
+    auto loader = [](int id) {
+        return std::make_shared<CacheEntry>(id, "数据" + std::to_string(id));
+    };
+
+    // 4 个线程同时未命中同一个 key，CacheEntry 只构造一次
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&]() { cache.get(7, loader); });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    // 调用方已经全部释放，但强引用层仍然持有，所以还能命中
+    LOG_INFO("再次获取 7: {}", cache.get(7, loader)->getData());
+
+    // 再放入两个条目，7 被挤出强引用层，没人持有时随之销毁
+    cache.get(8, loader);
+    cache.get(9, loader);
+
+    CacheStats stats = cache.stats();
+    LOG_INFO("命中: {}, 未命中: {}, 合并: {}, 淘汰: {}",
+             stats.hits + stats.weak_hits, stats.misses, stats.coalesced, stats.evictions);
+    LOG_INFO("清理过期条目: {}", cache.cleanup());
+}
+
+// Cache 和 Subject 的统计都登记在默认注册表里，可以随时导出，也可以 writeFile 写给 Prometheus 抓取
+void metricsExample() {
+    LOG_INFO("\n=== 统计指标 ===");
+    // 导出结果每行以换行结尾，日志会再补一个，去掉最后一个
+    auto exported = [](MetricsFormat format) {
+        std::ostringstream out;
+        defaultMetrics().write(out, format);
+        std::string text = out.str();
+        if (!text.empty() && text.back() == '\n') {
+            text.pop_back();
+        }
+        return text;
+    };
+    LOG_INFO("{}", exported(MetricsFormat::Text));
+    LOG_INFO("--- Prometheus 格式 ---");
+    LOG_INFO("{}", exported(MetricsFormat::Prometheus));
+}
+
 // ==================== 3. 野指针和悬空指针 ====================
 
 void danglingPointerExample() {
-    std::cout << "\n=== 野指针和悬空指针 ===" << std::endl;
+    LOG_INFO("\n=== 野指针和悬空指针 ===");
 
     int* ptr;
     // std::cout << *ptr << std::endl;  // 危险：未初始化的指针（野指针）
 
     ptr = new int(42);
-    std::cout << "分配内存后: " << *ptr << std::endl;
+    LOG_INFO("分配内存后: {}", *ptr);
 
     delete ptr;
     // std::cout << *ptr << std::endl;  // 危险：悬空指针，指向已释放的内存
@@ -398,19 +583,19 @@ void danglingPointerExample() {
     ptr = nullptr;  // 好习惯：避免悬空指针
 
     // 另一种悬空指针情况
-    std::cout << "=== 悬空指针演示 ===" << std::endl;
+    LOG_INFO("=== 悬空指针演示 ===");
 
     int* ptr2;
     {
         int local_var = 100;
         ptr2 = &local_var;
-        std::cout << "作用域内，ptr指向: " << *ptr2 << std::endl;
-        std::cout << "local_var的地址: " << &local_var << std::endl;
-        std::cout << "ptr存储的地址: " << ptr2 << std::endl;
+        LOG_INFO("作用域内，ptr指向: {}", *ptr2);
+        LOG_INFO("local_var的地址: {}", &local_var);
+        LOG_INFO("ptr存储的地址: {}", ptr2);
     } // local_var 在这里被销毁，但内存位置可能暂时未被覆盖
 
-    std::cout << "作用域外，ptr存储的地址: " << ptr2 << std::endl;
-    std::cout << "尝试访问悬空指针: " << *ptr2 << std::endl;  // 未定义行为！
+    LOG_INFO("作用域外，ptr存储的地址: {}", ptr2);
+    LOG_INFO("尝试访问悬空指针: {}", *ptr2);  // 未定义行为！
 
     // 为什么可能还是100？因为：
     // 1. 栈内存还没有被其他变量覆盖
@@ -421,25 +606,25 @@ void danglingPointerExample() {
 // ==================== 4. 指针数组 vs 数组指针 ====================
 
 void pointerArrayVsArrayPointer() {
-    std::cout << "\n=== 指针数组 vs 数组指针 ===" << std::endl;
+    LOG_INFO("\n=== 指针数组 vs 数组指针 ===");
 
     // 指针数组：存储指针的数组
     int a = 1, b = 2, c = 3;
     int* ptr_array[3] = {&a, &b, &c};  // 3个指针的数组
-    std::cout << "指针数组: ";
+    std::string values;
     for (int i = 0; i < 3; ++i) {
-        std::cout << *ptr_array[i] << " ";
+        values += std::to_string(*ptr_array[i]) + " ";
     }
-    std::cout << std::endl;
+    LOG_INFO("指针数组: {}", values);
 
     // 数组指针：指向数组的指针
     int arr[3] = {4, 5, 6};
     int (*array_ptr)[3] = &arr;  // 指向含有3个int的数组的指针
-    std::cout << "数组指针: ";
+    values.clear();
     for (int i = 0; i < 3; ++i) {
-        std::cout << (*array_ptr)[i] << " ";
+        values += std::to_string((*array_ptr)[i]) + " ";
     }
-    std::cout << std::endl;
+    LOG_INFO("数组指针: {}", values);
 }
 
 // ==================== 5. 函数指针和引用 ====================
@@ -453,18 +638,33 @@ int multiply(int a, int b) {
 }
 
 void functionPointerExample() {
-    std::cout << "\n=== 函数指针 ===" << std::endl;
+    LOG_INFO("\n=== 函数指针 ===");
 
     // 函数指针
     int (*func_ptr)(int, int) = add;
-    std::cout << "函数指针调用 add(3, 4): " << func_ptr(3, 4) << std::endl;
+    LOG_INFO("函数指针调用 add(3, 4): {}", func_ptr(3, 4));
 
     func_ptr = multiply;
-    std::cout << "函数指针调用 multiply(3, 4): " << func_ptr(3, 4) << std::endl;
+    LOG_INFO("函数指针调用 multiply(3, 4): {}", func_ptr(3, 4));
 
     // 函数指针数组
     int (*operations[])(int, int) = {add, multiply};
-    std::cout << "函数指针数组调用: " << operations[0](5, 6) << ", " << operations[1](5, 6) << std::endl;
+    LOG_INFO("函数指针数组调用: {}, {}", operations[0](5, 6), operations[1](5, 6));
+
+    // 对整列数据应用运行时选出的算子时，不要在循环里逐元素调 operations[op]：
+    // OpTable 在循环外按编号分派一次，每个算子各有一份能内联、能向量化的循环
+    constexpr auto absDiff = [](auto a, auto b) { return a > b ? a - b : b - a; };
+    using Ops = OpTable<AddOp, MultiplyOp, decltype(absDiff)>;
+    std::vector<int> lhs = {1, 2, 3, 4}, rhs = {5, 6, 7, 8}, out(lhs.size());
+    const char* names[] = {"add", "multiply", "absDiff"};
+    for (size_t op = 0; op < Ops::size; ++op) {
+        Ops::apply<int>(op, lhs, rhs, out);
+        std::string values;
+        for (int v : out) {
+            values += std::to_string(v) + " ";
+        }
+        LOG_INFO("OpTable 按编号 {}（{}）处理整列: {}", op, names[op], values);
+    }
 }
 
 // ==================== 6. 引用作为函数参数和返回值 ====================
@@ -487,53 +687,53 @@ int& getElement(std::vector<int>& vec, size_t index) {
 }
 
 void referenceParameterExample() {
-    std::cout << "\n=== 引用作为参数和返回值 ===" << std::endl;
+    LOG_INFO("\n=== 引用作为参数和返回值 ===");
 
     int x = 10, y = 20;
-    std::cout << "交换前: x=" << x << ", y=" << y << std::endl;
+    LOG_INFO("交换前: x={}, y={}", x, y);
 
     // 使用指针交换
     swapByPointer(&x, &y);
-    std::cout << "指针交换后: x=" << x << ", y=" << y << std::endl;
+    LOG_INFO("指针交换后: x={}, y={}", x, y);
 
     // 使用引用交换
     swapByReference(x, y);
-    std::cout << "引用交换后: x=" << x << ", y=" << y << std::endl;
+    LOG_INFO("引用交换后: x={}, y={}", x, y);
 
     // 返回引用的使用
     std::vector<int> vec = {1, 2, 3, 4, 5};
     getElement(vec, 2) = 100;  // 直接修改vector中的元素
-    std::cout << "修改后的vector: ";
+    std::string values;
     for (int val : vec) {
-        std::cout << val << " ";
+        values += std::to_string(val) + " ";
     }
-    std::cout << std::endl;
+    LOG_INFO("修改后的vector: {}", values);
 }
 
 // ==================== 7. 常量指针和指针常量 ====================
 
 void constPointerExample() {
-    std::cout << "\n=== 常量指针和指针常量 ===" << std::endl;
+    LOG_INFO("\n=== 常量指针和指针常量 ===");
 
     int a = 10, b = 20;
 
     // 指向常量的指针（指针可变，指向的值不可变）
     const int* ptr1 = &a;
-    std::cout << "指向常量的指针: " << *ptr1 << std::endl;
+    LOG_INFO("指向常量的指针: {}", *ptr1);
     // *ptr1 = 30;  // 错误：不能修改指向的值
     ptr1 = &b;      // 正确：指针本身可以改变
-    std::cout << "改变指向后: " << *ptr1 << std::endl;
+    LOG_INFO("改变指向后: {}", *ptr1);
 
     // 常量指针（指针不可变，指向的值可变）
     int* const ptr2 = &a;
-    std::cout << "常量指针: " << *ptr2 << std::endl;
+    LOG_INFO("常量指针: {}", *ptr2);
     *ptr2 = 30;     // 正确：可以修改指向的值
     // ptr2 = &b;   // 错误：指针本身不能改变
-    std::cout << "修改值后: " << *ptr2 << std::endl;
+    LOG_INFO("修改值后: {}", *ptr2);
 
     // 指向常量的常量指针（指针和值都不可变）
     const int* const ptr3 = &a;
-    std::cout << "指向常量的常量指针: " << *ptr3 << std::endl;
+    LOG_INFO("指向常量的常量指针: {}", *ptr3);
     // *ptr3 = 40;  // 错误：不能修改值
     // ptr3 = &b;   // 错误：不能修改指针
 }
@@ -541,19 +741,20 @@ void constPointerExample() {
 // ==================== 8. 多级指针 ====================
 
 void multiLevelPointerExample() {
-    std::cout << "\n=== 多级指针 ===" << std::endl;
+    LOG_INFO("\n=== 多级指针 ===");
 
     int value = 42;
     int* ptr = &value;
     int** ptr_to_ptr = &ptr;
     int*** ptr_to_ptr_to_ptr = &ptr_to_ptr;
 
-    std::cout << "原始值: " << value << std::endl;
-    std::cout << "通过指针访问: " << *ptr << std::endl;
-    std::cout << "通过二级指针访问: " << **ptr_to_ptr << std::endl;
-    std::cout << "通过三级指针访问: " << ***ptr_to_ptr_to_ptr << std::endl;
+    LOG_INFO("原始值: {}", value);
+    LOG_INFO("通过指针访问: {}", *ptr);
+    LOG_INFO("通过二级指针访问: {}", **ptr_to_ptr);
+    LOG_INFO("通过三级指针访问: {}", ***ptr_to_ptr_to_ptr);
 
     // 动态分配二维数组
+    const alloc_tracker::SiteStats before = alloc_tracker::totals();
     int rows = 3, cols = 4;
     int** matrix = new int*[rows];
     for (int i = 0; i < rows; ++i) {
@@ -563,12 +764,13 @@ void multiLevelPointerExample() {
         }
     }
 
-    std::cout << "动态二维数组:" << std::endl;
+    LOG_INFO("动态二维数组:");
     for (int i = 0; i < rows; ++i) {
+        std::string row;  // 短字符串不分配，不影响下面的分配统计
         for (int j = 0; j < cols; ++j) {
-            std::cout << matrix[i][j] << "\t";
+            row += std::to_string(matrix[i][j]) + "\t";
         }
-        std::cout << std::endl;
+        LOG_INFO("{}", row);
     }
 
     // 释放内存
@@ -576,18 +778,76 @@ void multiLevelPointerExample() {
         delete[] matrix[i];
     }
     delete[] matrix;
+    const alloc_tracker::SiteStats after = alloc_tracker::totals();
+    LOG_INFO("分配追踪: 分配 {} 次, 释放 {} 次, 没有泄漏: {}", after.allocations - before.allocations,
+             after.frees - before.frees, (after.liveObjects() == before.liveObjects() ? "是" : "否"));
+
+    // 更好的做法：一次分配、连续存储的 Matrix，行与行之间没有额外的指针跳转
+    Matrix<int> contiguous(rows, cols, true);  // 每行补齐到 64 字节
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            contiguous(i, j) = i * cols + j;
+        }
+    }
+    LOG_INFO("连续存储的矩阵: 1 次分配（int** 需要 {} 次），每行间隔 {} 个 int", rows + 1, contiguous.stride());
+
+    Matrix<int> transposed;
+    transposeBlocked(contiguous, transposed);
+    std::string values;
+    for (int val : transposed.row(0)) {
+        values += std::to_string(val) + " ";
+    }
+    LOG_INFO("转置后第 0 行: {}", values);
+}
+
+// ==================== 单例和每线程实例 ====================
+
+struct AppConfig {
+    AppConfig() { LOG_INFO("AppConfig 构造（只会发生一次）"); }
+
+    int max_connections = 128;
+};
+
+void singletonExample() {
+    LOG_INFO("\n=== 单例和每线程实例 ===");
+
+    PerThread<uint64_t> requests;  // 每个线程各记各的，互不争用
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&requests]() {
+            for (int i = 0; i < 1000; ++i) {
+                // 几个线程第一次同时访问，也只会构造一次
+                if (Singleton<AppConfig>::instance().max_connections > 0) {
+                    ++requests.local();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    uint64_t total = 0;
+    requests.forEach([&total](uint64_t count) { total += count; });
+    LOG_INFO("最大连接数: {}", Singleton<AppConfig>::instance().max_connections);
+    LOG_INFO("PerThread 计数: {} 个实例，合计 {}", requests.instances(), total);
 }
 
 // ==================== 主函数 ====================
 
 int main() {
-    SetConsoleOutputCP(CP_UTF8);  // 设置控制台输出为UTF-8
+    setupConsole();
     pointerVsReference();
     smartPointerExamples();
+    intrusivePtrExample();
     // weak_ptr 的具体使用场景
     parentChildCircularReference();
+    arenaTreeExample();
     observerPatternExample();
+    asyncObserverExample();
     cacheExample();
+    concurrentCacheExample();
+    metricsExample();
 
     danglingPointerExample();
     pointerArrayVsArrayPointer();
@@ -595,6 +855,7 @@ int main() {
     referenceParameterExample();
     constPointerExample();
     multiLevelPointerExample();
+    singletonExample();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,168 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 队列基准：MpmcQueue（单个 push/pop 和批量 push_n/pop_n）对比 BlockingQueue，
+// 在不同的生产者/消费者数量下测吞吐量（ops/s）和 p99 延迟（从入队到出队）。
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mpmc_queue.h"
+
+constexpr uint64_t kStop = ~0ull;  // 毒丸：消费者收到后退出
+constexpr size_t kBatch = 32;
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct RunResult {
+    double ops_per_sec;
+    uint64_t p99_ns;
+};
+
+RunResult summarize(double seconds, uint64_t total, std::vector<std::vector<uint32_t>>& latencies) {
+    std::vector<uint32_t> all;
+    for (auto& local : latencies) {
+        all.insert(all.end(), local.begin(), local.end());
+    }
+    uint64_t p99 = 0;
+    if (!all.empty()) {
+        auto nth = all.begin() + static_cast<std::ptrdiff_t>(all.size() * 99 / 100);
+        std::nth_element(all.begin(), nth, all.end());
+        p99 = *nth;
+    }
+    return {total / seconds, p99};
+}
+
+// 每条消息就是入队时刻的时间戳；Queue 需要提供 push/pop
+template <typename Queue>
+RunResult runSingle(Queue& queue, unsigned producers, unsigned consumers, uint64_t per_producer) {
+    std::vector<std::vector<uint32_t>> latencies(consumers);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c]() {
+            auto& local = latencies[c];
+            local.reserve(producers * per_producer / consumers + 1);
+            for (;;) {
+                uint64_t stamp = queue.pop();
+                if (stamp == kStop) {
+                    break;
+                }
+                local.push_back(static_cast<uint32_t>(std::min<uint64_t>(nowNs() - stamp, UINT32_MAX)));
+            }
+        });
+    }
+    std::vector<std::thread> producer_threads;
+    for (unsigned p = 0; p < producers; ++p) {
+        producer_threads.emplace_back([&]() {
+            for (uint64_t i = 0; i < per_producer; ++i) {
+                queue.push(nowNs());
+            }
+        });
+    }
+    for (auto& t : producer_threads) {
+        t.join();
+    }
+    for (unsigned c = 0; c < consumers; ++c) {
+        queue.push(kStop);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summarize(seconds, producers * per_producer, latencies);
+}
+
+RunResult runBatched(MpmcQueue<uint64_t>& queue, unsigned producers, unsigned consumers, uint64_t per_producer) {
+    std::vector<std::vector<uint32_t>> latencies(consumers);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c]() {
+            auto& local = latencies[c];
+            local.reserve(producers * per_producer / consumers + 1);
+            uint64_t buffer[kBatch];
+            bool stopped = false;
+            while (!stopped) {
+                size_t n = queue.pop_n(buffer, kBatch);
+                uint64_t now = nowNs();
+                for (size_t i = 0; i < n; ++i) {
+                    if (buffer[i] == kStop) {
+                        stopped = true;
+                        // 毒丸在所有生产者结束后才入队，所以同一批里后面的也都是毒丸，还给其他消费者
+                        for (size_t j = i + 1; j < n; ++j) {
+                            queue.push(buffer[j]);
+                        }
+                        break;
+                    }
+                    local.push_back(static_cast<uint32_t>(std::min<uint64_t>(now - buffer[i], UINT32_MAX)));
+                }
+            }
+        });
+    }
+    std::vector<std::thread> producer_threads;
+    for (unsigned p = 0; p < producers; ++p) {
+        producer_threads.emplace_back([&]() {
+            uint64_t buffer[kBatch];
+            for (uint64_t i = 0; i < per_producer; i += kBatch) {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(kBatch, per_producer - i));
+                uint64_t stamp = nowNs();
+                std::fill(buffer, buffer + n, stamp);
+                queue.push_n(buffer, n);
+            }
+        });
+    }
+    for (auto& t : producer_threads) {
+        t.join();
+    }
+    for (unsigned c = 0; c < consumers; ++c) {
+        queue.push(kStop);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summarize(seconds, producers * per_producer, latencies);
+}
+
+void printResult(const char* name, const RunResult& result) {
+    std::cout << "  " << name << result.ops_per_sec / 1e6 << " M ops/s, p99 " << result.p99_ns << " ns" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    // 第一个参数：最大生产者/消费者数，默认每个核心一个
+    const unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::stoul(argv[1]))
+                                          : std::max(1u, std::thread::hardware_concurrency());
+    const uint64_t total_items = 2000000;
+    const size_t capacity = 4096;
+
+    std::cout << "队列容量: " << capacity << "，每轮消息数: " << total_items << std::endl;
+
+    for (unsigned producers = 1; producers <= max_threads; producers *= 2) {
+        for (unsigned consumers = 1; consumers <= max_threads; consumers *= 2) {
+            const uint64_t per_producer = total_items / producers;
+            std::cout << "生产者 " << producers << "，消费者 " << consumers << ":" << std::endl;
+
+            BlockingQueue<uint64_t> blocking(capacity);
+            printResult("mutex+condvar:    ", runSingle(blocking, producers, consumers, per_producer));
+
+            MpmcQueue<uint64_t> lock_free(capacity);
+            printResult("MpmcQueue:        ", runSingle(lock_free, producers, consumers, per_producer));
+
+            MpmcQueue<uint64_t> batched(capacity);
+            printResult("MpmcQueue 批量32: ", runBatched(batched, producers, consumers, per_producer));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_REPORT_WRITER_H
+#define HANDS_ON_CPP_REPORT_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// ==================== 信号安全的报告输出 ====================
+// 只用栈上缓冲和 write，不分配内存，可以在信号处理函数和替换后的 operator new 里用。
+// 析构时写出剩余内容。
+
+class ReportWriter {
+public:
+    explicit ReportWriter(int fd) : fd_(fd) {}
+    ~ReportWriter() { flush(); }
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    ReportWriter& text(const char* s) {
+        while (*s) {
+            put(*s++);
+        }
+        return *this;
+    }
+
+    ReportWriter& number(uint64_t value, int width = 0) {
+        char digits[24];
+        int n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        for (int i = n; i < width; ++i) {
+            put(' ');
+        }
+        while (n > 0) {
+            put(digits[--n]);
+        }
+        return *this;
+    }
+
+    ReportWriter& hex(uintptr_t value) {
+        text("0x");
+        char digits[2 * sizeof(uintptr_t)];
+        int n = 0;
+        do {
+            digits[n++] = "0123456789abcdef"[value & 0xF];
+            value >>= 4;
+        } while (value != 0);
+        while (n > 0) {
+            put(digits[--n]);
+        }
+        return *this;
+    }
+
+    void flush() {
+        size_t written = 0;
+        while (written < size_) {
+#ifdef _WIN32
+            int n = _write(fd_, buffer_ + written, static_cast<unsigned>(size_ - written));
+#else
+            ssize_t n = write(fd_, buffer_ + written, size_ - written);
+#endif
+            if (n <= 0) {
+                break;
+            }
+            written += static_cast<size_t>(n);
+        }
+        size_ = 0;
+    }
+
+private:
+    void put(char c) {
+        if (size_ == sizeof(buffer_)) {
+            flush();
+        }
+        buffer_[size_++] = c;
+    }
+
+    int fd_;
+    char buffer_[1024];
+    size_t size_ = 0;
+};
+
+#endif //HANDS_ON_CPP_REPORT_WRITER_H
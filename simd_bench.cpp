@@ -0,0 +1,113 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 向量化算子基准：每个算子、每种元素类型，在不同缓冲区大小下对比各指令集版本的 GB/s。
+// 同时拿标量版本的结果做校验（整数要求完全一致，浮点允许舍入误差）。
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "simd_kernels.h"
+
+using Clock = std::chrono::steady_clock;
+
+const simd::Isa kAllIsas[] = {simd::Isa::Scalar, simd::Isa::Sse42, simd::Isa::Avx2, simd::Isa::Avx512};
+
+template <typename T>
+std::vector<T> randomValues(size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<T> values(n);
+    for (auto& v : values) {
+        v = static_cast<T>(static_cast<int64_t>(rng() % 2001) - 1000);
+    }
+    return values;
+}
+
+// 浮点累加顺序不同会有舍入误差，误差上界大致是 n * eps * max|x|（这里 max|x| = 1000）
+template <typename T>
+bool closeEnough(T expected, T actual, size_t n) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return std::fabs(expected - actual) <= 1e-6 * 1000 * static_cast<double>(n + 1);
+    } else {
+        return expected == actual;
+    }
+}
+
+// 反复运行 fn 直到累计超过 min_seconds，返回 GB/s
+template <typename Fn>
+double measure(size_t bytes_per_call, Fn fn) {
+    const double min_seconds = 0.05;
+    size_t calls = 0;
+    auto start = Clock::now();
+    double elapsed = 0;
+    do {
+        fn();
+        ++calls;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < min_seconds);
+    return static_cast<double>(bytes_per_call) * calls / elapsed / 1e9;
+}
+
+template <typename T>
+void benchType(const char* type_name, const std::vector<size_t>& sizes) {
+    for (size_t bytes : sizes) {
+        const size_t n = bytes / sizeof(T);
+        std::vector<T> a = randomValues<T>(n, 1);
+        std::vector<T> b = randomValues<T>(n, 2);
+        std::vector<T> out(n);
+
+        // 先用标量版本算出参考结果
+        simd::setActiveIsa(simd::Isa::Scalar);
+        const T ref_sum = simd::sum(std::span<const T>(a));
+        const auto ref_minmax = simd::minMax(std::span<const T>(a));
+        const T ref_dot = simd::dot(std::span<const T>(a), std::span<const T>(b));
+        simd::prefixSum(std::span<const T>(a), std::span<T>(out));
+        const T ref_last = n > 0 ? out[n - 1] : T{};
+
+        std::cout << type_name << " " << bytes / 1024 << " KB (GB/s):" << std::endl;
+        for (simd::Isa isa : kAllIsas) {
+            if (!simd::setActiveIsa(isa)) {
+                continue;
+            }
+            volatile T sink{};
+            double sum_gbps = measure(bytes, [&]() { sink = simd::sum(std::span<const T>(a)); });
+            double minmax_gbps = measure(bytes, [&]() { sink = simd::minMax(std::span<const T>(a)).max; });
+            double dot_gbps = measure(2 * bytes, [&]() {
+                sink = simd::dot(std::span<const T>(a), std::span<const T>(b));
+            });
+            double prefix_gbps = measure(2 * bytes, [&]() {
+                simd::prefixSum(std::span<const T>(a), std::span<T>(out));
+            });
+
+            bool ok = closeEnough(ref_sum, simd::sum(std::span<const T>(a)), n) &&
+                      simd::minMax(std::span<const T>(a)).min == ref_minmax.min &&
+                      simd::minMax(std::span<const T>(a)).max == ref_minmax.max &&
+                      closeEnough(ref_dot, simd::dot(std::span<const T>(a), std::span<const T>(b)), n * 1000) &&
+                      (n == 0 || closeEnough(ref_last, out[n - 1], n));
+
+            std::cout << "  " << std::left << std::setw(8) << simd::isaName(isa) << std::right << std::fixed
+                      << std::setprecision(2) << " sum " << std::setw(7) << sum_gbps
+                      << "  minmax " << std::setw(7) << minmax_gbps << "  dot " << std::setw(7) << dot_gbps
+                      << "  prefix " << std::setw(7) << prefix_gbps << (ok ? "" : "  结果不一致!") << std::endl;
+        }
+    }
+}
+
+int main() {
+    std::cout << "CPUID 检测到的指令集: " << simd::isaName(simd::detectIsa()) << std::endl;
+
+    // 从 L1 到超出 LLC
+    const std::vector<size_t> sizes = {4 << 10, 32 << 10, 256 << 10, 2 << 20, 16 << 20, 128 << 20};
+    benchType<int32_t>("int32", sizes);
+    benchType<int64_t>("int64", sizes);
+    benchType<float>("float", sizes);
+
+    return 0;
+}
@@ -0,0 +1,310 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 标量版本和运行时分派。标量版本用 -fno-tree-vectorize 编译（见 CMakeLists.txt），作为对照基准。
+
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <limits>
+#include <vector>
+
+#include "simd_kernels_impl.h"
+
+namespace simd {
+namespace detail {
+
+namespace {
+
+template <typename T>
+T scalarSum(const T* p, size_t n) {
+    T total{};
+    for (size_t i = 0; i < n; ++i) {
+        total += p[i];
+    }
+    return total;
+}
+
+template <typename T>
+MinMax<T> scalarMinMax(const T* p, size_t n) {
+    MinMax<T> result{std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest()};
+    for (size_t i = 0; i < n; ++i) {
+        result.min = p[i] < result.min ? p[i] : result.min;
+        result.max = p[i] > result.max ? p[i] : result.max;
+    }
+    return result;
+}
+
+template <typename T>
+T scalarDot(const T* a, const T* b, size_t n) {
+    T total{};
+    for (size_t i = 0; i < n; ++i) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+template <typename T>
+void scalarPrefixSum(const T* in, T* out, size_t n) {
+    T running{};
+    for (size_t i = 0; i < n; ++i) {
+        running += in[i];
+        out[i] = running;
+    }
+}
+
+template <typename T>
+void scalarSwapRanges(T* a, T* b, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const T t = a[i];
+        a[i] = b[i];
+        b[i] = t;
+    }
+}
+
+template <typename T>
+void scalarReverse(T* p, size_t n) {
+    for (size_t lo = 0, hi = n; hi - lo >= 2; ++lo) {
+        --hi;
+        const T t = p[lo];
+        p[lo] = p[hi];
+        p[hi] = t;
+    }
+}
+
+template <typename T>
+void scalarGather(const T* in, const uint32_t* index, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = in[index[i]];
+    }
+}
+
+template <typename T>
+void scalarScatter(const T* in, const uint32_t* index, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[index[i]] = in[i];
+    }
+}
+
+}  // namespace
+
+const KernelTable* scalarKernels() {
+    static const KernelTable table = {
+        &scalarSum<int32_t>, &scalarSum<int64_t>, &scalarSum<float>,
+        &scalarMinMax<int32_t>, &scalarMinMax<int64_t>, &scalarMinMax<float>,
+        &scalarDot<int32_t>, &scalarDot<int64_t>, &scalarDot<float>,
+        &scalarPrefixSum<int32_t>, &scalarPrefixSum<int64_t>, &scalarPrefixSum<float>,
+        &scalarSwapRanges<int32_t>, &scalarSwapRanges<int64_t>, &scalarSwapRanges<float>,
+        &scalarReverse<int32_t>, &scalarReverse<int64_t>, &scalarReverse<float>,
+        &scalarGather<int32_t>, &scalarGather<int64_t>, &scalarGather<float>,
+        &scalarScatter<int32_t>, &scalarScatter<int64_t>, &scalarScatter<float>,
+    };
+    return &table;
+}
+
+}  // namespace detail
+
+namespace {
+
+bool cpuSupports(Isa isa) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    // __builtin_cpu_supports 读取 CPUID，并通过 XGETBV 确认操作系统会保存 AVX/AVX-512 寄存器
+    __builtin_cpu_init();
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+        case Isa::Sse42:
+            return __builtin_cpu_supports("sse4.2");
+        case Isa::Avx2:
+            return __builtin_cpu_supports("avx2");
+        case Isa::Avx512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+                   __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl");
+    }
+    return false;
+#else
+    return isa == Isa::Scalar;
+#endif
+}
+
+const detail::KernelTable* tableFor(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar:
+            return detail::scalarKernels();
+        case Isa::Sse42:
+            return detail::sse42Kernels();
+        case Isa::Avx2:
+            return detail::avx2Kernels();
+        case Isa::Avx512:
+            return detail::avx512Kernels();
+    }
+    return nullptr;
+}
+
+struct Dispatch {
+    std::atomic<const detail::KernelTable*> table;
+    std::atomic<Isa> isa;
+
+    Dispatch() : table(detail::scalarKernels()), isa(Isa::Scalar) {
+        Isa best = detectIsa();
+        table.store(tableFor(best));
+        isa.store(best);
+    }
+};
+
+Dispatch& dispatch() {
+    static Dispatch instance;
+    return instance;
+}
+
+const detail::KernelTable& kernels() {
+    return *dispatch().table.load(std::memory_order_relaxed);
+}
+
+// 每个环从最小的未访问下标出发，先取出起点的值，沿 perm 依次把后继搬过来，最后把起点的值放到环尾。
+// 标记位图里超出 n 的位预先置 1，扫描时整字跳过已经处理完的 64 个元素
+template <typename T>
+void permuteCycles(T* values, const uint32_t* perm, size_t n) {
+    std::vector<uint64_t> done((n + 63) / 64);
+    if (n % 64 != 0) {
+        done.back() = ~uint64_t{0} << (n % 64);
+    }
+    for (size_t word = 0; word < done.size(); ++word) {
+        while (done[word] != ~uint64_t{0}) {
+            const size_t start = word * 64 + static_cast<size_t>(std::countr_one(done[word]));
+            const T carried = values[start];
+            size_t j = start;
+            for (;;) {
+                done[j / 64] |= uint64_t{1} << (j % 64);
+                const size_t k = perm[j];
+                if (k == start) {
+                    values[j] = carried;
+                    break;
+                }
+                values[j] = values[k];
+                j = k;
+            }
+        }
+    }
+}
+
+}  // namespace
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar:
+            return "scalar";
+        case Isa::Sse42:
+            return "sse4.2";
+        case Isa::Avx2:
+            return "avx2";
+        case Isa::Avx512:
+            return "avx512";
+    }
+    return "unknown";
+}
+
+Isa detectIsa() {
+    for (Isa isa : {Isa::Avx512, Isa::Avx2, Isa::Sse42}) {
+        if (cpuSupports(isa) && tableFor(isa) != nullptr) {
+            return isa;
+        }
+    }
+    return Isa::Scalar;
+}
+
+Isa activeIsa() {
+    return dispatch().isa.load(std::memory_order_relaxed);
+}
+
+bool setActiveIsa(Isa isa) {
+    const detail::KernelTable* table = tableFor(isa);
+    if (!table || !cpuSupports(isa)) {
+        return false;
+    }
+    dispatch().table.store(table, std::memory_order_relaxed);
+    dispatch().isa.store(isa, std::memory_order_relaxed);
+    return true;
+}
+
+int32_t sum(std::span<const int32_t> values) { return kernels().sum_i32(values.data(), values.size()); }
+int64_t sum(std::span<const int64_t> values) { return kernels().sum_i64(values.data(), values.size()); }
+float sum(std::span<const float> values) { return kernels().sum_f32(values.data(), values.size()); }
+
+MinMax<int32_t> minMax(std::span<const int32_t> values) {
+    return kernels().minmax_i32(values.data(), values.size());
+}
+MinMax<int64_t> minMax(std::span<const int64_t> values) {
+    return kernels().minmax_i64(values.data(), values.size());
+}
+MinMax<float> minMax(std::span<const float> values) {
+    return kernels().minmax_f32(values.data(), values.size());
+}
+
+int32_t dot(std::span<const int32_t> a, std::span<const int32_t> b) {
+    return kernels().dot_i32(a.data(), b.data(), std::min(a.size(), b.size()));
+}
+int64_t dot(std::span<const int64_t> a, std::span<const int64_t> b) {
+    return kernels().dot_i64(a.data(), b.data(), std::min(a.size(), b.size()));
+}
+float dot(std::span<const float> a, std::span<const float> b) {
+    return kernels().dot_f32(a.data(), b.data(), std::min(a.size(), b.size()));
+}
+
+void prefixSum(std::span<const int32_t> in, std::span<int32_t> out) {
+    kernels().prefix_i32(in.data(), out.data(), std::min(in.size(), out.size()));
+}
+void prefixSum(std::span<const int64_t> in, std::span<int64_t> out) {
+    kernels().prefix_i64(in.data(), out.data(), std::min(in.size(), out.size()));
+}
+void prefixSum(std::span<const float> in, std::span<float> out) {
+    kernels().prefix_f32(in.data(), out.data(), std::min(in.size(), out.size()));
+}
+
+void swapRanges(std::span<int32_t> a, std::span<int32_t> b) {
+    kernels().swap_i32(a.data(), b.data(), std::min(a.size(), b.size()));
+}
+void swapRanges(std::span<int64_t> a, std::span<int64_t> b) {
+    kernels().swap_i64(a.data(), b.data(), std::min(a.size(), b.size()));
+}
+void swapRanges(std::span<float> a, std::span<float> b) {
+    kernels().swap_f32(a.data(), b.data(), std::min(a.size(), b.size()));
+}
+
+void reverse(std::span<int32_t> values) { kernels().reverse_i32(values.data(), values.size()); }
+void reverse(std::span<int64_t> values) { kernels().reverse_i64(values.data(), values.size()); }
+void reverse(std::span<float> values) { kernels().reverse_f32(values.data(), values.size()); }
+
+void gather(std::span<const int32_t> in, std::span<const uint32_t> index, std::span<int32_t> out) {
+    kernels().gather_i32(in.data(), index.data(), out.data(), std::min(index.size(), out.size()));
+}
+void gather(std::span<const int64_t> in, std::span<const uint32_t> index, std::span<int64_t> out) {
+    kernels().gather_i64(in.data(), index.data(), out.data(), std::min(index.size(), out.size()));
+}
+void gather(std::span<const float> in, std::span<const uint32_t> index, std::span<float> out) {
+    kernels().gather_f32(in.data(), index.data(), out.data(), std::min(index.size(), out.size()));
+}
+
+void scatter(std::span<const int32_t> in, std::span<const uint32_t> index, std::span<int32_t> out) {
+    kernels().scatter_i32(in.data(), index.data(), out.data(), std::min(in.size(), index.size()));
+}
+void scatter(std::span<const int64_t> in, std::span<const uint32_t> index, std::span<int64_t> out) {
+    kernels().scatter_i64(in.data(), index.data(), out.data(), std::min(in.size(), index.size()));
+}
+void scatter(std::span<const float> in, std::span<const uint32_t> index, std::span<float> out) {
+    kernels().scatter_f32(in.data(), index.data(), out.data(), std::min(in.size(), index.size()));
+}
+
+void permuteInPlace(std::span<int32_t> values, std::span<const uint32_t> perm) {
+    permuteCycles(values.data(), perm.data(), std::min(values.size(), perm.size()));
+}
+void permuteInPlace(std::span<int64_t> values, std::span<const uint32_t> perm) {
+    permuteCycles(values.data(), perm.data(), std::min(values.size(), perm.size()));
+}
+void permuteInPlace(std::span<float> values, std::span<const uint32_t> perm) {
+    permuteCycles(values.data(), perm.data(), std::min(values.size(), perm.size()));
+}
+
+}  // namespace simd
@@ -0,0 +1,94 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_SIMD_KERNELS_H
+#define HANDS_ON_CPP_SIMD_KERNELS_H
+
+#include <cstdint>
+#include <span>
+
+// ==================== 向量化算子库 ====================
+// 归约（求和、最值、点积、前缀和）和批量重排（交换、反转、gather/scatter、原地置换）。
+// 同一组算子分别有标量、SSE4.2、AVX2、AVX-512 四个版本，
+// 第一次调用时根据 CPUID 选出当前 CPU 支持的最高版本，之后都走这个版本。
+// 整数求和、点积、前缀和都按补码回绕（和普通的 int 循环一致），不做溢出检查。
+
+namespace simd {
+
+enum class Isa {
+    Scalar,
+    Sse42,
+    Avx2,
+    Avx512,
+};
+
+template <typename T>
+struct MinMax {
+    T min;
+    T max;
+};
+
+const char* isaName(Isa isa);
+
+// CPUID 检测到的最高可用指令集
+Isa detectIsa();
+
+// 当前使用的指令集；setActiveIsa 用于基准测试里强制切换，CPU 不支持时返回 false
+Isa activeIsa();
+bool setActiveIsa(Isa isa);
+
+int32_t sum(std::span<const int32_t> values);
+int64_t sum(std::span<const int64_t> values);
+float sum(std::span<const float> values);
+
+// 空区间返回 {类型最大值, 类型最小值}
+MinMax<int32_t> minMax(std::span<const int32_t> values);
+MinMax<int64_t> minMax(std::span<const int64_t> values);
+MinMax<float> minMax(std::span<const float> values);
+
+// 长度不一致时按较短的那个计算
+int32_t dot(std::span<const int32_t> a, std::span<const int32_t> b);
+int64_t dot(std::span<const int64_t> a, std::span<const int64_t> b);
+float dot(std::span<const float> a, std::span<const float> b);
+
+// 包含式前缀和：out[i] = in[0] + ... + in[i]；out 可以和 in 是同一块内存，长度取两者较小值
+void prefixSum(std::span<const int32_t> in, std::span<int32_t> out);
+void prefixSum(std::span<const int64_t> in, std::span<int64_t> out);
+void prefixSum(std::span<const float> in, std::span<float> out);
+
+// ==================== 批量交换和重排 ====================
+// 下标是 uint32_t，数组长度不能超过 2^31（gather/scatter 指令把下标当作有符号 32 位数）。
+
+// 交换两段区间的内容，长度取较小值；两段不能重叠
+void swapRanges(std::span<int32_t> a, std::span<int32_t> b);
+void swapRanges(std::span<int64_t> a, std::span<int64_t> b);
+void swapRanges(std::span<float> a, std::span<float> b);
+
+// 原地反转
+void reverse(std::span<int32_t> values);
+void reverse(std::span<int64_t> values);
+void reverse(std::span<float> values);
+
+// out[i] = in[index[i]]，长度取 index 和 out 的较小值；in 和 out 不能重叠
+void gather(std::span<const int32_t> in, std::span<const uint32_t> index, std::span<int32_t> out);
+void gather(std::span<const int64_t> in, std::span<const uint32_t> index, std::span<int64_t> out);
+void gather(std::span<const float> in, std::span<const uint32_t> index, std::span<float> out);
+
+// out[index[i]] = in[i]，长度取 in 和 index 的较小值；index 有重复时保留其中任意一个
+void scatter(std::span<const int32_t> in, std::span<const uint32_t> index, std::span<int32_t> out);
+void scatter(std::span<const int64_t> in, std::span<const uint32_t> index, std::span<int64_t> out);
+void scatter(std::span<const float> in, std::span<const uint32_t> index, std::span<float> out);
+
+// 原地重排：values[i] 变成原来的 values[perm[i]]（和 gather 的含义一样）。
+// 沿置换环移动，每个元素只读写一次，额外空间只有 n 位的标记；perm 必须是 0..n-1 的一个排列。
+// 环上每一步都依赖上一步的下标，没有向量化版本，所有指令集共用这一份实现。
+// 随机排列下每一步都是一次串行的缓存缺失，比 gather 到临时数组再拷回慢一个数量级（见 permute_bench），
+// 只在放不下第二份数组时使用
+void permuteInPlace(std::span<int32_t> values, std::span<const uint32_t> perm);
+void permuteInPlace(std::span<int64_t> values, std::span<const uint32_t> perm);
+void permuteInPlace(std::span<float> values, std::span<const uint32_t> perm);
+
+}  // namespace simd
+
+#endif //HANDS_ON_CPP_SIMD_KERNELS_H
@@ -0,0 +1,18 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 32 字节向量版本，需要用对应的指令集选项编译（见 CMakeLists.txt）
+
+#include "simd_kernels_impl.h"
+
+namespace simd::detail {
+
+const KernelTable* avx2Kernels() {
+#if defined(__AVX2__)
+    return makeVectorTable<32>();
+#else
+    return nullptr;
+#endif
+}
+
+}  // namespace simd::detail
@@ -0,0 +1,18 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 64 字节向量版本，需要用对应的指令集选项编译（见 CMakeLists.txt）
+
+#include "simd_kernels_impl.h"
+
+namespace simd::detail {
+
+const KernelTable* avx512Kernels() {
+#if defined(__AVX512F__)
+    return makeVectorTable<64>();
+#else
+    return nullptr;
+#endif
+}
+
+}  // namespace simd::detail
@@ -0,0 +1,365 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_SIMD_KERNELS_IMPL_H
+#define HANDS_ON_CPP_SIMD_KERNELS_IMPL_H
+
+// 只给 simd_kernels*.cpp 使用。
+// 用 GCC 的向量扩展写一份通用实现，每个指令集一个 .cpp，用不同的 -m 选项编译同一份模板：
+// 16 字节向量在 -msse4.2 下变成 SSE 指令，32 字节在 -mavx2 下变成 AVX2，64 字节在 -mavx512f 下变成 AVX-512。
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "simd_kernels.h"
+
+// gather/scatter 没法用向量扩展表达，AVX2/AVX-512 版本直接用对应指令
+#if defined(__GNUC__) && (defined(__AVX2__) || defined(__AVX512F__))
+#include <immintrin.h>
+#endif
+
+namespace simd::detail {
+
+// 每个指令集一张函数表，由 simd_kernels.cpp 在运行时挑选
+struct KernelTable {
+    int32_t (*sum_i32)(const int32_t*, size_t);
+    int64_t (*sum_i64)(const int64_t*, size_t);
+    float (*sum_f32)(const float*, size_t);
+
+    MinMax<int32_t> (*minmax_i32)(const int32_t*, size_t);
+    MinMax<int64_t> (*minmax_i64)(const int64_t*, size_t);
+    MinMax<float> (*minmax_f32)(const float*, size_t);
+
+    int32_t (*dot_i32)(const int32_t*, const int32_t*, size_t);
+    int64_t (*dot_i64)(const int64_t*, const int64_t*, size_t);
+    float (*dot_f32)(const float*, const float*, size_t);
+
+    void (*prefix_i32)(const int32_t*, int32_t*, size_t);
+    void (*prefix_i64)(const int64_t*, int64_t*, size_t);
+    void (*prefix_f32)(const float*, float*, size_t);
+
+    void (*swap_i32)(int32_t*, int32_t*, size_t);
+    void (*swap_i64)(int64_t*, int64_t*, size_t);
+    void (*swap_f32)(float*, float*, size_t);
+
+    void (*reverse_i32)(int32_t*, size_t);
+    void (*reverse_i64)(int64_t*, size_t);
+    void (*reverse_f32)(float*, size_t);
+
+    void (*gather_i32)(const int32_t*, const uint32_t*, int32_t*, size_t);
+    void (*gather_i64)(const int64_t*, const uint32_t*, int64_t*, size_t);
+    void (*gather_f32)(const float*, const uint32_t*, float*, size_t);
+
+    void (*scatter_i32)(const int32_t*, const uint32_t*, int32_t*, size_t);
+    void (*scatter_i64)(const int64_t*, const uint32_t*, int64_t*, size_t);
+    void (*scatter_f32)(const float*, const uint32_t*, float*, size_t);
+};
+
+// 编译器不支持对应指令集时返回 nullptr
+const KernelTable* scalarKernels();
+const KernelTable* sse42Kernels();
+const KernelTable* avx2Kernels();
+const KernelTable* avx512Kernels();
+
+#if defined(__GNUC__)
+
+// 放在匿名命名空间里：每个 .cpp 用不同的 -m 选项编译，不能让链接器把某个 AVX-512 版本的实例合并给其他版本用
+namespace {
+
+template <typename T, size_t Bytes>
+struct VecOf {
+    typedef T type __attribute__((vector_size(Bytes)));
+};
+
+// __builtin_shuffle 的掩码必须是和元素等宽的整数向量
+template <typename T>
+struct MaskElem;
+template <>
+struct MaskElem<int32_t> { using type = int32_t; };
+template <>
+struct MaskElem<float> { using type = int32_t; };
+template <>
+struct MaskElem<int64_t> { using type = int64_t; };
+
+template <typename T, size_t Bytes>
+struct VectorKernels {
+    using V = typename VecOf<T, Bytes>::type;
+    using M = typename VecOf<typename MaskElem<T>::type, Bytes>::type;
+    static constexpr size_t kLanes = Bytes / sizeof(T);
+
+    static V load(const T* p) {
+        V v;
+        __builtin_memcpy(&v, p, sizeof(V));
+        return v;
+    }
+
+    static void store(T* p, V v) { __builtin_memcpy(p, &v, sizeof(V)); }
+
+    static T sum(const T* p, size_t n) {
+        // 4 个独立的累加器，隐藏加法延迟
+        V acc0{}, acc1{}, acc2{}, acc3{};
+        size_t i = 0;
+        for (; i + 4 * kLanes <= n; i += 4 * kLanes) {
+            acc0 += load(p + i);
+            acc1 += load(p + i + kLanes);
+            acc2 += load(p + i + 2 * kLanes);
+            acc3 += load(p + i + 3 * kLanes);
+        }
+        for (; i + kLanes <= n; i += kLanes) {
+            acc0 += load(p + i);
+        }
+        V acc = (acc0 + acc1) + (acc2 + acc3);
+        T total{};
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            total += acc[lane];
+        }
+        for (; i < n; ++i) {
+            total += p[i];
+        }
+        return total;
+    }
+
+    static MinMax<T> minMax(const T* p, size_t n) {
+        MinMax<T> result{std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest()};
+        size_t i = 0;
+        if (n >= kLanes) {
+            V lo = load(p);
+            V hi = lo;
+            for (i = kLanes; i + kLanes <= n; i += kLanes) {
+                V v = load(p + i);
+                lo = v < lo ? v : lo;
+                hi = v > hi ? v : hi;
+            }
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                result.min = lo[lane] < result.min ? lo[lane] : result.min;
+                result.max = hi[lane] > result.max ? hi[lane] : result.max;
+            }
+        }
+        for (; i < n; ++i) {
+            result.min = p[i] < result.min ? p[i] : result.min;
+            result.max = p[i] > result.max ? p[i] : result.max;
+        }
+        return result;
+    }
+
+    static T dot(const T* a, const T* b, size_t n) {
+        V acc0{}, acc1{};
+        size_t i = 0;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            acc0 += load(a + i) * load(b + i);
+            acc1 += load(a + i + kLanes) * load(b + i + kLanes);
+        }
+        for (; i + kLanes <= n; i += kLanes) {
+            acc0 += load(a + i) * load(b + i);
+        }
+        V acc = acc0 + acc1;
+        T total{};
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            total += acc[lane];
+        }
+        for (; i < n; ++i) {
+            total += a[i] * b[i];
+        }
+        return total;
+    }
+
+    // 向量内做 log2(lanes) 次"左移 k 个元素再相加"，再加上前一个向量的最后一个元素
+    static void prefixSum(const T* in, T* out, size_t n) {
+        constexpr size_t kSteps = kLanes == 2 ? 1 : kLanes == 4 ? 2 : kLanes == 8 ? 3 : 4;
+        M shift_masks[kSteps];
+        for (size_t s = 0; s < kSteps; ++s) {
+            const size_t k = size_t(1) << s;
+            for (size_t lane = 0; lane < kLanes; ++lane) {
+                // 下标 >= kLanes 表示取第二个操作数（全零）
+                shift_masks[s][lane] = static_cast<typename MaskElem<T>::type>(lane >= k ? lane - k : kLanes);
+            }
+        }
+        M last_mask;
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            last_mask[lane] = static_cast<typename MaskElem<T>::type>(kLanes - 1);
+        }
+
+        const V zero{};
+        V carry{};
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes) {
+            V v = load(in + i);
+            for (size_t s = 0; s < kSteps; ++s) {
+                v += __builtin_shuffle(v, zero, shift_masks[s]);
+            }
+            v += carry;
+            store(out + i, v);
+            carry = __builtin_shuffle(v, last_mask);
+        }
+        T running = i > 0 ? out[i - 1] : T{};
+        for (; i < n; ++i) {
+            running += in[i];
+            out[i] = running;
+        }
+    }
+
+    static void swapRanges(T* a, T* b, size_t n) {
+        size_t i = 0;
+        for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+            const V a0 = load(a + i), a1 = load(a + i + kLanes);
+            const V b0 = load(b + i), b1 = load(b + i + kLanes);
+            store(a + i, b0);
+            store(a + i + kLanes, b1);
+            store(b + i, a0);
+            store(b + i + kLanes, a1);
+        }
+        for (; i + kLanes <= n; i += kLanes) {
+            const V a0 = load(a + i);
+            store(a + i, load(b + i));
+            store(b + i, a0);
+        }
+        for (; i < n; ++i) {
+            const T t = a[i];
+            a[i] = b[i];
+            b[i] = t;
+        }
+    }
+
+    // 两头各取一个向量，向量内反转后交换位置
+    static void reverse(T* p, size_t n) {
+        M mask;
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            mask[lane] = static_cast<typename MaskElem<T>::type>(kLanes - 1 - lane);
+        }
+        size_t lo = 0;
+        size_t hi = n;
+        while (hi - lo >= 2 * kLanes) {
+            const V front = load(p + lo);
+            const V back = load(p + hi - kLanes);
+            store(p + lo, __builtin_shuffle(back, mask));
+            store(p + hi - kLanes, __builtin_shuffle(front, mask));
+            lo += kLanes;
+            hi -= kLanes;
+        }
+        while (hi - lo >= 2) {
+            --hi;
+            const T t = p[lo];
+            p[lo] = p[hi];
+            p[hi] = t;
+            ++lo;
+        }
+    }
+
+    // 硬件 gather 处理整块，剩下的逐个读
+    static void gather(const T* in, const uint32_t* index, T* out, size_t n) {
+        size_t i = gatherBlocks(in, index, out, n);
+        for (; i < n; ++i) {
+            out[i] = in[index[i]];
+        }
+    }
+
+    // AVX2 没有 scatter 指令，只有 AVX-512 版本用硬件 scatter
+    static void scatter(const T* in, const uint32_t* index, T* out, size_t n) {
+        size_t i = scatterBlocks(in, index, out, n);
+        for (; i < n; ++i) {
+            out[index[i]] = in[i];
+        }
+    }
+
+private:
+    static size_t gatherBlocks(const T* in, const uint32_t* index, T* out, size_t n) {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        if constexpr (Bytes == 64 && sizeof(T) == 4) {
+            for (; i + 16 <= n; i += 16) {
+                const __m512i idx = _mm512_loadu_si512(index + i);
+                if constexpr (std::is_same_v<T, float>) {
+                    _mm512_storeu_ps(out + i, _mm512_i32gather_ps(idx, in, 4));
+                } else {
+                    _mm512_storeu_si512(out + i, _mm512_i32gather_epi32(idx, in, 4));
+                }
+            }
+        } else if constexpr (Bytes == 64) {
+            for (; i + 8 <= n; i += 8) {
+                const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index + i));
+                _mm512_storeu_si512(out + i, _mm512_i32gather_epi64(idx, in, 8));
+            }
+        }
+#endif
+#if defined(__AVX2__)
+        if constexpr (Bytes == 32 && sizeof(T) == 4) {
+            for (; i + 8 <= n; i += 8) {
+                const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index + i));
+                if constexpr (std::is_same_v<T, float>) {
+                    _mm256_storeu_ps(out + i, _mm256_i32gather_ps(in, idx, 4));
+                } else {
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                        _mm256_i32gather_epi32(reinterpret_cast<const int*>(in), idx, 4));
+                }
+            }
+        } else if constexpr (Bytes == 32) {
+            for (; i + 4 <= n; i += 4) {
+                const __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(index + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                    _mm256_i32gather_epi64(reinterpret_cast<const long long*>(in), idx, 8));
+            }
+        }
+#endif
+        (void)in;
+        (void)index;
+        (void)out;
+        (void)n;
+        return i;
+    }
+
+    static size_t scatterBlocks(const T* in, const uint32_t* index, T* out, size_t n) {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        if constexpr (Bytes == 64 && sizeof(T) == 4) {
+            for (; i + 16 <= n; i += 16) {
+                const __m512i idx = _mm512_loadu_si512(index + i);
+                if constexpr (std::is_same_v<T, float>) {
+                    _mm512_i32scatter_ps(out, idx, _mm512_loadu_ps(in + i), 4);
+                } else {
+                    _mm512_i32scatter_epi32(out, idx, _mm512_loadu_si512(in + i), 4);
+                }
+            }
+        } else if constexpr (Bytes == 64) {
+            for (; i + 8 <= n; i += 8) {
+                const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index + i));
+                _mm512_i32scatter_epi64(out, idx, _mm512_loadu_si512(in + i), 8);
+            }
+        }
+#endif
+        (void)in;
+        (void)index;
+        (void)out;
+        (void)n;
+        return i;
+    }
+};
+
+// 用某个向量宽度实例化出一整张函数表
+template <size_t Bytes>
+const KernelTable* makeVectorTable() {
+    using I32 = VectorKernels<int32_t, Bytes>;
+    using I64 = VectorKernels<int64_t, Bytes>;
+    using F32 = VectorKernels<float, Bytes>;
+    static const KernelTable table = {
+        &I32::sum, &I64::sum, &F32::sum,
+        &I32::minMax, &I64::minMax, &F32::minMax,
+        &I32::dot, &I64::dot, &F32::dot,
+        &I32::prefixSum, &I64::prefixSum, &F32::prefixSum,
+        &I32::swapRanges, &I64::swapRanges, &F32::swapRanges,
+        &I32::reverse, &I64::reverse, &F32::reverse,
+        &I32::gather, &I64::gather, &F32::gather,
+        &I32::scatter, &I64::scatter, &F32::scatter,
+    };
+    return &table;
+}
+
+}  // namespace
+
+#endif  // __GNUC__
+
+}  // namespace simd::detail
+
+#endif //HANDS_ON_CPP_SIMD_KERNELS_IMPL_H
@@ -0,0 +1,18 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 16 字节向量版本，需要用对应的指令集选项编译（见 CMakeLists.txt）
+
+#include "simd_kernels_impl.h"
+
+namespace simd::detail {
+
+const KernelTable* sse42Kernels() {
+#if defined(__SSE4_2__)
+    return makeVectorTable<16>();
+#else
+    return nullptr;
+#endif
+}
+
+}  // namespace simd::detail
@@ -0,0 +1,232 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_SINGLETON_H
+#define HANDS_ON_CPP_SINGLETON_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include "cache_line.h"
+
+// ==================== 线程安全的单例 ====================
+// 快路径只有一次 acquire 读指针加一次判空（x86 上就是普通的 mov），没有锁，也不碰任何共享的写。
+// 第一次访问时在慢路径上用 call_once 构造；对象放在 Singleton 自己的静态存储里（按缓存行对齐），不在堆上。
+// 对象永远不析构：避免静态析构顺序问题，进程退出时其他静态对象的析构函数里仍然可以用。
+//
+// 读多写少的单例用 Singleton 就够了；像计数器这样每次请求都要写的，所有线程写同一条缓存行才是瓶颈，
+// 应该用下面的 PerThread/PerCpu 给每个线程（CPU）一份，需要时再汇总。
+
+template <typename T>
+class Singleton {
+public:
+    Singleton() = delete;
+
+    static T& instance() {
+        if (T* p = instance_.load(std::memory_order_acquire)) {
+            return *p;
+        }
+        return create();
+    }
+
+    // 已经构造过才返回，不会触发构造
+    static T* tryInstance() { return instance_.load(std::memory_order_acquire); }
+
+private:
+    // 冷路径不内联，快路径保持很短
+#if defined(__GNUC__)
+    __attribute__((noinline))
+#endif
+    static T& create() {
+        std::call_once(once_, []() {
+            T* p = ::new (static_cast<void*>(storage_)) T();
+            instance_.store(p, std::memory_order_release);
+        });
+        return *instance_.load(std::memory_order_acquire);
+    }
+
+    alignas(kCacheLineSize) static inline std::atomic<T*> instance_{nullptr};
+    static inline std::once_flag once_;
+    alignas(kCacheLineSize) alignas(T) static inline unsigned char storage_[sizeof(T)];
+};
+
+// ==================== 每线程一份 ====================
+// local() 返回当前线程自己的实例，第一次访问时构造；每个实例独占缓存行，线程之间没有争用。
+// 实例登记在 PerThread 对象里，线程退出后也保留（计数不会丢），PerThread 析构时一起释放，
+// 所以 PerThread 本身要比使用它的线程活得久。
+// forEach 遍历所有实例用于汇总；它和其他线程的 local() 是并发的，T 的字段要自己保证能被并发读（比如用原子变量）。
+// 快路径：线程局部数组按 PerThread 的编号取槽位，比较一次代数，没有锁也没有原子读改写。
+// 编号在 PerThread 析构后回收给下一个 PerThread，线程局部数组的长度不超过同时存在的 PerThread 个数；
+// 每个 PerThread 另有一个不重复的代数，槽位里记着写入时的代数，对不上就是旧对象留下的，下次访问时覆盖掉。
+
+template <typename T>
+class PerThread {
+public:
+    PerThread() {
+        IdPool& pool = idPool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (pool.free.empty()) {
+            id_ = pool.next++;
+        } else {
+            id_ = pool.free.back();
+            pool.free.pop_back();
+        }
+        generation_ = ++pool.generation;
+    }
+
+    ~PerThread() {
+        IdPool& pool = idPool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.free.push_back(id_);
+    }
+
+    PerThread(const PerThread&) = delete;
+    PerThread& operator=(const PerThread&) = delete;
+
+    T& local() {
+        std::vector<Slot>& slots = threadSlots();
+        if (id_ < slots.size() && slots[id_].generation == generation_) {
+            return slots[id_].instance->value;
+        }
+        return registerThread(slots);
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& instance : instances_) {
+            fn(instance->value);
+        }
+    }
+
+    size_t instances() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return instances_.size();
+    }
+
+private:
+    struct alignas(kCacheLineSize) Padded {
+        T value{};
+    };
+
+    // generation 为 0 表示空槽位，PerThread 的代数从 1 开始
+    struct Slot {
+        Padded* instance = nullptr;
+        uint64_t generation = 0;
+    };
+
+    // 同一个 T 的所有 PerThread 共用。函数内静态对象在第一个 PerThread 构造时建好，
+    // 静态存储期的 PerThread 因此都先于它析构
+    struct IdPool {
+        std::mutex mutex;
+        std::vector<size_t> free;
+        size_t next = 0;
+        uint64_t generation = 0;
+    };
+
+    static IdPool& idPool() {
+        static IdPool pool;
+        return pool;
+    }
+
+    static std::vector<Slot>& threadSlots() {
+        thread_local std::vector<Slot> slots;
+        return slots;
+    }
+
+    T& registerThread(std::vector<Slot>& slots) {
+        auto instance = std::make_unique<Padded>();
+        Padded* raw = instance.get();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            instances_.push_back(std::move(instance));
+        }
+        if (slots.size() <= id_) {
+            slots.resize(id_ + 1);
+        }
+        slots[id_] = Slot{raw, generation_};
+        return raw->value;
+    }
+
+    size_t id_;
+    uint64_t generation_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Padded>> instances_;
+};
+
+// ==================== 每 CPU 一份 ====================
+// 按当前线程所在的 CPU 选实例（Linux 用 sched_getcpu，其他平台按线程 id 散列），实例数固定等于 CPU 数。
+// 线程随时可能被迁移到别的 CPU，两个线程偶尔会同时用同一个实例：PerCpu 只是把争用降到很低，
+// 不保证独占，T 的修改必须是原子的（通常用 relaxed 原子操作）。线程很多、生命周期很短时比 PerThread 省内存。
+
+template <typename T>
+class PerCpu {
+public:
+    PerCpu() : count_(cpuCount()), instances_(std::make_unique<Padded[]>(count_)) {}
+
+    PerCpu(const PerCpu&) = delete;
+    PerCpu& operator=(const PerCpu&) = delete;
+
+    T& local() { return instances_[currentCpu() % count_].value; }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        for (size_t i = 0; i < count_; ++i) {
+            fn(instances_[i].value);
+        }
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i < count_; ++i) {
+            fn(static_cast<const T&>(instances_[i].value));
+        }
+    }
+
+    size_t instances() const { return count_; }
+
+private:
+    struct alignas(kCacheLineSize) Padded {
+        T value{};
+    };
+
+    static size_t cpuCount() {
+#if defined(__linux__)
+        const long configured = sysconf(_SC_NPROCESSORS_CONF);
+        if (configured > 0) {
+            return static_cast<size_t>(configured);
+        }
+#endif
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    static size_t currentCpu() {
+#if defined(__linux__)
+        const int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            return static_cast<size_t>(cpu);
+        }
+#endif
+        thread_local const size_t hashed = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return hashed;
+    }
+
+    const size_t count_;
+    std::unique_ptr<Padded[]> instances_;
+};
+
+#endif //HANDS_ON_CPP_SINGLETON_H
@@ -0,0 +1,125 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 单例访问开销，多线程同时访问：
+// - 读：函数内静态变量（Meyers）、Singleton<T>、每次加锁检查的单例，读一个配置字段
+// - 写：每次请求给计数器加一；单例里的原子计数（所有线程写同一条缓存行）、加锁计数、PerThread、PerCpu
+// 结果是每个线程每次访问的平均纳秒数。用法：singleton_bench [最大线程数]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_harness.h"
+#include "singleton.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Config {
+    int max_connections = 128;
+    std::atomic<uint64_t> requests{0};
+};
+
+Config& meyersConfig() {
+    static Config config;
+    return config;
+}
+
+// 朴素的线程安全写法：每次访问都加锁
+class LockedConfig {
+public:
+    static Config& instance() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!instance_) {
+            instance_ = new Config;
+        }
+        return *instance_;
+    }
+
+    static void increment() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++count_;
+    }
+
+private:
+    static inline std::mutex mutex_;
+    static inline Config* instance_ = nullptr;
+    static inline uint64_t count_ = 0;
+};
+
+PerThread<std::atomic<uint64_t>> g_per_thread;
+PerCpu<std::atomic<uint64_t>> g_per_cpu;
+
+// threads 个线程各执行 iterations 次 op，返回每次的平均纳秒数
+template <typename Op>
+double nsPerOp(unsigned threads, uint64_t iterations, Op op) {
+    std::atomic<unsigned> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+            }
+            for (uint64_t i = 0; i < iterations; ++i) {
+                op();
+            }
+        });
+    }
+    while (ready.load() != threads) {
+    }
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return ns / static_cast<double>(iterations);
+}
+
+template <typename Op>
+void row(const char* name, unsigned threads, Op op) {
+    const uint64_t iterations = 20'000'000 / threads;
+    nsPerOp(threads, iterations / 10, op);  // 预热：构造单例、登记每线程实例
+    std::cout << "    " << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << nsPerOp(threads, iterations, op) << " ns/次" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned max_threads = argc > 1 ? static_cast<unsigned>(std::stoul(argv[1]))
+                                          : std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        std::cout << threads << " 线程，读配置:" << std::endl;
+        row("函数内静态变量", threads, []() { bench::doNotOptimize(meyersConfig().max_connections); });
+        row("Singleton<T>", threads,
+            []() { bench::doNotOptimize(Singleton<Config>::instance().max_connections); });
+        row("加锁检查", threads, []() { bench::doNotOptimize(LockedConfig::instance().max_connections); });
+
+        std::cout << threads << " 线程，计数加一:" << std::endl;
+        row("单例里的原子计数", threads,
+            []() { Singleton<Config>::instance().requests.fetch_add(1, std::memory_order_relaxed); });
+        row("加锁计数", threads, []() { LockedConfig::increment(); });
+        // 只有本线程写，load + store 就够了，不需要读改写
+        row("PerThread", threads, []() {
+            std::atomic<uint64_t>& count = g_per_thread.local();
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        });
+        row("PerCpu", threads, []() { g_per_cpu.local().fetch_add(1, std::memory_order_relaxed); });
+    }
+
+    uint64_t per_thread_total = 0;
+    g_per_thread.forEach([&](const std::atomic<uint64_t>& count) { per_thread_total += count.load(); });
+    uint64_t per_cpu_total = 0;
+    g_per_cpu.forEach([&](const std::atomic<uint64_t>& count) { per_cpu_total += count.load(); });
+    std::cout << "汇总: PerThread " << g_per_thread.instances() << " 个实例共 " << per_thread_total << " 次，PerCpu "
+              << g_per_cpu.instances() << " 个实例共 " << per_cpu_total << " 次" << std::endl;
+    return 0;
+}
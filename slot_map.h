@@ -0,0 +1,168 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_SLOT_MAP_H
+#define HANDS_ON_CPP_SLOT_MAP_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+// ==================== 句柄表（SlotMap） ====================
+// 用 {槽位编号, 代数} 句柄代替裸指针：对象删除后槽位的代数加一，旧句柄再查就对不上，返回空指针，
+// 不会像 DebugExample* 那样指向已经析构的对象。和 shared_ptr/weak_ptr 相比没有引用计数，也没有控制块。
+// 布局：
+// - dense_ 连续存放所有存活对象，遍历就是扫一个数组
+// - slots_ 是句柄到 dense_ 下标的间接层，空闲槽位串成链表，插入删除都是 O(1)
+// - 删除时把 dense_ 最后一个元素搬到空位上（所以对象的地址和遍历顺序会变，句柄不变）
+// 查找：两次越界检查、一次代数比较、一次反查 dense_to_slot_（确认槽位存活）、三次数组访问。
+// 某个槽位的代数用完（2^32 次复用）后不再回收，避免旧句柄碰巧匹配。非线程安全。
+
+struct SlotHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;  // 有效句柄的代数从 1 开始，默认构造的句柄是空句柄
+
+    explicit operator bool() const { return generation != 0; }
+
+    // 压成 64 位整数，方便存到别的结构里或跨接口传递
+    uint64_t raw() const { return (static_cast<uint64_t>(generation) << 32) | index; }
+
+    static SlotHandle fromRaw(uint64_t raw) {
+        return {static_cast<uint32_t>(raw), static_cast<uint32_t>(raw >> 32)};
+    }
+
+    friend bool operator==(const SlotHandle&, const SlotHandle&) = default;
+};
+
+template <typename T>
+class SlotMap {
+public:
+    using Handle = SlotHandle;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    void reserve(size_t capacity) {
+        dense_.reserve(capacity);
+        dense_to_slot_.reserve(capacity);
+        slots_.reserve(capacity);
+    }
+
+    // 先构造对象再占槽位：构造或任何一次 push_back 抛异常时，表保持原样
+    template <typename... Args>
+    Handle emplace(Args&&... args) {
+        dense_.emplace_back(std::forward<Args>(args)...);
+        const bool fresh = free_head_ == kNoSlot;
+        const uint32_t index = fresh ? static_cast<uint32_t>(slots_.size()) : free_head_;
+        try {
+            if (fresh) {
+                assert(slots_.size() < kNoSlot);
+                slots_.push_back({kNoSlot, 1});
+            }
+            dense_to_slot_.push_back(index);
+        } catch (...) {
+            if (fresh && slots_.size() > index) {
+                slots_.pop_back();
+            }
+            dense_.pop_back();
+            throw;
+        }
+        if (!fresh) {
+            free_head_ = slots_[index].target;
+        }
+        slots_[index].target = static_cast<uint32_t>(dense_.size() - 1);
+        return {index, slots_[index].generation};
+    }
+
+    Handle insert(T value) { return emplace(std::move(value)); }
+
+    // 句柄已经失效时返回 false
+    bool erase(Handle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        Slot& slot = slots_[handle.index];
+        const uint32_t hole = slot.target;
+        const uint32_t last = static_cast<uint32_t>(dense_.size() - 1);
+        if (hole != last) {
+            dense_[hole] = std::move(dense_[last]);
+            dense_to_slot_[hole] = dense_to_slot_[last];
+            slots_[dense_to_slot_[hole]].target = hole;
+        }
+        dense_.pop_back();
+        dense_to_slot_.pop_back();
+
+        if (++slot.generation != 0) {
+            slot.target = free_head_;
+            free_head_ = handle.index;
+        }
+        return true;
+    }
+
+    // 旧句柄返回空指针；返回的指针在下一次插入或删除之前有效
+    T* get(Handle handle) {
+        return contains(handle) ? &dense_[slots_[handle.index].target] : nullptr;
+    }
+
+    const T* get(Handle handle) const {
+        return contains(handle) ? &dense_[slots_[handle.index].target] : nullptr;
+    }
+
+    // 空闲槽位的代数已经加过一，伪造的 {index, 代数} 也可能和它相等，所以还要确认槽位确实指向一个存活对象
+    bool contains(Handle handle) const {
+        if (handle.index >= slots_.size() || handle.generation == 0) {
+            return false;
+        }
+        const Slot& slot = slots_[handle.index];
+        return slot.generation == handle.generation && slot.target < dense_to_slot_.size() &&
+               dense_to_slot_[slot.target] == handle.index;
+    }
+
+    // 遍历顺序里第 position 个对象的句柄
+    Handle handleAt(size_t position) const {
+        const uint32_t index = dense_to_slot_[position];
+        return {index, slots_[index].generation};
+    }
+
+    void clear() {
+        for (uint32_t index : dense_to_slot_) {
+            Slot& slot = slots_[index];
+            if (++slot.generation != 0) {
+                slot.target = free_head_;
+                free_head_ = index;
+            }
+        }
+        dense_.clear();
+        dense_to_slot_.clear();
+    }
+
+    size_t size() const { return dense_.size(); }
+    bool empty() const { return dense_.empty(); }
+
+    std::span<T> values() { return dense_; }
+    std::span<const T> values() const { return dense_; }
+
+    iterator begin() { return dense_.begin(); }
+    iterator end() { return dense_.end(); }
+    const_iterator begin() const { return dense_.begin(); }
+    const_iterator end() const { return dense_.end(); }
+
+private:
+    static constexpr uint32_t kNoSlot = std::numeric_limits<uint32_t>::max();
+
+    struct Slot {
+        uint32_t target;      // 存活时是 dense_ 下标，空闲时是下一个空闲槽位
+        uint32_t generation;  // 存活对象的代数；删除时加一
+    };
+
+    std::vector<T> dense_;
+    std::vector<uint32_t> dense_to_slot_;  // 删除时搬动最后一个元素需要找回它的槽位
+    std::vector<Slot> slots_;
+    uint32_t free_head_ = kNoSlot;
+};
+
+#endif //HANDS_ON_CPP_SLOT_MAP_H
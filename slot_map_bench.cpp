@@ -0,0 +1,178 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 句柄表 vs 常见的“安全指针”写法：
+// - SlotMap<Entity> + SlotHandle
+// - std::unordered_map<int, std::shared_ptr<Entity>>，按 id 查
+// - std::vector<std::weak_ptr<Entity>>，按 id 下标，lock() 之后用
+// 10 万个对象删掉十分之一，查找用随机顺序的全部 id（约 10% 是已经删除的对象），遍历对所有存活对象求和。
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_harness.h"
+#include "slot_map.h"
+
+struct Entity {
+    int id = 0;
+    float x = 0, y = 0, z = 0;
+    float vx = 0, vy = 0, vz = 0;
+    int hp = 0;
+};
+
+struct World {
+    static constexpr int kEntities = 100'000;
+
+    SlotMap<Entity> slots;
+    std::vector<SlotHandle> handles;  // 按 id 下标，包括已删除的
+
+    std::unordered_map<int, std::shared_ptr<Entity>> map;
+
+    std::vector<std::shared_ptr<Entity>> owners;
+    std::vector<std::weak_ptr<Entity>> weak;
+
+    std::vector<int> queries;  // 随机顺序的 id
+
+    World() {
+        slots.reserve(kEntities);
+        for (int id = 0; id < kEntities; ++id) {
+            Entity e;
+            e.id = id;
+            e.hp = id % 100;
+            handles.push_back(slots.insert(e));
+            map.emplace(id, std::make_shared<Entity>(e));
+            owners.push_back(std::make_shared<Entity>(e));
+            weak.push_back(owners.back());
+        }
+        for (int id = 0; id < kEntities; id += 10) {
+            slots.erase(handles[id]);
+            map.erase(id);
+            owners[id].reset();
+        }
+        queries.resize(kEntities);
+        for (int id = 0; id < kEntities; ++id) {
+            queries[id] = id;
+        }
+        std::shuffle(queries.begin(), queries.end(), std::mt19937(42));
+    }
+};
+
+int main(int argc, char* argv[]) {
+    World world;
+    const auto queries = static_cast<uint64_t>(world.queries.size());
+
+    bench::Runner runner(bench::parseOptions(argc, argv));
+
+    // ==================== 查找 ====================
+
+    runner.add("查找: SlotMap 句柄", [&](bench::State& state) {
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (int id : world.queries) {
+                if (const Entity* e = world.slots.get(world.handles[id])) {
+                    sum += e->hp;
+                }
+            }
+            bench::doNotOptimize(sum);
+        }
+        state.setItemsPerIteration(queries);
+    });
+    runner.add("查找: unordered_map<int, shared_ptr>", [&](bench::State& state) {
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (int id : world.queries) {
+                auto it = world.map.find(id);
+                if (it != world.map.end()) {
+                    sum += it->second->hp;
+                }
+            }
+            bench::doNotOptimize(sum);
+        }
+        state.setItemsPerIteration(queries);
+    });
+    runner.add("查找: vector<weak_ptr>::lock", [&](bench::State& state) {
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (int id : world.queries) {
+                if (std::shared_ptr<Entity> e = world.weak[id].lock()) {
+                    sum += e->hp;
+                }
+            }
+            bench::doNotOptimize(sum);
+        }
+        state.setItemsPerIteration(queries);
+    });
+
+    // ==================== 遍历存活对象 ====================
+
+    const auto live = static_cast<uint64_t>(world.slots.size());
+    runner.add("遍历: SlotMap", [&](bench::State& state) {
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (const Entity& e : world.slots) {
+                sum += e.hp;
+            }
+            bench::doNotOptimize(sum);
+        }
+        state.setItemsPerIteration(live);
+    });
+    runner.add("遍历: unordered_map<int, shared_ptr>", [&](bench::State& state) {
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (const auto& [id, e] : world.map) {
+                sum += e->hp;
+            }
+            bench::doNotOptimize(sum);
+        }
+        state.setItemsPerIteration(live);
+    });
+    runner.add("遍历: vector<weak_ptr>::lock", [&](bench::State& state) {
+        for (auto _ : state) {
+            int64_t sum = 0;
+            for (const auto& w : world.weak) {
+                if (std::shared_ptr<Entity> e = w.lock()) {
+                    sum += e->hp;
+                }
+            }
+            bench::doNotOptimize(sum);
+        }
+        state.setItemsPerIteration(live);
+    });
+
+    // ==================== 插入 + 删除 ====================
+
+    runner.add("插入+删除: SlotMap", [&](bench::State& state) {
+        SlotMap<Entity> local;
+        std::vector<SlotHandle> handles(1024);
+        for (auto _ : state) {
+            for (auto& h : handles) {
+                h = local.emplace();
+            }
+            for (auto& h : handles) {
+                local.erase(h);
+            }
+        }
+        state.setItemsPerIteration(handles.size());
+    });
+    runner.add("插入+删除: unordered_map<int, shared_ptr>", [&](bench::State& state) {
+        std::unordered_map<int, std::shared_ptr<Entity>> local;
+        int next = 0;
+        for (auto _ : state) {
+            const int first = next;
+            for (int i = 0; i < 1024; ++i) {
+                local.emplace(next++, std::make_shared<Entity>());
+            }
+            for (int i = first; i < next; ++i) {
+                local.erase(i);
+            }
+        }
+        state.setItemsPerIteration(1024);
+    });
+
+    runner.run();
+    return 0;
+}
@@ -0,0 +1,99 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// SlotMap：旧句柄、伪造句柄、emplace 抛异常时的回滚。
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "slot_map.h"
+#include "test_check.h"
+
+// 删除后的旧句柄查不到，槽位复用后旧句柄仍然查不到
+void testStaleHandle() {
+    SlotMap<int> map;
+    const SlotHandle a = map.insert(1);
+    const SlotHandle b = map.insert(2);
+    CHECK(map.erase(a));
+    CHECK(!map.contains(a));
+    CHECK(map.get(a) == nullptr);
+    CHECK(!map.erase(a));
+
+    const SlotHandle c = map.insert(3);
+    CHECK(c.index == a.index);
+    CHECK(c.generation != a.generation);
+    CHECK(map.get(a) == nullptr);
+    CHECK(map.get(c) && *map.get(c) == 3);
+    CHECK(map.get(b) && *map.get(b) == 2);
+}
+
+// 空闲槽位的代数已经加一：用 fromRaw 伪造的 {index, 旧代数 + 1} 和它相等，也必须查不到
+void testForgedHandleForFreeSlot() {
+    SlotMap<int> map;
+    const SlotHandle a = map.insert(1);
+    map.insert(2);
+    map.erase(a);
+
+    const SlotHandle forged = SlotHandle::fromRaw(SlotHandle{a.index, a.generation + 1}.raw());
+    CHECK(!map.contains(forged));
+    CHECK(map.get(forged) == nullptr);
+    CHECK(std::as_const(map).get(forged) == nullptr);
+    CHECK(!map.erase(forged));
+    CHECK(map.size() == 1);
+
+    // 只剩一个空闲槽位、dense_ 清空时也一样
+    SlotMap<int> single;
+    const SlotHandle only = single.insert(1);
+    single.erase(only);
+    CHECK(single.get(SlotHandle{only.index, only.generation + 1}) == nullptr);
+
+    // 从没分配过的槽位
+    CHECK(map.get(SlotHandle{1000, 1}) == nullptr);
+    CHECK(map.get(SlotHandle{}) == nullptr);
+}
+
+// 构造时抛异常：表不变，之后插入的句柄照常可用
+struct Throwing {
+    explicit Throwing(bool fail) : value("ok") {
+        if (fail) {
+            throw std::runtime_error("构造失败");
+        }
+    }
+    std::string value;
+};
+
+// with_free_slot 为 true 时抛异常的 emplace 走复用空闲槽位的路径，否则走新开槽位的路径
+void testEmplaceThrows(bool with_free_slot) {
+    SlotMap<Throwing> map;
+    const SlotHandle a = map.emplace(false);
+    if (with_free_slot) {
+        map.erase(map.emplace(false));
+    }
+
+    bool threw = false;
+    try {
+        map.emplace(true);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+    CHECK(map.size() == 1);
+    CHECK(map.get(a) && map.get(a)->value == "ok");
+
+    const SlotHandle b = map.emplace(false);
+    const SlotHandle c = map.emplace(false);
+    CHECK(map.size() == 3);
+    CHECK(b.index != c.index && b.index != a.index && c.index != a.index);
+    CHECK(map.get(b) && map.get(c));
+    CHECK(map.erase(b) && map.erase(c) && map.erase(a));
+    CHECK(map.empty());
+}
+
+int main() {
+    testStaleHandle();
+    testForgedHandleForFreeSlot();
+    testEmplaceThrows(true);
+    testEmplaceThrows(false);
+    return testResult();
+}
@@ -0,0 +1,37 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_TEST_CHECK_H
+#define HANDS_ON_CPP_TEST_CHECK_H
+
+#include <iostream>
+
+// ==================== 最小的测试断言 ====================
+// CHECK 失败时打印位置和表达式并记一次失败，不中断，同一个测试里后面的检查照常执行。
+// 测试的 main 最后 return testResult()：有失败时退出码为 1，ctest 据此判断。
+// 不受 NDEBUG 影响，Release 构建下照样检查。
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(expr)                                                                          \
+    do {                                                                                     \
+        if (!(expr)) {                                                                       \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #expr ") 失败" << std::endl; \
+            ++testFailures();                                                                \
+        }                                                                                    \
+    } while (0)
+
+inline int testResult() {
+    if (testFailures() != 0) {
+        std::cerr << testFailures() << " 个检查失败" << std::endl;
+        return 1;
+    }
+    std::cout << "全部通过" << std::endl;
+    return 0;
+}
+
+#endif //HANDS_ON_CPP_TEST_CHECK_H
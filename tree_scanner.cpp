@@ -0,0 +1,441 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#include "tree_scanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "dir_fd.h"
+#include "flat_hash_map.h"
+#include "logger.h"
+#include "work_stealing_deque.h"
+
+namespace fs = std::filesystem;
+
+// ==================== DirIndex ====================
+
+DirIndex::NodeId DirIndex::findChild(NodeId parent, std::string_view name) const {
+    NodeId low = first_child_[parent];
+    NodeId high = low + child_count_[parent];
+    while (low < high) {
+        const NodeId mid = low + (high - low) / 2;
+        const int cmp = this->name(mid).compare(name);
+        if (cmp == 0) {
+            return mid;
+        }
+        if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return kNone;
+}
+
+DirIndex::NodeId DirIndex::find(std::string_view relative_path) const {
+    if (empty()) {
+        return kNone;
+    }
+    NodeId node = root();
+    while (!relative_path.empty()) {
+        const size_t slash = relative_path.find('/');
+        const std::string_view component = relative_path.substr(0, slash);
+        relative_path = slash == std::string_view::npos ? std::string_view() : relative_path.substr(slash + 1);
+        if (component.empty() || component == ".") {
+            continue;
+        }
+        node = findChild(node, component);
+        if (node == kNone) {
+            return kNone;
+        }
+    }
+    return node;
+}
+
+std::string DirIndex::path(NodeId id) const {
+    std::vector<NodeId> chain;
+    for (NodeId node = id; node != root(); node = parent_[node]) {
+        chain.push_back(node);
+    }
+    std::string result;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        if (!result.empty()) {
+            result += '/';
+        }
+        result += name(*it);
+    }
+    return result;
+}
+
+size_t DirIndex::memoryBytes() const {
+    return names_.capacity() + name_offset_.capacity() * sizeof(uint32_t) + parent_.capacity() * sizeof(NodeId) +
+           name_.capacity() * sizeof(uint32_t) + first_child_.capacity() * sizeof(NodeId) +
+           child_count_.capacity() * sizeof(uint32_t) + subtree_size_.capacity() * sizeof(uint32_t) +
+           type_.capacity() * sizeof(uint8_t);
+}
+
+// ==================== 扫描 ====================
+
+namespace {
+
+// 一个任务：读 parent 下名为 name 的目录，它在索引里是 node
+struct ScanTask {
+    std::shared_ptr<DirFd> parent;
+    DirIndex::NodeId node;
+    std::string name;
+};
+
+// 一个目录读出来的条目，名字放在 Scratch::names 里
+struct RawEntry {
+    uint32_t offset;
+    uint32_t length;
+    DirIndex::EntryType type;
+};
+
+// 每个工作线程一份，跨目录复用，读目录时不分配内存
+struct Scratch {
+    std::vector<char> buffer = std::vector<char>(32 * 1024);
+    std::string names;
+    std::vector<RawEntry> entries;
+
+    std::string_view name(const RawEntry& entry) const { return std::string_view(names).substr(entry.offset, entry.length); }
+};
+
+struct NameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+};
+
+DirIndex::EntryType typeFromMode(mode_t mode) {
+    if (S_ISDIR(mode)) return DirIndex::EntryType::Directory;
+    if (S_ISREG(mode)) return DirIndex::EntryType::File;
+    if (S_ISLNK(mode)) return DirIndex::EntryType::Symlink;
+    return DirIndex::EntryType::Other;
+}
+
+// d_type 不可用（DT_UNKNOWN）时 fstatat 补上，不跟随符号链接
+DirIndex::EntryType entryType(int dir_fd, const char* name, unsigned char d_type) {
+    switch (d_type) {
+        case DT_DIR: return DirIndex::EntryType::Directory;
+        case DT_REG: return DirIndex::EntryType::File;
+        case DT_LNK: return DirIndex::EntryType::Symlink;
+        case DT_UNKNOWN: {
+            struct stat st {};
+            if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                return typeFromMode(st.st_mode);
+            }
+            return DirIndex::EntryType::Other;
+        }
+        default: return DirIndex::EntryType::Other;
+    }
+}
+
+void addEntry(Scratch& scratch, int dir_fd, const char* name, unsigned char d_type) {
+    if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+        return;
+    }
+    const size_t length = std::strlen(name);
+    scratch.entries.push_back({static_cast<uint32_t>(scratch.names.size()), static_cast<uint32_t>(length),
+                               entryType(dir_fd, name, d_type)});
+    scratch.names.append(name, length);
+}
+
+// 读出目录的全部条目（不含 . 和 ..）。失败返回 false，errno 有效
+bool readDirectory(int fd, Scratch& scratch, uint64_t& reads) {
+    scratch.names.clear();
+    scratch.entries.clear();
+#ifdef __linux__
+    // linux_dirent64：d_ino(8) d_off(8) d_reclen(2) d_type(1) d_name，按字节偏移解析，不依赖 glibc 的声明
+    constexpr size_t kReclenOffset = 16;
+    constexpr size_t kTypeOffset = 18;
+    constexpr size_t kNameOffset = 19;
+    for (;;) {
+        const long bytes = syscall(SYS_getdents64, fd, scratch.buffer.data(), scratch.buffer.size());
+        ++reads;
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (bytes == 0) {
+            return true;
+        }
+        for (long pos = 0; pos < bytes;) {
+            const char* record = scratch.buffer.data() + pos;
+            unsigned short reclen;
+            std::memcpy(&reclen, record + kReclenOffset, sizeof(reclen));
+            addEntry(scratch, fd, record + kNameOffset, static_cast<unsigned char>(record[kTypeOffset]));
+            pos += reclen;
+        }
+    }
+#else
+    // 其他 POSIX 系统用 readdir；fdopendir 会接管 fd，所以给它一个副本
+    const int copy = dup(fd);
+    DIR* dir = copy >= 0 ? fdopendir(copy) : nullptr;
+    if (!dir) {
+        if (copy >= 0) {
+            close(copy);
+        }
+        return false;
+    }
+    ++reads;
+    errno = 0;
+    while (const dirent* entry = readdir(dir)) {
+        addEntry(scratch, fd, entry->d_name, entry->d_type);
+    }
+    const int error = errno;
+    closedir(dir);
+    errno = error;
+    return error == 0;
+#endif
+}
+
+}  // namespace
+
+class TreeScanner {
+public:
+    TreeScanner(DirIndex& index, unsigned threads) : index_(index), threads_(threads) {
+        if (threads_ == 0) {
+            threads_ = std::max(1u, std::thread::hardware_concurrency());
+        }
+    }
+
+    void run(int root_fd, ScanStats& stats) {
+        index_.name_offset_.assign(1, 0);
+        appendNode(DirIndex::kNone, "", DirIndex::EntryType::Directory);
+
+        for (unsigned i = 0; i < threads_; ++i) {
+            queues_.push_back(std::make_unique<WorkStealingDeque<ScanTask>>());
+        }
+        worker_stats_.assign(threads_, ScanStats{});
+
+        // 根目录也按"父目录下的一个名字"处理：openat(root_fd, ".")
+        pending_.store(1, std::memory_order_relaxed);
+        queues_[0]->push({std::make_shared<DirFd>(root_fd), DirIndex::root(), "."});
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < threads_; ++i) {
+            workers.emplace_back(&TreeScanner::workerLoop, this, i);
+        }
+        workerLoop(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        for (const auto& local : worker_stats_) {
+            stats.directories += local.directories;
+            stats.errors += local.errors;
+            stats.reads += local.reads;
+        }
+        stats.entries = index_.size() - 1;
+
+        // 子节点的编号总比父节点大，倒序一遍就把子树大小累加到了每个祖先
+        index_.subtree_size_.assign(index_.size(), 1);
+        for (size_t id = index_.size() - 1; id > 0; --id) {
+            index_.subtree_size_[index_.parent_[id]] += index_.subtree_size_[id];
+        }
+    }
+
+private:
+    void workerLoop(size_t id) {
+        ScanStats& local = worker_stats_[id];
+        Scratch scratch;
+
+        // pending_ 在子任务入队之前加一、在任务处理完之后减一，所以只有全部完成时才会归零
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            std::optional<ScanTask> task = queues_[id]->pop();
+            for (size_t k = 1; !task && k < queues_.size(); ++k) {
+                task = queues_[(id + k) % queues_.size()]->steal();
+            }
+            if (!task) {
+                std::this_thread::yield();
+                continue;
+            }
+            process(id, *task, local, scratch);
+            task.reset();  // 先释放父目录 fd，再宣布任务完成
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void process(size_t id, const ScanTask& task, ScanStats& local, Scratch& scratch) {
+        const int fd = openat(task.parent->get(), task.name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0) {
+            reportError(task.node, "openat");
+            ++local.errors;
+            return;
+        }
+        auto dir = std::make_shared<DirFd>(fd);
+        ++local.directories;
+        if (!readDirectory(fd, scratch, local.reads)) {
+            reportError(task.node, "getdents64");
+            ++local.errors;
+            return;
+        }
+        if (scratch.entries.empty()) {
+            return;
+        }
+
+        // 子节点按名字排序后连续追加，findChild 才能二分
+        std::sort(scratch.entries.begin(), scratch.entries.end(),
+                  [&scratch](const RawEntry& a, const RawEntry& b) { return scratch.name(a) < scratch.name(b); });
+        DirIndex::NodeId first;
+        {
+            std::lock_guard<std::mutex> lock(index_mutex_);
+            first = static_cast<DirIndex::NodeId>(index_.size());
+            for (const RawEntry& entry : scratch.entries) {
+                appendNode(task.node, scratch.name(entry), entry.type);
+            }
+            index_.first_child_[task.node] = first;
+            index_.child_count_[task.node] = static_cast<uint32_t>(scratch.entries.size());
+        }
+
+        for (size_t i = 0; i < scratch.entries.size(); ++i) {
+            const RawEntry& entry = scratch.entries[i];
+            if (entry.type == DirIndex::EntryType::Directory) {
+                pending_.fetch_add(1, std::memory_order_relaxed);
+                queues_[id]->push({dir, static_cast<DirIndex::NodeId>(first + i), std::string(scratch.name(entry))});
+            }
+        }
+    }
+
+    // 调用方持有 index_mutex_（根节点除外，那时还没有工作线程）
+    void appendNode(DirIndex::NodeId parent, std::string_view name, DirIndex::EntryType type) {
+        auto it = name_ids_.find(name);
+        if (it == name_ids_.end()) {
+            it = name_ids_.emplace(name, static_cast<uint32_t>(index_.name_offset_.size() - 1)).first;
+            index_.names_.append(name);
+            index_.name_offset_.push_back(static_cast<uint32_t>(index_.names_.size()));
+        }
+        index_.parent_.push_back(parent);
+        index_.name_.push_back(it->second);
+        index_.first_child_.push_back(DirIndex::kNone);
+        index_.child_count_.push_back(0);
+        index_.type_.push_back(static_cast<uint8_t>(type));
+    }
+
+    void reportError(DirIndex::NodeId node, const char* op) {
+        const int error = errno;
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(index_mutex_);
+            path = index_.path(node);
+        }
+        LOG_ERROR("错误: {} {}: {}", op, path, std::strerror(error));
+    }
+
+    DirIndex& index_;
+    unsigned threads_;
+    std::mutex index_mutex_;
+    FlatHashMap<std::string, uint32_t, NameHash, std::equal_to<>> name_ids_;
+    std::vector<std::unique_ptr<WorkStealingDeque<ScanTask>>> queues_;
+    std::vector<ScanStats> worker_stats_;
+    std::atomic<uint64_t> pending_{0};
+};
+
+DirIndex scanTree(const fs::path& root, const ScanOptions& options, ScanStats& stats) {
+    DirIndex index;
+    const auto start = std::chrono::steady_clock::now();
+    const int root_fd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root_fd < 0) {
+        LOG_ERROR("无法打开目录: {}: {}", root, std::strerror(errno));
+        stats.errors = 1;
+        return index;
+    }
+    TreeScanner(index, options.threads).run(root_fd, stats);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return index;
+}
+
+// ==================== 和期望的形状比较 ====================
+
+namespace {
+
+struct DiffContext {
+    const DirIndex& index;
+    int fan_out;
+    int max_depth;
+    size_t max_reported;
+    std::vector<uint64_t> expected_subtree;  // 深度 d 上一个目录的期望子树大小（包括自己）
+    TreeDiff& diff;
+};
+
+void record(std::vector<std::string>& paths, size_t max_reported, const std::string& parent, std::string_view name) {
+    if (paths.size() < max_reported) {
+        paths.push_back(parent.empty() ? std::string(name) : parent + '/' + std::string(name));
+    }
+}
+
+void diffNode(DiffContext& ctx, DirIndex::NodeId node, int depth, std::string& path) {
+    const DirIndex& index = ctx.index;
+    const DirIndex::NodeId first = index.firstChild(node);
+    const uint32_t count = index.childCount(node);
+    std::vector<bool> matched(count, false);
+
+    if (depth < ctx.max_depth) {
+        for (int i = 1; i <= ctx.fan_out; ++i) {
+            const std::string name = std::to_string(i);
+            const DirIndex::NodeId child = count ? index.findChild(node, name) : DirIndex::kNone;
+            if (child == DirIndex::kNone || index.type(child) != DirIndex::EntryType::Directory) {
+                ctx.diff.missing += ctx.expected_subtree[depth + 1];
+                record(ctx.diff.missing_paths, ctx.max_reported, path, name);
+                continue;
+            }
+            matched[child - first] = true;
+            const size_t length = path.size();
+            if (!path.empty()) {
+                path += '/';
+            }
+            path += name;
+            diffNode(ctx, child, depth + 1, path);
+            path.resize(length);
+        }
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!matched[i]) {
+            ctx.diff.unexpected += index.subtreeSize(first + i);
+            record(ctx.diff.unexpected_paths, ctx.max_reported, path, index.name(first + i));
+        }
+    }
+}
+
+}  // namespace
+
+TreeDiff diffExpectedTree(const DirIndex& index, int fan_out, int max_depth, size_t max_reported) {
+    TreeDiff diff;
+    max_depth = std::max(max_depth, 0);
+    DiffContext ctx{index, fan_out, max_depth, max_reported, std::vector<uint64_t>(max_depth + 2, 0), diff};
+    ctx.expected_subtree[max_depth] = 1;
+    for (int depth = max_depth - 1; depth >= 0; --depth) {
+        ctx.expected_subtree[depth] = 1 + static_cast<uint64_t>(fan_out) * ctx.expected_subtree[depth + 1];
+    }
+    diff.expected = ctx.expected_subtree[0] - 1;
+
+    if (index.empty()) {
+        diff.missing = diff.expected;
+        return diff;
+    }
+    std::string path;
+    diffNode(ctx, DirIndex::root(), 0, path);
+    return diff;
+}
@@ -0,0 +1,107 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_TREE_SCANNER_H
+#define HANDS_ON_CPP_TREE_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ==================== 目录树扫描和索引 ====================
+// recursive_directory_iterator 单线程，每个条目构造一个 fs::path（一次堆分配加路径拼接），
+// 读目录走 readdir 的一层缓冲。scanTree 用多个线程并行扫描：
+// - 每个目录 openat 相对父目录打开，Linux 上直接用 getdents64 一次读 32 KB 的目录项，
+//   d_type 是 DT_UNKNOWN 的文件系统上才补一次 fstatat
+// - 任务队列和 main.cpp 的并行目录生成器一样：每个线程一个 WorkStealingDeque，父目录 fd 由子任务共享
+// 结果是紧凑的 DirIndex，不存 fs::path：
+// - 名字去重后拼在一块内存里，节点只存名字编号；生成的树里反复出现的 "1".."9" 只存一份
+// - 节点信息按列存放（父节点、名字、第一个子节点、子节点数、子树大小、类型），每个节点 21 字节
+// - 一个目录的子节点编号连续，并按名字排序：查找子节点是二分，子树大小在扫描结束后倒序累加一遍得到
+//   （子节点的编号总比父节点大）
+
+class DirIndex {
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId kNone = std::numeric_limits<NodeId>::max();
+
+    enum class EntryType : uint8_t { Directory, File, Symlink, Other };
+
+    // 0 号节点是扫描的根目录，名字为空
+    static constexpr NodeId root() { return 0; }
+
+    size_t size() const { return parent_.size(); }
+    bool empty() const { return parent_.empty(); }
+
+    NodeId parent(NodeId id) const { return parent_[id]; }
+    EntryType type(NodeId id) const { return static_cast<EntryType>(type_[id]); }
+    std::string_view name(NodeId id) const {
+        const uint32_t name = name_[id];
+        return std::string_view(names_).substr(name_offset_[name], name_offset_[name + 1] - name_offset_[name]);
+    }
+
+    // 子节点是 [firstChild, firstChild + childCount)
+    NodeId firstChild(NodeId id) const { return first_child_[id]; }
+    uint32_t childCount(NodeId id) const { return child_count_[id]; }
+    // 子树里的节点数，包括自己
+    uint32_t subtreeSize(NodeId id) const { return subtree_size_[id]; }
+
+    // 按名字找子节点，找不到返回 kNone
+    NodeId findChild(NodeId parent, std::string_view name) const;
+    // 相对根目录的路径（"1/2/3"，空串是根目录），找不到返回 kNone
+    NodeId find(std::string_view relative_path) const;
+    // 相对根目录的路径
+    std::string path(NodeId id) const;
+
+    // 去重后的名字个数
+    size_t uniqueNames() const { return name_offset_.empty() ? 0 : name_offset_.size() - 1; }
+    // 索引本身占用的字节数（按容量算）
+    size_t memoryBytes() const;
+
+private:
+    friend class TreeScanner;
+
+    std::string names_;                  // 去重后的名字首尾相接
+    std::vector<uint32_t> name_offset_;  // 第 i 个名字是 [name_offset_[i], name_offset_[i + 1])
+    std::vector<NodeId> parent_;
+    std::vector<uint32_t> name_;
+    std::vector<NodeId> first_child_;
+    std::vector<uint32_t> child_count_;
+    std::vector<uint32_t> subtree_size_;
+    std::vector<uint8_t> type_;
+};
+
+struct ScanOptions {
+    unsigned threads = 0;  // 工作线程数，0 表示每个核心一个
+};
+
+struct ScanStats {
+    uint64_t entries = 0;      // 条目数，不含根目录
+    uint64_t directories = 0;  // 读过的目录数，包括根目录
+    uint64_t errors = 0;       // 打不开或读失败的目录数
+    uint64_t reads = 0;        // 读目录的系统调用次数（getdents64 或 readdir 的批次）
+    double seconds = 0.0;
+};
+
+// 扫描 root 下的整棵树，不跟随符号链接。根目录打不开时返回空索引，stats.errors 为 1
+DirIndex scanTree(const std::filesystem::path& root, const ScanOptions& options, ScanStats& stats);
+
+// 和 createNestedDirectories 生成的形状比较：深度 1..max_depth 上每个目录都有名为 1..fan_out 的子目录，没有别的条目
+struct TreeDiff {
+    uint64_t expected = 0;    // 期望的条目数，不含根目录
+    uint64_t missing = 0;     // 缺少的条目数：缺一个目录时它整棵子树都算缺少；同名但不是目录的也算缺少
+    uint64_t unexpected = 0;  // 多出来的条目数：多出来的目录连同它的子树都算
+    std::vector<std::string> missing_paths;     // 最多 max_reported 个，只记子树的根
+    std::vector<std::string> unexpected_paths;  // 同上
+
+    bool matches() const { return missing == 0 && unexpected == 0; }
+};
+
+TreeDiff diffExpectedTree(const DirIndex& index, int fan_out, int max_depth, size_t max_reported = 16);
+
+#endif //HANDS_ON_CPP_TREE_SCANNER_H
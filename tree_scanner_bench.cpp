@@ -0,0 +1,150 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// 扫描一棵生成的目录树：recursive_directory_iterator vs scanTree（getdents64 + 紧凑索引，1..N 个线程）。
+// 先用 createTreeSync 在 root 下建一棵 分支数^深度 的树（默认 9 和 5，约 6.6 万个目录），每种写法扫 5 遍取中位数
+// （目录项都在 dentry 缓存里，测的是遍历本身，不是磁盘）。
+// 另外比较了保存结果的内存：vector<fs::path> 按每个路径的字符串容量加 sizeof(fs::path) 估算，DirIndex 是实际容量，
+// 以及在索引上按路径查找和与期望形状比较的耗时。
+// 用法：tree_scanner_bench [分支数] [深度] [根目录]，根目录默认 /dev/shm（没有时用临时目录）
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench_harness.h"
+#include "mkdir_engine.h"
+#include "tree_scanner.h"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+double millisSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+constexpr int kRepetitions = 5;
+
+void printRow(const std::string& name, uint64_t entries, double ms, size_t bytes) {
+    std::cout << "  " << std::left << std::setw(34) << name << std::right << std::setw(10) << entries << std::fixed
+              << std::setprecision(1) << std::setw(10) << ms << std::setprecision(0) << std::setw(14)
+              << (ms > 0 ? entries / (ms / 1000.0) : 0.0) << std::setw(14) << bytes << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const int fan_out = argc > 1 ? std::stoi(argv[1]) : 9;
+    const int depth = argc > 2 ? std::stoi(argv[2]) : 5;
+    fs::path root = argc > 3 ? fs::path(argv[3]) : fs::path("/dev/shm");
+    if (!fs::is_directory(root)) {
+        root = fs::temp_directory_path();
+    }
+    const fs::path base = root / ("hands_on_cpp_scan_bench_" + std::to_string(getpid()));
+
+    MkdirTreeOptions tree;
+    tree.base_dir = base;
+    tree.fan_out = fan_out;
+    tree.max_depth = depth;
+    const MkdirTreeStats created = createTreeSync(tree);
+    std::cout << base.string() << "：分支数 " << fan_out << "，深度 " << depth << "，" << created.created + created.existed
+              << " 个目录，建树 " << std::fixed << std::setprecision(1) << created.seconds * 1000.0 << " ms" << std::endl;
+    std::cout << "  " << std::left << std::setw(34) << "写法" << std::right
+              << "    条目数      毫秒       条目/秒      结果字节" << std::endl;
+
+    // recursive_directory_iterator：只计数，以及把路径存进 vector 当作索引
+    {
+        std::vector<double> times;
+        uint64_t entries = 0;
+        for (int r = 0; r < kRepetitions; ++r) {
+            const auto start = Clock::now();
+            entries = 0;
+            for (auto it = fs::recursive_directory_iterator(base); it != fs::recursive_directory_iterator(); ++it) {
+                bench::doNotOptimize(it->is_directory());
+                ++entries;
+            }
+            times.push_back(millisSince(start));
+        }
+        printRow("recursive_directory_iterator", entries, median(times), 0);
+
+        times.clear();
+        size_t bytes = 0;
+        for (int r = 0; r < kRepetitions; ++r) {
+            const auto start = Clock::now();
+            std::vector<fs::path> paths;
+            for (auto it = fs::recursive_directory_iterator(base); it != fs::recursive_directory_iterator(); ++it) {
+                paths.push_back(it->path());
+            }
+            times.push_back(millisSince(start));
+            bytes = paths.capacity() * sizeof(fs::path);
+            for (const fs::path& path : paths) {
+                bytes += path.native().capacity() + 1;
+            }
+        }
+        printRow("  + vector<fs::path>", entries, median(times), bytes);
+    }
+
+    DirIndex index;
+    std::vector<unsigned> thread_counts = {1, 2, 4};
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    if (hardware > 4) {
+        thread_counts.push_back(hardware);
+    }
+    for (unsigned threads : thread_counts) {
+        std::vector<double> times;
+        ScanStats stats;
+        for (int r = 0; r < kRepetitions; ++r) {
+            stats = ScanStats{};
+            ScanOptions options;
+            options.threads = threads;
+            index = scanTree(base, options, stats);
+            times.push_back(stats.seconds * 1000.0);
+        }
+        printRow("scanTree，" + std::to_string(threads) + " 线程", stats.entries, median(times), index.memoryBytes());
+    }
+
+    // 在索引上查找随机路径，以及和期望形状比较
+    std::mt19937 rng(42);
+    std::vector<std::string> queries(100'000);
+    for (std::string& query : queries) {
+        query.clear();
+        const int length = std::uniform_int_distribution<int>(1, depth)(rng);
+        for (int i = 0; i < length; ++i) {
+            if (!query.empty()) {
+                query += '/';
+            }
+            query += std::to_string(std::uniform_int_distribution<int>(1, fan_out)(rng));
+        }
+    }
+    auto start = Clock::now();
+    uint64_t found = 0;
+    for (const std::string& query : queries) {
+        found += index.find(query) != DirIndex::kNone;
+    }
+    const double find_ms = millisSince(start);
+    start = Clock::now();
+    const TreeDiff diff = diffExpectedTree(index, fan_out, depth);
+    const double diff_ms = millisSince(start);
+    std::cout << "  find：" << queries.size() << " 次，找到 " << found << "，" << std::setprecision(0)
+              << find_ms * 1e6 / static_cast<double>(queries.size()) << " ns/次" << std::endl;
+    std::cout << "  diffExpectedTree：期望 " << diff.expected << "，缺少 " << diff.missing << "，多出 " << diff.unexpected
+              << "，" << std::setprecision(1) << diff_ms << " ms" << std::endl;
+    std::cout << "  根目录的子树大小 " << index.subtreeSize(DirIndex::root()) << "，不同的名字 " << index.uniqueNames()
+              << std::endl;
+
+    std::error_code ec;
+    fs::remove_all(base, ec);
+    return 0;
+}
@@ -0,0 +1,309 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_WEAK_CACHE_H
+#define HANDS_ON_CPP_WEAK_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "metrics.h"
+
+// ==================== 增量回收的弱引用缓存 ====================
+// ptr_ref_test.cpp 里 Cache 的存储部分：map 里存 weak_ptr，条目由调用方持有，没人持有时过期。
+// 原来只能靠 cleanup() 一次遍历整个 map 删除过期条目，几百万个条目时是几毫秒的停顿。这里把回收拆成小块：
+// - 删除器钩子：条目的最后一个强引用释放时，删除器把 key 放进待回收队列；之后每次 get 顺手取出
+//   最多 reclaim_per_get 个 key 删除（删之前再确认一次已过期，同一个 key 可能已经重新创建）。
+//   队列最多 max_pending 个，满了就不再记录，留给游标清扫
+// - 游标清扫：每次 get 再检查 sweep_buckets_per_get 个桶，游标按桶号前进，兜底回收队列漏掉的条目
+// - 后台清扫线程（可选）：每隔 interval 醒来，在 budget 时间内处理队列和清扫，按小块加锁，不会长时间挡住 get
+// 每次 get 的额外工作有上限，回收的总量摊到各次访问里。
+// 所有操作在一把锁下进行；删除器可能在任意线程运行，只碰待回收队列（单独的锁），不碰 map。
+// Map 可以换成 FlatHashMap：用到的只是 find/emplace/erase/reserve 和按桶号遍历（bucket_count、begin(n)、end(n)）。
+
+struct WeakCacheOptions {
+    size_t reclaim_per_get = 8;        // 每次 get 最多处理的待回收 key 数
+    size_t sweep_buckets_per_get = 2;  // 每次 get 清扫的桶数
+    size_t max_pending = 1 << 20;      // 待回收队列上限，0 表示不用删除器钩子
+    size_t reserve = 0;                // 预留的条目数，避免填充过程中 rehash 造成停顿
+    Gauge* entries = nullptr;          // 非空时同步 map 里的条目数（包括已过期但还没删除的）
+    Gauge* live = nullptr;             // 非空时同步还有人持有的条目数
+};
+
+struct WeakCacheStats {
+    size_t entries = 0;         // map 里的条目数
+    size_t pending = 0;         // 待回收队列里的 key 数
+    uint64_t reclaimed = 0;     // 经待回收队列删除的条目数
+    uint64_t swept = 0;         // 游标清扫删除的条目数
+    uint64_t cleaned = 0;       // cleanup() 删除的条目数
+    uint64_t not_queued = 0;    // 队列已满没能记录的 key 数
+};
+
+template <typename Key, typename Value, typename Map = std::unordered_map<Key, std::weak_ptr<Value>>>
+class WeakCache {
+public:
+    using ValuePtr = std::shared_ptr<Value>;
+
+    enum class Outcome {
+        Hit,      // 条目还有人持有
+        Expired,  // 条目已过期，删除后重新创建
+        Miss,     // map 里没有，新建
+    };
+
+    explicit WeakCache(WeakCacheOptions options = {})
+        : options_(options), pending_(std::make_shared<Pending>()) {
+        pending_->capacity = options_.max_pending;
+        pending_->live = options_.live;
+        if (options_.reserve) {
+            map_.reserve(options_.reserve);
+        }
+    }
+
+    // 仪表可能和别的缓存共用，销毁时把 map 里剩下的条目和还有人持有的条目扣掉。
+    // 条目可能比缓存活得久，之后它们的删除器不再碰 live 仪表，所以仪表只要比缓存活得久就行
+    ~WeakCache() {
+        stopSweeper();
+        addEntries(-static_cast<int64_t>(map_.size()));
+        std::lock_guard<std::mutex> lock(pending_->mutex);
+        if (pending_->live) {
+            pending_->live->add(-pending_->live_count);
+            pending_->live = nullptr;
+        }
+    }
+
+    WeakCache(const WeakCache&) = delete;
+    WeakCache& operator=(const WeakCache&) = delete;
+
+    // 查找 key，没有或已过期时调用 factory(key) 创建，factory 返回 std::unique_ptr<Value>。
+    // factory 在锁内执行，同一个 key 不会被并发创建两次
+    template <typename Factory>
+    ValuePtr get(const Key& key, Factory&& factory, Outcome* outcome = nullptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Outcome result = Outcome::Miss;
+        ValuePtr value;
+        auto it = map_.find(key);
+        if (it != map_.end()) {
+            value = it->second.lock();
+            if (value) {
+                result = Outcome::Hit;
+            } else {
+                result = Outcome::Expired;
+            }
+        }
+        if (!value) {
+            value = adopt(key, factory(key));
+            if (it != map_.end()) {
+                it->second = value;
+            } else {
+                map_.emplace(key, value);
+                addEntries(1);
+            }
+        }
+        reclaimLocked(options_.reclaim_per_get);
+        sweepLocked(options_.sweep_buckets_per_get);
+        if (outcome) {
+            *outcome = result;
+        }
+        return value;
+    }
+
+    // 一次遍历整个 map，删除所有过期条目，返回删除的数量。条目多时会长时间持有锁
+    size_t cleanup() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t removed = 0;
+        for (auto it = map_.begin(); it != map_.end();) {
+            if (it->second.expired()) {
+                it = map_.erase(it);
+                ++removed;
+            } else {
+                ++it;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> pending_lock(pending_->mutex);
+            pending_->keys.clear();
+        }
+        addEntries(-static_cast<int64_t>(removed));
+        stats_.cleaned += removed;
+        return removed;
+    }
+
+    // 启动后台清扫线程：每隔 interval 醒来一次，每次最多工作 budget 时间
+    void startSweeper(std::chrono::milliseconds interval, std::chrono::microseconds budget) {
+        stopSweeper();
+        std::lock_guard<std::mutex> lock(sweeper_mutex_);
+        stop_ = false;
+        sweeper_ = std::thread(&WeakCache::sweeperLoop, this, interval, budget);
+    }
+
+    void stopSweeper() {
+        {
+            std::lock_guard<std::mutex> lock(sweeper_mutex_);
+            stop_ = true;
+        }
+        sweeper_cv_.notify_all();
+        if (sweeper_.joinable()) {
+            sweeper_.join();
+        }
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return map_.size();
+    }
+
+    WeakCacheStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        WeakCacheStats result = stats_;
+        result.entries = map_.size();
+        std::lock_guard<std::mutex> pending_lock(pending_->mutex);
+        result.pending = pending_->keys.size();
+        result.not_queued = pending_->not_queued;
+        return result;
+    }
+
+private:
+    // 待回收队列单独分配，由删除器共享持有：条目比缓存活得久时，删除器仍然可以安全地写入
+    struct Pending {
+        std::mutex mutex;
+        std::vector<Key> keys;
+        size_t capacity = 0;
+        uint64_t not_queued = 0;
+        Gauge* live = nullptr;   // 缓存销毁时置空
+        int64_t live_count = 0;  // 这个缓存发出去、还有人持有的条目数
+    };
+
+    // 删除器里先释放对象，再登记 key；登记时 weak_ptr 已经过期。
+    // live 仪表的增减都在 pending 的锁下，和析构函数里的置空互斥
+    ValuePtr adopt(const Key& key, std::unique_ptr<Value> owned) {
+        if (pending_->live) {
+            std::lock_guard<std::mutex> lock(pending_->mutex);
+            ++pending_->live_count;
+            pending_->live->add(1);
+        }
+        return ValuePtr(owned.release(), [pending = pending_, key](Value* p) {
+            delete p;
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            if (pending->live) {
+                --pending->live_count;
+                pending->live->add(-1);
+            }
+            if (pending->keys.size() < pending->capacity) {
+                pending->keys.push_back(key);
+            } else if (pending->capacity) {
+                ++pending->not_queued;
+            }
+        });
+    }
+
+    void addEntries(int64_t delta) {
+        if (options_.entries) {
+            options_.entries->add(delta);
+        }
+    }
+
+    // 从待回收队列取出最多 limit 个 key，仍然过期的删掉
+    size_t reclaimLocked(size_t limit) {
+        if (limit == 0) {
+            return 0;
+        }
+        batch_.clear();
+        {
+            std::lock_guard<std::mutex> lock(pending_->mutex);
+            const size_t take = std::min(limit, pending_->keys.size());
+            batch_.assign(pending_->keys.end() - static_cast<std::ptrdiff_t>(take), pending_->keys.end());
+            pending_->keys.resize(pending_->keys.size() - take);
+        }
+        size_t removed = 0;
+        for (const Key& key : batch_) {
+            auto it = map_.find(key);
+            if (it != map_.end() && it->second.expired()) {
+                map_.erase(it);
+                ++removed;
+            }
+        }
+        addEntries(-static_cast<int64_t>(removed));
+        stats_.reclaimed += removed;
+        return batch_.size();
+    }
+
+    // 从游标所在的桶开始检查 buckets 个桶。rehash 后桶号含义会变，游标取模后继续，
+    // 最多让某些桶晚一轮被检查，不影响正确性
+    size_t sweepLocked(size_t buckets) {
+        if (buckets == 0 || map_.empty()) {
+            return 0;
+        }
+        const size_t bucket_count = map_.bucket_count();
+        buckets = std::min(buckets, bucket_count);
+        size_t removed = 0;
+        for (size_t n = 0; n < buckets; ++n) {
+            cursor_ %= bucket_count;
+            // 桶的局部迭代器不能用来 erase，先记下过期的 key 再按 key 删除，同一个桶里删除不会 rehash
+            batch_.clear();
+            for (auto it = map_.begin(cursor_); it != map_.end(cursor_); ++it) {
+                if (it->second.expired()) {
+                    batch_.push_back(it->first);
+                }
+            }
+            for (const Key& key : batch_) {
+                map_.erase(key);
+            }
+            removed += batch_.size();
+            ++cursor_;
+        }
+        addEntries(-static_cast<int64_t>(removed));
+        stats_.swept += removed;
+        return buckets;
+    }
+
+    // 每一小块只持有锁处理 64 个 key 或 64 个桶；一次醒来最多清扫一整轮
+    void sweeperLoop(std::chrono::milliseconds interval, std::chrono::microseconds budget) {
+        constexpr size_t kChunk = 64;
+        std::unique_lock<std::mutex> sweeper_lock(sweeper_mutex_);
+        while (!sweeper_cv_.wait_for(sweeper_lock, interval, [this]() { return stop_; })) {
+            const auto deadline = std::chrono::steady_clock::now() + budget;
+            size_t swept_buckets = 0;
+            bool queue_empty = false;
+            while (std::chrono::steady_clock::now() < deadline) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!queue_empty) {
+                    queue_empty = reclaimLocked(kChunk) < kChunk;
+                    continue;
+                }
+                if (swept_buckets >= map_.bucket_count()) {
+                    break;
+                }
+                swept_buckets += sweepLocked(kChunk);
+                if (map_.empty()) {
+                    break;
+                }
+            }
+        }
+    }
+
+    WeakCacheOptions options_;
+    mutable std::mutex mutex_;
+    Map map_;
+    std::shared_ptr<Pending> pending_;
+    std::vector<Key> batch_;  // 回收和清扫时复用，避免每次分配
+    size_t cursor_ = 0;
+    WeakCacheStats stats_;
+
+    std::mutex sweeper_mutex_;
+    std::condition_variable sweeper_cv_;
+    bool stop_ = false;
+    std::thread sweeper_;
+};
+
+#endif //HANDS_ON_CPP_WEAK_CACHE_H
@@ -0,0 +1,55 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+// WeakCache：仪表和缓存、条目的生命周期。
+
+#include <memory>
+
+#include "metrics.h"
+#include "test_check.h"
+#include "weak_cache.h"
+
+using IntCache = WeakCache<int, int>;
+
+std::unique_ptr<int> makeValue(int key) { return std::make_unique<int>(key * 10); }
+
+// 缓存销毁时把自己的条目从仪表里扣掉，同名共用的仪表不会一直涨
+void testGaugesReleasedWithCache() {
+    MetricsRegistry metrics;
+    Gauge& entries = metrics.gauge("entries");
+    Gauge& live = metrics.gauge("live");
+    {
+        IntCache cache(WeakCacheOptions{.entries = &entries, .live = &live});
+        auto a = cache.get(1, makeValue);
+        auto b = cache.get(2, makeValue);
+        CHECK(entries.value() == 2);
+        CHECK(live.value() == 2);
+        b.reset();
+        CHECK(live.value() == 1);
+    }
+    CHECK(entries.value() == 0);
+    CHECK(live.value() == 0);
+}
+
+// 条目比缓存和注册表都活得久：缓存销毁后删除器不再写仪表（注册表已经没了）
+void testEntryOutlivesCacheAndRegistry() {
+    std::shared_ptr<int> survivor;
+    {
+        auto metrics = std::make_unique<MetricsRegistry>();
+        Gauge& live = metrics->gauge("live");
+        {
+            IntCache cache(WeakCacheOptions{.live = &live});
+            survivor = cache.get(3, makeValue);
+            CHECK(live.value() == 1);
+        }
+        CHECK(live.value() == 0);
+    }
+    CHECK(*survivor == 30);
+    survivor.reset();
+}
+
+int main() {
+    testGaugesReleasedWithCache();
+    testEntryOutlivesCacheAndRegistry();
+    return testResult();
+}
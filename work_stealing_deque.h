@@ -0,0 +1,48 @@
+//
+// Created by Galaxy on 2026/10/16.
+//
+
+#ifndef HANDS_ON_CPP_WORK_STEALING_DEQUE_H
+#define HANDS_ON_CPP_WORK_STEALING_DEQUE_H
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+// 每个工作线程一个双端队列：自己从尾部取（LIFO，缓存友好），
+// 其他线程从头部偷（FIFO，偷到的是靠近根的大任务）
+template <typename T>
+class WorkStealingDeque {
+public:
+    void push(T item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        items_.push_back(std::move(item));
+    }
+
+    std::optional<T> pop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(items_.back());
+        items_.pop_back();
+        return item;
+    }
+
+    std::optional<T> steal() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(items_.front());
+        items_.pop_front();
+        return item;
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<T> items_;
+};
+
+#endif //HANDS_ON_CPP_WORK_STEALING_DEQUE_H